@@ -0,0 +1,161 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Frame Log
+      * Purpose:  compact binary log of raw received CAN frames
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <string.h>
+#include "N2kFrameLog.h"
+
+static const uint8_t FrameLogMagic[5]={'N','2','K','F',1};
+
+//*****************************************************************************
+tN2kFrameLogWriter::tN2kFrameLogWriter(tWriteHandler _WriteHandler, void *_Context) {
+  WriteHandler=_WriteHandler;
+  Context=_Context;
+  BufferPos=0;
+  LastTime=0;
+  Frames=0;
+  Started=false;
+}
+
+//*****************************************************************************
+void tN2kFrameLogWriter::Add(const tN2kCANFrame &Frame, uint64_t Time) {
+  if ( !Started ) {
+    memcpy(Buffer,FrameLogMagic,sizeof(FrameLogMagic));
+    memset(Buffer+sizeof(FrameLogMagic),0,3);
+    for ( int i=0; i<8; i++ ) Buffer[8+i]=(uint8_t)(Time>>(8*i));
+    BufferPos=N2kFrameLogHeaderSize;
+    LastTime=Time;
+    Started=true;
+  }
+
+  if ( BufferPos+N2kFrameLogMaxRecordSize>sizeof(Buffer) ) Flush();
+
+  uint64_t Delta=( Time>LastTime ? Time-LastTime : 0 ); // Keep order even if clock goes back
+  LastTime+=Delta;
+  do {
+    uint8_t b=Delta & 0x7f;
+    Delta>>=7;
+    Buffer[BufferPos++]=( Delta!=0 ? b|0x80 : b );
+  } while ( Delta!=0 );
+
+  uint32_t id=Frame.id & 0x1fffffffUL;
+  for ( int i=0; i<4; i++ ) Buffer[BufferPos++]=(uint8_t)(id>>(8*i));
+  unsigned char len=( Frame.len>8 ? 8 : Frame.len );
+  Buffer[BufferPos++]=len;
+  memcpy(Buffer+BufferPos,Frame.buf,len);
+  BufferPos+=len;
+  Frames++;
+}
+
+//*****************************************************************************
+void tN2kFrameLogWriter::Flush() {
+  if ( BufferPos>0 && WriteHandler!=0 ) WriteHandler(Buffer,BufferPos,Context);
+  BufferPos=0;
+}
+
+//*****************************************************************************
+tN2kFrameLogReader::tN2kFrameLogReader(tReadHandler _ReadHandler, void *_Context) {
+  ReadHandler=_ReadHandler;
+  Context=_Context;
+  BufferPos=0;
+  BufferLen=0;
+  StartTime=0;
+  LastTime=0;
+  Frames=0;
+  Started=false;
+  Ended=false;
+  Error=false;
+}
+
+//*****************************************************************************
+bool tN2kFrameLogReader::ReadByte(uint8_t &b) {
+  if ( BufferPos>=BufferLen ) {
+    BufferLen=( ReadHandler!=0 ? ReadHandler(Buffer,sizeof(Buffer),Context) : 0 );
+    BufferPos=0;
+    if ( BufferLen==0 ) return false;
+  }
+  b=Buffer[BufferPos++];
+  return true;
+}
+
+//*****************************************************************************
+bool tN2kFrameLogReader::ReadHeader() {
+  uint8_t Header[N2kFrameLogHeaderSize];
+  for ( size_t i=0; i<sizeof(Header); i++ ) {
+    if ( !ReadByte(Header[i]) ) {
+      if ( i==0 ) { Ended=true; } else { Error=true; } // Empty file has no frames
+      return false;
+    }
+  }
+  if ( memcmp(Header,FrameLogMagic,sizeof(FrameLogMagic))!=0 ) { Error=true; return false; }
+
+  StartTime=0;
+  for ( int i=0; i<8; i++ ) StartTime|=(uint64_t)Header[8+i]<<(8*i);
+  LastTime=StartTime;
+  Started=true;
+  return true;
+}
+
+//*****************************************************************************
+bool tN2kFrameLogReader::Next(tN2kCANFrame &Frame, uint64_t &Time) {
+  if ( Ended || Error ) return false;
+  if ( !Started && !ReadHeader() ) return false;
+
+  uint8_t b;
+  uint64_t Delta=0;
+  int Shift=0;
+  if ( !ReadByte(b) ) { Ended=true; return false; }
+  while ( true ) {
+    if ( Shift>63 ) { Error=true; return false; }
+    Delta|=(uint64_t)(b & 0x7f)<<Shift;
+    if ( (b & 0x80)==0 ) break;
+    Shift+=7;
+    if ( !ReadByte(b) ) { Error=true; return false; }
+  }
+
+  uint8_t Raw[5];
+  for ( int i=0; i<5; i++ ) {
+    if ( !ReadByte(Raw[i]) ) { Error=true; return false; }
+  }
+  Frame.id=(unsigned long)Raw[0] | ((unsigned long)Raw[1]<<8) | ((unsigned long)Raw[2]<<16) | ((unsigned long)Raw[3]<<24);
+  Frame.len=Raw[4];
+  if ( Frame.len>8 || Frame.id>0x1fffffffUL ) { Error=true; return false; }
+  memset(Frame.buf,0,sizeof(Frame.buf));
+  for ( int i=0; i<Frame.len; i++ ) {
+    if ( !ReadByte(Frame.buf[i]) ) { Error=true; return false; }
+  }
+
+  LastTime+=Delta;
+  Time=LastTime;
+  Frames++;
+  return true;
+}
@@ -0,0 +1,118 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Frame Log
+      * Purpose:  compact binary log of raw received CAN frames
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _N2kFrameLog_h_
+#define _N2kFrameLog_h_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <N2kCANMsg.h>
+
+/*
+ *  Frame log keeps raw CAN frames as they came from the driver, so fast
+ *  packet and TP frame order, interleaving and sequence counters are kept.
+ *
+ *  File starts with 16 byte header: "N2KF", version 1, 3 reserved bytes and
+ *  64 bit little endian start time in us. Each frame is:
+ *
+ *  time   LEB128 varint, us from previous frame (first from start time)
+ *  id     32 bit little endian, 29 bit CAN id, upper bits reserved 0
+ *  len    1 byte, 0-8
+ *  data   len bytes
+ *
+ *  So frame with 8 data bytes takes usually 14-15 bytes.
+ *  Writer and reader do not depend on file system. Data goes through handlers.
+ */
+
+#define N2kFrameLogHeaderSize 16
+#define N2kFrameLogMaxRecordSize (10+4+1+8)
+
+class tN2kFrameLogWriter {
+public:
+  typedef void (*tWriteHandler)(const uint8_t *Data, size_t len, void *Context);
+
+protected:
+  tWriteHandler WriteHandler;
+  void *Context;
+  uint8_t Buffer[256];
+  size_t BufferPos;
+  uint64_t LastTime;
+  uint32_t Frames;
+  bool Started;
+
+public:
+  tN2kFrameLogWriter(tWriteHandler _WriteHandler, void *_Context=0);
+  ~tN2kFrameLogWriter() { Flush(); }
+
+  // Adds frame received at Time us. Header will be written on first frame
+  // with that time as start.
+  void Add(const tN2kCANFrame &Frame, uint64_t Time);
+  // Gives buffered data to write handler.
+  void Flush();
+  uint32_t GetFrames() const { return Frames; }
+};
+
+class tN2kFrameLogReader {
+public:
+  // Returns number of bytes read or 0 on end of data.
+  typedef size_t (*tReadHandler)(uint8_t *Data, size_t size, void *Context);
+
+protected:
+  tReadHandler ReadHandler;
+  void *Context;
+  uint8_t Buffer[256];
+  size_t BufferPos;
+  size_t BufferLen;
+  uint64_t StartTime;
+  uint64_t LastTime;
+  uint32_t Frames;
+  bool Started;
+  bool Ended;
+  bool Error;
+
+protected:
+  bool ReadByte(uint8_t &b);
+  bool ReadHeader();
+
+public:
+  tN2kFrameLogReader(tReadHandler _ReadHandler, void *_Context=0);
+
+  // Returns next frame and its time in us. Returns false on end of data or error.
+  bool Next(tN2kCANFrame &Frame, uint64_t &Time);
+  uint64_t GetStartTime() const { return StartTime; }
+  uint32_t GetFrames() const { return Frames; }
+  bool IsEnded() const { return Ended; }
+  bool IsError() const { return Error; }
+};
+
+#endif
@@ -0,0 +1,90 @@
+// Demo: NMEA2000 library. Decode speed of double, float and raw ticks parsing.
+//   Teensy 3.5/3.6 has single precision FPU only, so every double operation
+//   is emulated in software. This counts CPU cycles with DWT cycle counter for
+//   hand written ParseN2k functions and for field descriptor codecs
+//   (N2kMessageCodecs.h) with double, float and int32_t ticks values.
+//   Results are printed to Serial.
+
+#include <Arduino.h>
+#include <N2kMessages.h>
+#include <N2kMessageCodecs.h>
+
+#define Messages 3
+#define Rounds 1000
+
+tN2kMsg Msgs[Messages];
+
+// Every value is stored separately, so that parsers can not be optimized
+// away. Summing ticks could overflow with N2kInt32NA.
+volatile double DoubleSink;
+volatile float FloatSink;
+volatile int32_t TicksSink;
+void Keep(double v) { DoubleSink=v; }
+void Keep(float v) { FloatSink=v; }
+void Keep(int32_t v) { TicksSink=v; }
+
+void setup() {
+  Serial.begin(115200);
+  while ( !Serial && millis()<3000 );
+
+  // Enable cycle counter
+  ARM_DEMCR|=ARM_DEMCR_TRCENA;
+  ARM_DWT_CTRL|=ARM_DWT_CTRL_CYCCNTENA;
+
+  SetN2kPGN127250(Msgs[0],1,DegToRad(123.4),DegToRad(-1.2),DegToRad(6.5),N2khr_magnetic);
+  SetN2kPGN130306(Msgs[1],1,7.3,DegToRad(42),N2kWind_Apparent);
+  SetN2kPGN128267(Msgs[2],1,12.34,-0.5,N2kDoubleNA);
+}
+
+// Cycles per message for parser
+uint32_t Measure(void (*Parse)(const tN2kMsg &N2kMsg)) {
+  uint32_t Start=ARM_DWT_CYCCNT;
+  for (int r=0; r<Rounds; r++) {
+    for (int i=0; i<Messages; i++) Parse(Msgs[i]);
+  }
+  return (ARM_DWT_CYCCNT-Start)/(Rounds*Messages);
+}
+
+void HandParse(const tN2kMsg &N2kMsg) {
+  unsigned char SID;
+  double a,b,c;
+  tN2kHeadingReference HeadingReference;
+  tN2kWindReference WindReference;
+  switch (N2kMsg.PGN) {
+    case 127250L: ParseN2kPGN127250(N2kMsg,SID,a,b,c,HeadingReference); Keep(a); Keep(b); Keep(c); break;
+    case 130306L: ParseN2kPGN130306(N2kMsg,SID,a,b,WindReference); Keep(a); Keep(b); break;
+    case 128267L: ParseN2kPGN128267(N2kMsg,SID,a,b,c); Keep(a); Keep(b); Keep(c); break;
+  }
+}
+
+struct tCodecBench {
+  template<typename tValue> static void Parse(const tN2kMsg &N2kMsg) {
+    switch (N2kMsg.PGN) {
+      case 127250L: {
+        tN2kHeadingValues<tValue> d;
+        tN2kHeadingValues<tValue>::tCodec::Parse(N2kMsg,d); Keep(d.Heading); Keep(d.Deviation); Keep(d.Variation);
+        break;
+      }
+      case 130306L: {
+        tN2kWindSpeedValues<tValue> d;
+        tN2kWindSpeedValues<tValue>::tCodec::Parse(N2kMsg,d); Keep(d.WindSpeed); Keep(d.WindAngle);
+        break;
+      }
+      case 128267L: {
+        tN2kWaterDepthValues<tValue> d;
+        tN2kWaterDepthValues<tValue>::tCodec::Parse(N2kMsg,d); Keep(d.DepthBelowTransducer); Keep(d.Offset); Keep(d.Range);
+        break;
+      }
+    }
+  }
+};
+
+void loop() {
+  Serial.print(F("CPU MHz:            ")); Serial.println(F_CPU/1000000);
+  Serial.print(F("ParseN2k double:    ")); Serial.print(Measure(HandParse)); Serial.println(F(" cycles/message"));
+  Serial.print(F("Codec double:       ")); Serial.print(Measure(tCodecBench::Parse<double>)); Serial.println(F(" cycles/message"));
+  Serial.print(F("Codec float:        ")); Serial.print(Measure(tCodecBench::Parse<float>)); Serial.println(F(" cycles/message"));
+  Serial.print(F("Codec int32 ticks:  ")); Serial.print(Measure(tCodecBench::Parse<int32_t>)); Serial.println(F(" cycles/message"));
+  Serial.println();
+  delay(5000);
+}
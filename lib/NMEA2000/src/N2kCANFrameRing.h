@@ -0,0 +1,136 @@
+/* 
+N2kCANFrameRing.h
+
+Copyright (c) 2015-2018 Timo Lappalainen, Kave Oy, www.kave.fi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _tN2kCANFrameRing_H_
+#define _tN2kCANFrameRing_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "N2kCANMsg.h"
+
+// Lock-free single producer, single consumer ring of CAN frames. Producer
+// can be CAN receive interrupt and consumer ParseMessages through
+// CANGetFrame/CANGetFrames, or for send direction tNMEA2000 and transmit
+// complete interrupt. Only producer writes Head and only consumer writes
+// Tail, so no locking is needed. Indexes run freely and are masked with
+// power of two size. Frame will be written before Head is published with
+// release store and read before Tail is published, so ring works also on
+// multicore systems.
+//
+// On AVR index is 8 bit, since 16 bit access is not atomic there. So max
+// size is 128 frames on AVR and 32768 frames on others.
+
+#if defined(__AVR__)
+typedef uint8_t tN2kRingIndex;
+#else
+typedef uint16_t tN2kRingIndex;
+#endif
+
+#define N2kCANFrameRingMaxSize ((tN2kRingIndex)(((tN2kRingIndex)~0)/2+1))
+
+class tN2kCANFrameRing
+{
+protected:
+  tN2kCANFrame *Frames;
+  tN2kRingIndex Mask;
+  tN2kRingIndex Head;       // Next write. Written by producer.
+  tN2kRingIndex CachedTail; // Producer copy of Tail, so it does not need to read Tail on every push
+  uint32_t Overflows;       // Written by producer.
+  tN2kRingIndex Tail;       // Next read. Written by consumer.
+  tN2kRingIndex CachedHead; // Consumer copy of Head
+
+  static tN2kRingIndex Load(const tN2kRingIndex &Index) { return __atomic_load_n(&Index,__ATOMIC_ACQUIRE); }
+  static void Store(tN2kRingIndex &Index, tN2kRingIndex Value) { __atomic_store_n(&Index,Value,__ATOMIC_RELEASE); }
+
+public:
+  tN2kCANFrameRing() : Frames(0), Mask(0), Head(0), CachedTail(0), Overflows(0), Tail(0), CachedHead(0) {}
+  ~tN2kCANFrameRing() { delete[] Frames; }
+
+  // Allocates ring for at least Size frames. Size will be rounded up to power
+  // of two. Call before producer or consumer uses the ring.
+  bool Init(uint16_t Size) {
+    tN2kRingIndex RingSize=1;
+    while ( RingSize<Size && RingSize<N2kCANFrameRingMaxSize ) RingSize<<=1;
+    delete[] Frames;
+    Frames=new tN2kCANFrame[RingSize];
+    Mask=( Frames!=0 ? RingSize-1 : 0 );
+    Head=CachedTail=Tail=CachedHead=0;
+    Overflows=0;
+    return Frames!=0;
+  }
+
+  // Producer side. Returns false and counts overflow, if ring is full.
+  bool Push(unsigned long id, unsigned char len, const unsigned char *buf) {
+    if ( Frames==0 ) return false;
+    tN2kRingIndex h=Head;
+    if ( (tN2kRingIndex)(h-CachedTail)>Mask ) {
+      CachedTail=Load(Tail);
+      if ( (tN2kRingIndex)(h-CachedTail)>Mask ) { Overflows++; return false; }
+    }
+    tN2kCANFrame &Frame=Frames[h & Mask];
+    Frame.id=id;
+    Frame.len=( len>8 ? 8 : len );
+    memcpy(Frame.buf,buf,Frame.len);
+    Store(Head,h+1);
+    return true;
+  }
+  bool Push(const tN2kCANFrame &Frame) { return Push(Frame.id,Frame.len,Frame.buf); }
+  // Returns free places. Producer can use this to check that all frames of
+  // message fit before pushing any of them. Ring without buffer has no space.
+  uint16_t FreeSpace() const {
+    if ( Frames==0 ) return 0;
+    return (tN2kRingIndex)(Mask+1-(tN2kRingIndex)(Head-Load(Tail)));
+  }
+  uint32_t GetOverflows() const { return Overflows; }
+
+  // Consumer side. Returns false, if ring is empty.
+  bool Pop(unsigned long &id, unsigned char &len, unsigned char *buf) {
+    tN2kRingIndex t=Tail;
+    if ( t==CachedHead ) {
+      CachedHead=Load(Head);
+      if ( t==CachedHead ) return false;
+    }
+    const tN2kCANFrame &Frame=Frames[t & Mask];
+    id=Frame.id;
+    len=Frame.len;
+    memcpy(buf,Frame.buf,len);
+    Store(Tail,t+1);
+    return true;
+  }
+  bool Pop(tN2kCANFrame &Frame) { return Pop(Frame.id,Frame.len,Frame.buf); }
+  // Pops at most MaxFrames frames and publishes Tail once. Fits to CANGetFrames.
+  int PopFrames(tN2kCANFrame *Out, int MaxFrames) {
+    tN2kRingIndex t=Tail;
+    CachedHead=Load(Head);
+    int n=0;
+    for ( ; n<MaxFrames && t!=CachedHead; n++, t++ ) Out[n]=Frames[t & Mask];
+    if ( n>0 ) Store(Tail,t);
+    return n;
+  }
+  uint16_t Count() const { return (tN2kRingIndex)(Load(Head)-Load(Tail)); }
+  bool IsEmpty() const { return Count()==0; }
+
+  uint16_t GetSize() const { return ( Frames!=0 ? (uint16_t)Mask+1 : 0 ); }
+};
+
+#endif
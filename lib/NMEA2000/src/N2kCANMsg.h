@@ -25,6 +25,13 @@ OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define _tN2kCANMsg_H_
 #include <N2kMsg.h>
 
+// Raw received CAN frame for batched receive.
+struct tN2kCANFrame {
+  unsigned long id;
+  unsigned char len;
+  unsigned char buf[8];
+};
+
 class tN2kCANMsg
 {
 public:
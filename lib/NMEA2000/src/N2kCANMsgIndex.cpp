@@ -0,0 +1,174 @@
+/* 
+N2kCANMsgIndex.cpp
+
+Copyright (c) 2015-2018 Timo Lappalainen, Kave Oy, www.kave.fi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "N2kCANMsgIndex.h"
+
+//*****************************************************************************
+tN2kCANMsgIndex::tN2kCANMsgIndex() {
+  MaxMsgs=0;
+  TableMask=0;
+  Table=0;
+  Keys=0;
+  Next=0;
+  Prev=0;
+  Busy=0;
+  FreeHead=BusyHead=BusyTail=NoSlot;
+  BusyCount=0;
+}
+
+//*****************************************************************************
+tN2kCANMsgIndex::~tN2kCANMsgIndex() {
+  delete[] Table;
+  delete[] Keys;
+  delete[] Next;
+  delete[] Prev;
+  delete[] Busy;
+}
+
+//*****************************************************************************
+void tN2kCANMsgIndex::Init(uint8_t _MaxMsgs) {
+  if ( _MaxMsgs!=MaxMsgs || Table==0 ) {
+    delete[] Table;
+    delete[] Keys;
+    delete[] Next;
+    delete[] Prev;
+    delete[] Busy;
+    MaxMsgs=_MaxMsgs;
+    uint16_t TableSize=8;
+    while ( TableSize<2*(uint16_t)MaxMsgs ) TableSize<<=1; // Keep load under 50%
+    TableMask=TableSize-1;
+    Table=new uint8_t[TableSize];
+    Keys=new uint32_t[MaxMsgs];
+    Next=new uint8_t[MaxMsgs];
+    Prev=new uint8_t[MaxMsgs];
+    Busy=new bool[MaxMsgs];
+  }
+
+  for (uint16_t i=0; i<=TableMask; i++) Table[i]=NoSlot;
+  FreeHead=BusyHead=BusyTail=NoSlot;
+  BusyCount=0;
+  for (uint8_t i=MaxMsgs; i>0; i--) {
+    Keys[i-1]=0;
+    Busy[i-1]=false;
+    PushFree(i-1);
+  }
+}
+
+//*****************************************************************************
+void tN2kCANMsgIndex::Unlink(uint8_t Slot) {
+  if ( Prev[Slot]!=NoSlot ) {
+    Next[Prev[Slot]]=Next[Slot];
+  } else if ( Busy[Slot] ) {
+    BusyHead=Next[Slot];
+  } else {
+    FreeHead=Next[Slot];
+  }
+  if ( Next[Slot]!=NoSlot ) {
+    Prev[Next[Slot]]=Prev[Slot];
+  } else if ( Busy[Slot] ) {
+    BusyTail=Prev[Slot];
+  }
+}
+
+//*****************************************************************************
+void tN2kCANMsgIndex::AppendBusy(uint8_t Slot) {
+  Busy[Slot]=true;
+  Next[Slot]=NoSlot;
+  Prev[Slot]=BusyTail;
+  if ( BusyTail!=NoSlot ) { Next[BusyTail]=Slot; } else { BusyHead=Slot; }
+  BusyTail=Slot;
+}
+
+//*****************************************************************************
+void tN2kCANMsgIndex::PushFree(uint8_t Slot) {
+  Busy[Slot]=false;
+  Prev[Slot]=NoSlot;
+  Next[Slot]=FreeHead;
+  if ( FreeHead!=NoSlot ) Prev[FreeHead]=Slot;
+  FreeHead=Slot;
+}
+
+//*****************************************************************************
+// Removes slot from hash table with backward shift, so table needs no
+// deleted markers.
+void tN2kCANMsgIndex::RemoveKey(uint8_t Slot) {
+  uint16_t i=Home(Keys[Slot]);
+  for (; Table[i]!=Slot; i=(i+1) & TableMask) {
+    if ( Table[i]==NoSlot ) return; // Not in table
+  }
+
+  for (uint16_t j=(i+1) & TableMask; Table[j]!=NoSlot; j=(j+1) & TableMask) {
+    uint16_t k=Home(Keys[Table[j]]);
+    // Entry at j can move to i, if its home is not cyclically within (i,j]
+    bool Stays=( i<=j ? (i<k && k<=j) : (i<k || k<=j) );
+    if ( !Stays ) {
+      Table[i]=Table[j];
+      i=j;
+    }
+  }
+  Table[i]=NoSlot;
+}
+
+//*****************************************************************************
+uint8_t tN2kCANMsgIndex::Find(uint32_t Key) const {
+  if ( Table==0 ) return MaxMsgs;
+
+  for (uint16_t i=Home(Key); Table[i]!=NoSlot; i=(i+1) & TableMask) {
+    if ( Keys[Table[i]]==Key ) return Table[i];
+  }
+
+  return MaxMsgs;
+}
+
+//*****************************************************************************
+void tN2kCANMsgIndex::Use(uint8_t Slot, uint32_t Key) {
+  if ( Slot>=MaxMsgs ) return;
+
+  if ( Busy[Slot] ) { RemoveKey(Slot); } else { BusyCount++; }
+
+  Unlink(Slot);
+  Keys[Slot]=Key;
+  AppendBusy(Slot);
+
+  uint16_t i=Home(Key);
+  for (; Table[i]!=NoSlot; i=(i+1) & TableMask);
+  Table[i]=Slot;
+}
+
+//*****************************************************************************
+void tN2kCANMsgIndex::Touch(uint8_t Slot) {
+  if ( Slot>=MaxMsgs || !Busy[Slot] ) return;
+
+  Unlink(Slot);
+  AppendBusy(Slot);
+}
+
+//*****************************************************************************
+void tN2kCANMsgIndex::Release(uint8_t Slot) {
+  if ( Slot>=MaxMsgs || !Busy[Slot] ) return;
+
+  RemoveKey(Slot);
+  Unlink(Slot);
+  PushFree(Slot);
+  BusyCount--;
+}
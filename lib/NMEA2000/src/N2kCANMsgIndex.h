@@ -0,0 +1,87 @@
+/* 
+N2kCANMsgIndex.h
+
+Copyright (c) 2015-2018 Timo Lappalainen, Kave Oy, www.kave.fi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _tN2kCANMsgIndex_H_
+#define _tN2kCANMsgIndex_H_
+
+#include <stdint.h>
+
+// Bookkeeping for tNMEA2000 message reassembly buffer slots. Busy slots are
+// indexed by key in small open addressing hash table and kept in age order,
+// free slots are kept in own list. So finding slot for fast packet or
+// ISO multi packet frame does not depend on buffer size.
+//
+// Fast packet key is PGN and source. ISO multi packet (TP) data frames does
+// not carry PGN, so TP key is source and destination, which identifies
+// TP session.
+class tN2kCANMsgIndex
+{
+protected:
+  static const uint8_t NoSlot=0xff; // Max 255 slots, so never valid slot
+
+  uint8_t MaxMsgs;
+  uint16_t TableMask;
+  uint8_t *Table;    // Hash table of slots. NoSlot on empty place.
+  uint32_t *Keys;    // Key of each busy slot
+  uint8_t *Next;     // List links. Slot is either in free or in busy list.
+  uint8_t *Prev;
+  bool *Busy;
+  uint8_t FreeHead;
+  uint8_t BusyHead;  // Oldest
+  uint8_t BusyTail;  // Newest
+  uint8_t BusyCount;
+
+  uint16_t Home(uint32_t Key) const { return (uint16_t)(((uint32_t)(Key*2654435761UL))>>16) & TableMask; }
+  void Unlink(uint8_t Slot);
+  void AppendBusy(uint8_t Slot);
+  void PushFree(uint8_t Slot);
+  void RemoveKey(uint8_t Slot);
+
+public:
+  tN2kCANMsgIndex();
+  ~tN2kCANMsgIndex();
+
+  // Allocates index for _MaxMsgs slots and sets all slots free.
+  void Init(uint8_t _MaxMsgs);
+
+  static uint32_t FastPacketKey(unsigned long PGN, unsigned char Source) { return (PGN & 0x3ffffUL) | ((uint32_t)Source<<18); }
+  static uint32_t TPKey(unsigned char Source, unsigned char Destination) { return 0x4000000UL | Destination | ((uint32_t)Source<<18); }
+
+  // Returns busy slot for key or MaxMsgs, if there is none.
+  uint8_t Find(uint32_t Key) const;
+  // Returns some free slot or MaxMsgs, if all are busy.
+  uint8_t GetFree() const { return (FreeHead!=NoSlot?FreeHead:MaxMsgs); }
+  // Returns longest time busy slot or MaxMsgs, if all are free.
+  uint8_t GetOldest() const { return (BusyHead!=NoSlot?BusyHead:MaxMsgs); }
+  uint8_t GetBusyCount() const { return BusyCount; }
+
+  // Marks slot busy for key. Slot will be newest. Caller must take care that
+  // key is not in use by other slot.
+  void Use(uint8_t Slot, uint32_t Key);
+  // Moves busy slot to newest e.g. when its time has been updated.
+  void Touch(uint8_t Slot);
+  // Marks slot free.
+  void Release(uint8_t Slot);
+};
+
+#endif
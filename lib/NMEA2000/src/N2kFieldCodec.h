@@ -0,0 +1,266 @@
+/*
+N2kFieldCodec.h
+
+Copyright (c) 2015-2018 Timo Lappalainen, Kave Oy, www.kave.fi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _tN2kFieldCodec_H_
+#define _tN2kFieldCodec_H_
+
+#include "N2kMsg.h"
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// Declarative codec for fixed layout PGNs. Message is described by list of
+// field descriptors (offset, width, signedness, resolution) and is decoded
+// straight into typed struct:
+//
+//   struct tN2kWaterDepthData { unsigned char SID; double Depth; double Offset; };
+//   typedef tN2kPGNCodec<128267L,3,8,tN2kWaterDepthData,
+//     tN2kIntField<tN2kWaterDepthData,unsigned char,&tN2kWaterDepthData::SID,0>,
+//     tN2kDoubleField<tN2kWaterDepthData,&tN2kWaterDepthData::Depth,1,4,false,1,100>,
+//     tN2kDoubleField<tN2kWaterDepthData,&tN2kWaterDepthData::Offset,5,2,true,1,1000>
+//   > tN2kWaterDepthCodec;
+//
+//   tN2kWaterDepthData Depth;
+//   if ( tN2kWaterDepthCodec::Parse(N2kMsg,Depth) ) ...
+//
+// All descriptor values are template parameters, so every field compiles to
+// constant offset loads, shifts and one multiply. Message is bounds checked
+// once. Only if it is shorter than defined length, fields are checked one by
+// one. Missing bytes read as 0xff like with tN2kMsg::GetByte, so missing
+// double fields give N2kDoubleNA.
+//
+// NA sentinel follows width and signedness like with tN2kMsg Add/Get
+// functions: all bits set for unsigned and max positive for signed values.
+// Scaled fields can be decoded to double, float or raw ticks, see
+// tN2kFieldValue.
+// Resolution is given as ResNum/ResDen, since double can not be template
+// parameter. Resolution 1/10000 gives same double as 0.0001.
+//
+// Set fills bytes not covered by fields and unused bits of bit fields with 1.
+//
+// Model covers fields at fixed byte offset with 1-4 bytes and bit fields
+// inside one byte. Fixed layout fast packet PGNs fit too, since Length can be
+// up to MaxDataLen. It can not express strings, 8 byte fields, value offsets
+// or repeating field groups, whose count comes from message. Those PGNs need
+// hand written functions.
+
+//*****************************************************************************
+// Little endian raw value of Width bytes
+template<uint8_t Width>
+inline uint32_t N2kFieldRaw(const unsigned char *Data) {
+  uint32_t v=0;
+  for (uint8_t i=0; i<Width; i++) v|=(uint32_t)Data[i]<<(8*i);
+  return v;
+}
+
+//*****************************************************************************
+template<uint8_t Width>
+inline void N2kFieldSetRaw(uint32_t v, unsigned char *Data) {
+  for (uint8_t i=0; i<Width; i++) Data[i]=(unsigned char)(v>>(8*i));
+}
+
+//*****************************************************************************
+// Value types for scaled fields. double and float get raw*resolution. int32_t
+// gets raw ticks, which are scaled with field Resolution() by caller. On
+// targets with single precision FPU float and int32_t avoid double emulation.
+template<typename V> struct tN2kFieldValue;
+
+template<> struct tN2kFieldValue<double> {
+  static double NA() { return N2kDoubleNA; }
+  static double FromRaw(int32_t Raw, double Resolution) { return Raw*Resolution; }
+  static double FromRaw(uint32_t Raw, double Resolution) { return Raw*Resolution; }
+  static int32_t ToSigned(double v, double Resolution) { return (int32_t)round(v/Resolution); }
+  static uint32_t ToUnsigned(double v, double Resolution) { return (uint32_t)round(v/Resolution); }
+};
+
+template<> struct tN2kFieldValue<float> {
+  static float NA() { return N2kFloatNA; }
+  static float FromRaw(int32_t Raw, double Resolution) { return Raw*(float)Resolution; }
+  static float FromRaw(uint32_t Raw, double Resolution) { return Raw*(float)Resolution; }
+  static int32_t ToSigned(float v, double Resolution) { return (int32_t)roundf(v/(float)Resolution); }
+  static uint32_t ToUnsigned(float v, double Resolution) { return (uint32_t)roundf(v/(float)Resolution); }
+};
+
+// Ticks do not fit for 4 byte unsigned raw values over 0x7ffffffe.
+template<> struct tN2kFieldValue<int32_t> {
+  static int32_t NA() { return N2kInt32NA; }
+  static int32_t FromRaw(int32_t Raw, double) { return Raw; }
+  static int32_t FromRaw(uint32_t Raw, double) { return (int32_t)Raw; }
+  static int32_t ToSigned(int32_t v, double) { return v; }
+  static uint32_t ToUnsigned(int32_t v, double) { return (uint32_t)v; }
+};
+
+//*****************************************************************************
+// Scaled field with NA sentinel. V is double, float or int32_t for raw ticks.
+template<class T, typename V, V T::*Member, uint8_t Offset, uint8_t Width, bool Signed, long ResNum, long ResDen=1>
+class tN2kScaledField {
+  static_assert(Width>=1 && Width<=4, "Scaled field width must be 1-4 bytes");
+public:
+  static const uint8_t ByteOffset=Offset;
+  static const uint8_t ByteWidth=Width;
+  static const bool IsSigned=Signed;
+  static const uint8_t End=Offset+Width;
+  static const uint32_t Mask=0xffffffffUL>>(32-8*Width);
+  static const uint32_t NA=( Signed ? Mask>>1 : Mask );
+  static constexpr double Resolution() { return (double)ResNum/ResDen; }
+
+  static void Decode(const unsigned char *Data, T &Value) {
+    uint32_t Raw=N2kFieldRaw<Width>(Data+Offset);
+    if ( Raw==NA ) {
+      Value.*Member=tN2kFieldValue<V>::NA();
+    } else if ( Signed ) {
+      Value.*Member=tN2kFieldValue<V>::FromRaw((int32_t)(Raw<<(32-8*Width))>>(32-8*Width),Resolution());
+    } else {
+      Value.*Member=tN2kFieldValue<V>::FromRaw(Raw,Resolution());
+    }
+  }
+
+  static void DecodeChecked(const unsigned char *Data, int DataLen, T &Value) {
+    if ( End<=DataLen ) { Decode(Data,Value); } else { Value.*Member=tN2kFieldValue<V>::NA(); }
+  }
+
+  static void Encode(const T &Value, unsigned char *Data) {
+    V v=Value.*Member;
+    uint32_t Raw;
+    if ( v==tN2kFieldValue<V>::NA() ) {
+      Raw=NA;
+    } else if ( Signed ) {
+      Raw=(uint32_t)tN2kFieldValue<V>::ToSigned(v,Resolution());
+    } else {
+      Raw=tN2kFieldValue<V>::ToUnsigned(v,Resolution());
+    }
+    N2kFieldSetRaw<Width>(Raw,Data+Offset);
+  }
+};
+
+template<class T, double T::*Member, uint8_t Offset, uint8_t Width, bool Signed, long ResNum, long ResDen=1>
+using tN2kDoubleField=tN2kScaledField<T,double,Member,Offset,Width,Signed,ResNum,ResDen>;
+
+//*****************************************************************************
+// Integer field, which takes whole bytes. Value is stored as is, so NA is all
+// bits set like with tN2kMsg::GetByte. Store enums as integer type, since raw
+// value may be outside of enum range.
+template<class T, typename V, V T::*Member, uint8_t Offset, uint8_t Width=sizeof(V)>
+class tN2kIntField {
+  static_assert(Width>=1 && Width<=4, "Integer field width must be 1-4 bytes");
+public:
+  static const uint8_t ByteOffset=Offset;
+  static const uint8_t ByteWidth=Width;
+  static const uint8_t End=Offset+Width;
+
+  static void Decode(const unsigned char *Data, T &Value) {
+    Value.*Member=(V)N2kFieldRaw<Width>(Data+Offset);
+  }
+
+  static void DecodeChecked(const unsigned char *Data, int DataLen, T &Value) {
+    if ( End<=DataLen ) { Decode(Data,Value); } else { Value.*Member=(V)(0xffffffffUL>>(32-8*Width)); }
+  }
+
+  static void Encode(const T &Value, unsigned char *Data) {
+    N2kFieldSetRaw<Width>((uint32_t)(Value.*Member),Data+Offset);
+  }
+};
+
+//*****************************************************************************
+// Bit field inside one byte, usually enum stored as unsigned char
+template<class T, typename V, V T::*Member, uint8_t Offset, uint8_t Shift, uint8_t Bits>
+class tN2kBitField {
+  static_assert(Bits>=1 && Shift+Bits<=8, "Bit field must fit in one byte");
+public:
+  static const uint8_t ByteOffset=Offset;
+  static const uint8_t BitShift=Shift;
+  static const uint8_t End=Offset+1;
+  static const uint8_t Mask=(uint8_t)(0xff>>(8-Bits));
+
+  static void Decode(const unsigned char *Data, T &Value) {
+    Value.*Member=(V)((Data[Offset]>>Shift) & Mask);
+  }
+
+  static void DecodeChecked(const unsigned char *Data, int DataLen, T &Value) {
+    if ( End<=DataLen ) { Decode(Data,Value); } else { Value.*Member=(V)Mask; }
+  }
+
+  static void Encode(const T &Value, unsigned char *Data) {
+    Data[Offset]=(Data[Offset] & ~(Mask<<Shift)) | ((((uint8_t)(Value.*Member)) & Mask)<<Shift);
+  }
+};
+
+//*****************************************************************************
+// Runs field list recursively. Compiler inlines whole list to one function.
+template<class T, class... Fields> struct tN2kFieldList;
+
+template<class T> struct tN2kFieldList<T> {
+  static const uint8_t End=0;
+  static void Decode(const unsigned char *, T &) {}
+  static void DecodeChecked(const unsigned char *, int, T &) {}
+  static void Encode(const T &, unsigned char *) {}
+};
+
+template<class T, class Field, class... Rest> struct tN2kFieldList<T,Field,Rest...> {
+  static const uint8_t End=( Field::End>tN2kFieldList<T,Rest...>::End ? Field::End : tN2kFieldList<T,Rest...>::End );
+
+  static void Decode(const unsigned char *Data, T &Value) {
+    Field::Decode(Data,Value);
+    tN2kFieldList<T,Rest...>::Decode(Data,Value);
+  }
+  static void DecodeChecked(const unsigned char *Data, int DataLen, T &Value) {
+    Field::DecodeChecked(Data,DataLen,Value);
+    tN2kFieldList<T,Rest...>::DecodeChecked(Data,DataLen,Value);
+  }
+  static void Encode(const T &Value, unsigned char *Data) {
+    Field::Encode(Value,Data);
+    tN2kFieldList<T,Rest...>::Encode(Value,Data);
+  }
+};
+
+//*****************************************************************************
+// Codec for one PGN. Length is data length set by Set and expected by Parse.
+template<unsigned long PGN, unsigned char Priority, uint8_t Length, class T, class... Fields>
+class tN2kPGNCodec {
+  typedef tN2kFieldList<T,Fields...> tFields;
+  static_assert(tFields::End<=Length, "Field is outside of message length");
+  static_assert(Length<=tN2kMsg::MaxDataLen, "Message length is over MaxDataLen");
+public:
+  typedef T tData;
+  static const uint8_t MsgLength=Length;
+
+  static bool Parse(const tN2kMsg &N2kMsg, T &Value) {
+    if ( N2kMsg.PGN!=PGN ) return false;
+    if ( N2kMsg.DataLen>=Length ) {
+      tFields::Decode(N2kMsg.Data,Value);
+    } else {
+      tFields::DecodeChecked(N2kMsg.Data,N2kMsg.DataLen,Value);
+    }
+    return true;
+  }
+
+  static void Set(tN2kMsg &N2kMsg, const T &Value) {
+    N2kMsg.SetPGN(PGN);
+    N2kMsg.Priority=Priority;
+    memset(N2kMsg.Data,0xff,Length);
+    N2kMsg.DataLen=Length;
+    tFields::Encode(Value,N2kMsg.Data);
+  }
+};
+
+#endif
@@ -0,0 +1,861 @@
+/*
+N2kMessageCodecs.h
+
+Copyright (c) 2015-2018 Timo Lappalainen, Kave Oy, www.kave.fi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _N2kMessageCodecs_H_
+#define _N2kMessageCodecs_H_
+
+#include "N2kMessages.h"
+#include "N2kFieldCodec.h"
+
+// Field descriptor tables for fixed layout PGNs. Units and field meanings are
+// same as with matching SetN2k / ParseN2k functions in N2kMessages.h. Use e.g.
+//
+//   tN2kHeadingData Heading;
+//   if ( tN2kPGN127250Codec::Parse(N2kMsg,Heading) ) ...
+//
+// Enum fields are unsigned char with enum type in comment, since message can
+// have any raw value, e.g. NA 0xff, which is not valid for the enum. Compare
+// them directly with enum values, e.g. Heading.Reference==N2khr_magnetic.
+//
+// Every PGN has double, float and raw ticks variants, e.g. tN2kHeadingFloatData
+// with tN2kPGN127250FloatCodec. Ticks are int32_t and NA is N2kInt32NA.
+// Resolution of ticks is known at compile time, e.g.
+// tN2kHeadingTicksData::tHeading::Resolution().
+//
+// New PGN needs only data struct and descriptor table here.
+//
+// Some tables are not byte by byte same as hand written functions:
+//   - Set writes reserved bits as 1, where 127258, 129039 and 129283 write 0.
+//   - Rate of turn resolution 1/320000000 may differ 1 ulp from (1e-3/32.0)*0.0001.
+//   - 129284 waypoint numbers are uint32_t like in message.
+//
+// PGNs of N2kMessages.h, which do not fit to descriptor model (see
+// N2kFieldCodec.h) and have only hand written double functions:
+//   127501 Binary status, 64 bit bank status. No scaled values.
+//   127513 Battery configuration, Peukert exponent has value offset
+//   129029 GNSS position, 8 byte fields and repeating reference stations.
+//          Position needs double precision anyway.
+//   129794 AIS class A static data, strings
+//   129809 AIS class B static data part A, strings
+//   129810 AIS class B static data part B, strings
+// Float variants for 127513, 129794 and 129810 need hand written functions
+// or offset and string support in descriptor model. Those are still open.
+
+//*****************************************************************************
+// System Time
+template<typename tValue> struct tN2kSystemTimeValues {
+  unsigned char SID;
+  unsigned char TimeSource; // tN2kTimeSource
+  uint16_t SystemDate;
+  tValue SystemTime;
+
+  typedef tN2kSystemTimeValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kBitField<T,unsigned char,&T::TimeSource,1,0,4> tTimeSource;
+  typedef tN2kIntField<T,uint16_t,&T::SystemDate,2> tSystemDate;
+  typedef tN2kScaledField<T,tValue,&T::SystemTime,4,4,false,1,10000> tSystemTime;
+  typedef tN2kPGNCodec<126992L,3,8,T,tSID,tTimeSource,tSystemDate,tSystemTime> tCodec;
+};
+
+typedef tN2kSystemTimeValues<double> tN2kSystemTimeData;
+typedef tN2kSystemTimeValues<float> tN2kSystemTimeFloatData;
+typedef tN2kSystemTimeValues<int32_t> tN2kSystemTimeTicksData;
+typedef tN2kSystemTimeData::tCodec tN2kPGN126992Codec;
+typedef tN2kSystemTimeFloatData::tCodec tN2kPGN126992FloatCodec;
+typedef tN2kSystemTimeTicksData::tCodec tN2kPGN126992TicksCodec;
+
+//*****************************************************************************
+// Rudder
+template<typename tValue> struct tN2kRudderValues {
+  unsigned char Instance;
+  unsigned char DirectionOrder; // tN2kRudderDirectionOrder
+  tValue AngleOrder;
+  tValue Position;
+
+  typedef tN2kRudderValues T;
+  typedef tN2kIntField<T,unsigned char,&T::Instance,0> tInstance;
+  typedef tN2kBitField<T,unsigned char,&T::DirectionOrder,1,0,3> tDirectionOrder;
+  typedef tN2kScaledField<T,tValue,&T::AngleOrder,2,2,true,1,10000> tAngleOrder;
+  typedef tN2kScaledField<T,tValue,&T::Position,4,2,true,1,10000> tPosition;
+  typedef tN2kPGNCodec<127245L,2,8,T,tInstance,tDirectionOrder,tAngleOrder,tPosition> tCodec;
+};
+
+typedef tN2kRudderValues<double> tN2kRudderData;
+typedef tN2kRudderValues<float> tN2kRudderFloatData;
+typedef tN2kRudderValues<int32_t> tN2kRudderTicksData;
+typedef tN2kRudderData::tCodec tN2kPGN127245Codec;
+typedef tN2kRudderFloatData::tCodec tN2kPGN127245FloatCodec;
+typedef tN2kRudderTicksData::tCodec tN2kPGN127245TicksCodec;
+
+//*****************************************************************************
+// Vessel Heading
+template<typename tValue> struct tN2kHeadingValues {
+  unsigned char SID;
+  tValue Heading;
+  tValue Deviation;
+  tValue Variation;
+  unsigned char Reference; // tN2kHeadingReference
+
+  typedef tN2kHeadingValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kScaledField<T,tValue,&T::Heading,1,2,false,1,10000> tHeading;
+  typedef tN2kScaledField<T,tValue,&T::Deviation,3,2,true,1,10000> tDeviation;
+  typedef tN2kScaledField<T,tValue,&T::Variation,5,2,true,1,10000> tVariation;
+  typedef tN2kBitField<T,unsigned char,&T::Reference,7,0,2> tReference;
+  typedef tN2kPGNCodec<127250L,2,8,T,tSID,tHeading,tDeviation,tVariation,tReference> tCodec;
+};
+
+typedef tN2kHeadingValues<double> tN2kHeadingData;
+typedef tN2kHeadingValues<float> tN2kHeadingFloatData;
+typedef tN2kHeadingValues<int32_t> tN2kHeadingTicksData;
+typedef tN2kHeadingData::tCodec tN2kPGN127250Codec;
+typedef tN2kHeadingFloatData::tCodec tN2kPGN127250FloatCodec;
+typedef tN2kHeadingTicksData::tCodec tN2kPGN127250TicksCodec;
+
+//*****************************************************************************
+// Rate of Turn
+template<typename tValue> struct tN2kRateOfTurnValues {
+  unsigned char SID;
+  tValue RateOfTurn;
+
+  typedef tN2kRateOfTurnValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kScaledField<T,tValue,&T::RateOfTurn,1,4,true,1,320000000> tRateOfTurn;
+  typedef tN2kPGNCodec<127251L,2,5,T,tSID,tRateOfTurn> tCodec;
+};
+
+typedef tN2kRateOfTurnValues<double> tN2kRateOfTurnData;
+typedef tN2kRateOfTurnValues<float> tN2kRateOfTurnFloatData;
+typedef tN2kRateOfTurnValues<int32_t> tN2kRateOfTurnTicksData;
+typedef tN2kRateOfTurnData::tCodec tN2kPGN127251Codec;
+typedef tN2kRateOfTurnFloatData::tCodec tN2kPGN127251FloatCodec;
+typedef tN2kRateOfTurnTicksData::tCodec tN2kPGN127251TicksCodec;
+
+//*****************************************************************************
+// Attitude
+template<typename tValue> struct tN2kAttitudeValues {
+  unsigned char SID;
+  tValue Yaw;
+  tValue Pitch;
+  tValue Roll;
+
+  typedef tN2kAttitudeValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kScaledField<T,tValue,&T::Yaw,1,2,true,1,10000> tYaw;
+  typedef tN2kScaledField<T,tValue,&T::Pitch,3,2,true,1,10000> tPitch;
+  typedef tN2kScaledField<T,tValue,&T::Roll,5,2,true,1,10000> tRoll;
+  typedef tN2kPGNCodec<127257L,2,8,T,tSID,tYaw,tPitch,tRoll> tCodec;
+};
+
+typedef tN2kAttitudeValues<double> tN2kAttitudeData;
+typedef tN2kAttitudeValues<float> tN2kAttitudeFloatData;
+typedef tN2kAttitudeValues<int32_t> tN2kAttitudeTicksData;
+typedef tN2kAttitudeData::tCodec tN2kPGN127257Codec;
+typedef tN2kAttitudeFloatData::tCodec tN2kPGN127257FloatCodec;
+typedef tN2kAttitudeTicksData::tCodec tN2kPGN127257TicksCodec;
+
+//*****************************************************************************
+// Magnetic Variation
+template<typename tValue> struct tN2kMagneticVariationValues {
+  unsigned char SID;
+  unsigned char Source; // tN2kMagneticVariation
+  uint16_t DaysSince1970;
+  tValue Variation;
+
+  typedef tN2kMagneticVariationValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kBitField<T,unsigned char,&T::Source,1,0,4> tSource;
+  typedef tN2kIntField<T,uint16_t,&T::DaysSince1970,2> tDaysSince1970;
+  typedef tN2kScaledField<T,tValue,&T::Variation,4,2,true,1,10000> tVariation;
+  typedef tN2kPGNCodec<127258L,3,6,T,tSID,tSource,tDaysSince1970,tVariation> tCodec;
+};
+
+typedef tN2kMagneticVariationValues<double> tN2kMagneticVariationData;
+typedef tN2kMagneticVariationValues<float> tN2kMagneticVariationFloatData;
+typedef tN2kMagneticVariationValues<int32_t> tN2kMagneticVariationTicksData;
+typedef tN2kMagneticVariationData::tCodec tN2kPGN127258Codec;
+typedef tN2kMagneticVariationFloatData::tCodec tN2kPGN127258FloatCodec;
+typedef tN2kMagneticVariationTicksData::tCodec tN2kPGN127258TicksCodec;
+
+//*****************************************************************************
+// Engine parameters rapid
+template<typename tValue> struct tN2kEngineRapidValues {
+  unsigned char EngineInstance;
+  tValue EngineSpeed;
+  tValue EngineBoostPressure;
+  int8_t EngineTiltTrim;
+
+  typedef tN2kEngineRapidValues T;
+  typedef tN2kIntField<T,unsigned char,&T::EngineInstance,0> tEngineInstance;
+  typedef tN2kScaledField<T,tValue,&T::EngineSpeed,1,2,true,1,4> tEngineSpeed;
+  typedef tN2kScaledField<T,tValue,&T::EngineBoostPressure,3,2,false,100> tEngineBoostPressure;
+  typedef tN2kIntField<T,int8_t,&T::EngineTiltTrim,5> tEngineTiltTrim;
+  typedef tN2kPGNCodec<127488L,3,8,T,tEngineInstance,tEngineSpeed,tEngineBoostPressure,tEngineTiltTrim> tCodec;
+};
+
+typedef tN2kEngineRapidValues<double> tN2kEngineRapidData;
+typedef tN2kEngineRapidValues<float> tN2kEngineRapidFloatData;
+typedef tN2kEngineRapidValues<int32_t> tN2kEngineRapidTicksData;
+typedef tN2kEngineRapidData::tCodec tN2kPGN127488Codec;
+typedef tN2kEngineRapidFloatData::tCodec tN2kPGN127488FloatCodec;
+typedef tN2kEngineRapidTicksData::tCodec tN2kPGN127488TicksCodec;
+
+//*****************************************************************************
+// Engine parameters dynamic
+template<typename tValue> struct tN2kEngineDynamicValues {
+  unsigned char EngineInstance;
+  tValue EngineOilPress;
+  tValue EngineOilTemp;
+  tValue EngineCoolantTemp;
+  tValue AltenatorVoltage;
+  tValue FuelRate;
+  tValue EngineHours;
+  tValue EngineCoolantPress;
+  tValue EngineFuelPress;
+  uint16_t EngineDiscreteStatus1;
+  uint16_t EngineDiscreteStatus2;
+  int8_t EngineLoad;
+  int8_t EngineTorque;
+
+  typedef tN2kEngineDynamicValues T;
+  typedef tN2kIntField<T,unsigned char,&T::EngineInstance,0> tEngineInstance;
+  typedef tN2kScaledField<T,tValue,&T::EngineOilPress,1,2,false,100> tEngineOilPress;
+  typedef tN2kScaledField<T,tValue,&T::EngineOilTemp,3,2,false,1,10> tEngineOilTemp;
+  typedef tN2kScaledField<T,tValue,&T::EngineCoolantTemp,5,2,false,1,100> tEngineCoolantTemp;
+  typedef tN2kScaledField<T,tValue,&T::AltenatorVoltage,7,2,true,1,100> tAltenatorVoltage;
+  typedef tN2kScaledField<T,tValue,&T::FuelRate,9,2,true,1,10> tFuelRate;
+  typedef tN2kScaledField<T,tValue,&T::EngineHours,11,4,false,1> tEngineHours;
+  typedef tN2kScaledField<T,tValue,&T::EngineCoolantPress,15,2,false,100> tEngineCoolantPress;
+  typedef tN2kScaledField<T,tValue,&T::EngineFuelPress,17,2,false,1000> tEngineFuelPress;
+  typedef tN2kIntField<T,uint16_t,&T::EngineDiscreteStatus1,20> tEngineDiscreteStatus1;
+  typedef tN2kIntField<T,uint16_t,&T::EngineDiscreteStatus2,22> tEngineDiscreteStatus2;
+  typedef tN2kIntField<T,int8_t,&T::EngineLoad,24> tEngineLoad;
+  typedef tN2kIntField<T,int8_t,&T::EngineTorque,25> tEngineTorque;
+  typedef tN2kPGNCodec<127489L,6,26,T,tEngineInstance,tEngineOilPress,tEngineOilTemp,tEngineCoolantTemp,tAltenatorVoltage,tFuelRate,tEngineHours,tEngineCoolantPress,tEngineFuelPress,tEngineDiscreteStatus1,tEngineDiscreteStatus2,tEngineLoad,tEngineTorque> tCodec;
+};
+
+typedef tN2kEngineDynamicValues<double> tN2kEngineDynamicData;
+typedef tN2kEngineDynamicValues<float> tN2kEngineDynamicFloatData;
+typedef tN2kEngineDynamicValues<int32_t> tN2kEngineDynamicTicksData;
+typedef tN2kEngineDynamicData::tCodec tN2kPGN127489Codec;
+typedef tN2kEngineDynamicFloatData::tCodec tN2kPGN127489FloatCodec;
+typedef tN2kEngineDynamicTicksData::tCodec tN2kPGN127489TicksCodec;
+
+//*****************************************************************************
+// Transmission parameters, dynamic
+template<typename tValue> struct tN2kTransmissionValues {
+  unsigned char EngineInstance;
+  unsigned char TransmissionGear; // tN2kTransmissionGear
+  tValue OilPressure;
+  tValue OilTemperature;
+  unsigned char DiscreteStatus1;
+
+  typedef tN2kTransmissionValues T;
+  typedef tN2kIntField<T,unsigned char,&T::EngineInstance,0> tEngineInstance;
+  typedef tN2kBitField<T,unsigned char,&T::TransmissionGear,1,0,2> tTransmissionGear;
+  typedef tN2kScaledField<T,tValue,&T::OilPressure,2,2,false,100> tOilPressure;
+  typedef tN2kScaledField<T,tValue,&T::OilTemperature,4,2,false,1,10> tOilTemperature;
+  typedef tN2kIntField<T,unsigned char,&T::DiscreteStatus1,6> tDiscreteStatus1;
+  typedef tN2kPGNCodec<127493L,6,8,T,tEngineInstance,tTransmissionGear,tOilPressure,tOilTemperature,tDiscreteStatus1> tCodec;
+};
+
+typedef tN2kTransmissionValues<double> tN2kTransmissionData;
+typedef tN2kTransmissionValues<float> tN2kTransmissionFloatData;
+typedef tN2kTransmissionValues<int32_t> tN2kTransmissionTicksData;
+typedef tN2kTransmissionData::tCodec tN2kPGN127493Codec;
+typedef tN2kTransmissionFloatData::tCodec tN2kPGN127493FloatCodec;
+typedef tN2kTransmissionTicksData::tCodec tN2kPGN127493TicksCodec;
+
+//*****************************************************************************
+// Fluid level
+template<typename tValue> struct tN2kFluidLevelValues {
+  unsigned char Instance;
+  unsigned char FluidType; // tN2kFluidType
+  tValue Level;
+  tValue Capacity;
+
+  typedef tN2kFluidLevelValues T;
+  typedef tN2kBitField<T,unsigned char,&T::Instance,0,0,4> tInstance;
+  typedef tN2kBitField<T,unsigned char,&T::FluidType,0,4,4> tFluidType;
+  typedef tN2kScaledField<T,tValue,&T::Level,1,2,true,4,1000> tLevel;
+  typedef tN2kScaledField<T,tValue,&T::Capacity,3,4,false,1,10> tCapacity;
+  typedef tN2kPGNCodec<127505L,6,8,T,tInstance,tFluidType,tLevel,tCapacity> tCodec;
+};
+
+typedef tN2kFluidLevelValues<double> tN2kFluidLevelData;
+typedef tN2kFluidLevelValues<float> tN2kFluidLevelFloatData;
+typedef tN2kFluidLevelValues<int32_t> tN2kFluidLevelTicksData;
+typedef tN2kFluidLevelData::tCodec tN2kPGN127505Codec;
+typedef tN2kFluidLevelFloatData::tCodec tN2kPGN127505FloatCodec;
+typedef tN2kFluidLevelTicksData::tCodec tN2kPGN127505TicksCodec;
+
+//*****************************************************************************
+// DC Detailed Status
+template<typename tValue> struct tN2kDCStatusValues {
+  unsigned char SID;
+  unsigned char DCInstance;
+  unsigned char DCType; // tN2kDCType
+  uint8_t StateOfCharge;
+  uint8_t StateOfHealth;
+  tValue TimeRemaining;
+  tValue RippleVoltage;
+
+  typedef tN2kDCStatusValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kIntField<T,unsigned char,&T::DCInstance,1> tDCInstance;
+  typedef tN2kIntField<T,unsigned char,&T::DCType,2> tDCType;
+  typedef tN2kIntField<T,uint8_t,&T::StateOfCharge,3> tStateOfCharge;
+  typedef tN2kIntField<T,uint8_t,&T::StateOfHealth,4> tStateOfHealth;
+  typedef tN2kScaledField<T,tValue,&T::TimeRemaining,5,2,false,1> tTimeRemaining;
+  typedef tN2kScaledField<T,tValue,&T::RippleVoltage,7,2,false,1,1000> tRippleVoltage;
+  typedef tN2kPGNCodec<127506L,6,9,T,tSID,tDCInstance,tDCType,tStateOfCharge,tStateOfHealth,tTimeRemaining,tRippleVoltage> tCodec;
+};
+
+typedef tN2kDCStatusValues<double> tN2kDCStatusData;
+typedef tN2kDCStatusValues<float> tN2kDCStatusFloatData;
+typedef tN2kDCStatusValues<int32_t> tN2kDCStatusTicksData;
+typedef tN2kDCStatusData::tCodec tN2kPGN127506Codec;
+typedef tN2kDCStatusFloatData::tCodec tN2kPGN127506FloatCodec;
+typedef tN2kDCStatusTicksData::tCodec tN2kPGN127506TicksCodec;
+
+//*****************************************************************************
+// Battery Status
+template<typename tValue> struct tN2kBatteryStatusValues {
+  unsigned char BatteryInstance;
+  tValue BatteryVoltage;
+  tValue BatteryCurrent;
+  tValue BatteryTemperature;
+  unsigned char SID;
+
+  typedef tN2kBatteryStatusValues T;
+  typedef tN2kIntField<T,unsigned char,&T::BatteryInstance,0> tBatteryInstance;
+  typedef tN2kScaledField<T,tValue,&T::BatteryVoltage,1,2,true,1,100> tBatteryVoltage;
+  typedef tN2kScaledField<T,tValue,&T::BatteryCurrent,3,2,true,1,10> tBatteryCurrent;
+  typedef tN2kScaledField<T,tValue,&T::BatteryTemperature,5,2,false,1,100> tBatteryTemperature;
+  typedef tN2kIntField<T,unsigned char,&T::SID,7> tSID;
+  typedef tN2kPGNCodec<127508L,6,8,T,tBatteryInstance,tBatteryVoltage,tBatteryCurrent,tBatteryTemperature,tSID> tCodec;
+};
+
+typedef tN2kBatteryStatusValues<double> tN2kBatteryStatusData;
+typedef tN2kBatteryStatusValues<float> tN2kBatteryStatusFloatData;
+typedef tN2kBatteryStatusValues<int32_t> tN2kBatteryStatusTicksData;
+typedef tN2kBatteryStatusData::tCodec tN2kPGN127508Codec;
+typedef tN2kBatteryStatusFloatData::tCodec tN2kPGN127508FloatCodec;
+typedef tN2kBatteryStatusTicksData::tCodec tN2kPGN127508TicksCodec;
+
+//*****************************************************************************
+// Leeway
+template<typename tValue> struct tN2kLeewayValues {
+  unsigned char SID;
+  tValue Leeway;
+
+  typedef tN2kLeewayValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kScaledField<T,tValue,&T::Leeway,1,2,true,1,10000> tLeeway;
+  typedef tN2kPGNCodec<128000L,4,8,T,tSID,tLeeway> tCodec;
+};
+
+typedef tN2kLeewayValues<double> tN2kLeewayData;
+typedef tN2kLeewayValues<float> tN2kLeewayFloatData;
+typedef tN2kLeewayValues<int32_t> tN2kLeewayTicksData;
+typedef tN2kLeewayData::tCodec tN2kPGN128000Codec;
+typedef tN2kLeewayFloatData::tCodec tN2kPGN128000FloatCodec;
+typedef tN2kLeewayTicksData::tCodec tN2kPGN128000TicksCodec;
+
+//*****************************************************************************
+// Boat speed
+template<typename tValue> struct tN2kBoatSpeedValues {
+  unsigned char SID;
+  tValue WaterReferenced;
+  tValue GroundReferenced;
+  unsigned char SWRT; // tN2kSpeedWaterReferenceType
+
+  typedef tN2kBoatSpeedValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kScaledField<T,tValue,&T::WaterReferenced,1,2,false,1,100> tWaterReferenced;
+  typedef tN2kScaledField<T,tValue,&T::GroundReferenced,3,2,false,1,100> tGroundReferenced;
+  typedef tN2kBitField<T,unsigned char,&T::SWRT,5,0,4> tSWRT;
+  typedef tN2kPGNCodec<128259L,2,8,T,tSID,tWaterReferenced,tGroundReferenced,tSWRT> tCodec;
+};
+
+typedef tN2kBoatSpeedValues<double> tN2kBoatSpeedData;
+typedef tN2kBoatSpeedValues<float> tN2kBoatSpeedFloatData;
+typedef tN2kBoatSpeedValues<int32_t> tN2kBoatSpeedTicksData;
+typedef tN2kBoatSpeedData::tCodec tN2kPGN128259Codec;
+typedef tN2kBoatSpeedFloatData::tCodec tN2kPGN128259FloatCodec;
+typedef tN2kBoatSpeedTicksData::tCodec tN2kPGN128259TicksCodec;
+
+//*****************************************************************************
+// Water depth
+template<typename tValue> struct tN2kWaterDepthValues {
+  unsigned char SID;
+  tValue DepthBelowTransducer;
+  tValue Offset;
+  tValue Range;
+
+  typedef tN2kWaterDepthValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kScaledField<T,tValue,&T::DepthBelowTransducer,1,4,false,1,100> tDepthBelowTransducer;
+  typedef tN2kScaledField<T,tValue,&T::Offset,5,2,true,1,1000> tOffset;
+  typedef tN2kScaledField<T,tValue,&T::Range,7,1,false,10> tRange;
+  typedef tN2kPGNCodec<128267L,3,8,T,tSID,tDepthBelowTransducer,tOffset,tRange> tCodec;
+};
+
+typedef tN2kWaterDepthValues<double> tN2kWaterDepthData;
+typedef tN2kWaterDepthValues<float> tN2kWaterDepthFloatData;
+typedef tN2kWaterDepthValues<int32_t> tN2kWaterDepthTicksData;
+typedef tN2kWaterDepthData::tCodec tN2kPGN128267Codec;
+typedef tN2kWaterDepthFloatData::tCodec tN2kPGN128267FloatCodec;
+typedef tN2kWaterDepthTicksData::tCodec tN2kPGN128267TicksCodec;
+
+//*****************************************************************************
+// Distance log
+template<typename tValue> struct tN2kDistanceLogValues {
+  uint16_t DaysSince1970;
+  tValue SecondsSinceMidnight;
+  uint32_t Log;
+  uint32_t TripLog;
+
+  typedef tN2kDistanceLogValues T;
+  typedef tN2kIntField<T,uint16_t,&T::DaysSince1970,0> tDaysSince1970;
+  typedef tN2kScaledField<T,tValue,&T::SecondsSinceMidnight,2,4,false,1,10000> tSecondsSinceMidnight;
+  typedef tN2kIntField<T,uint32_t,&T::Log,6> tLog;
+  typedef tN2kIntField<T,uint32_t,&T::TripLog,10> tTripLog;
+  typedef tN2kPGNCodec<128275L,6,14,T,tDaysSince1970,tSecondsSinceMidnight,tLog,tTripLog> tCodec;
+};
+
+typedef tN2kDistanceLogValues<double> tN2kDistanceLogData;
+typedef tN2kDistanceLogValues<float> tN2kDistanceLogFloatData;
+typedef tN2kDistanceLogValues<int32_t> tN2kDistanceLogTicksData;
+typedef tN2kDistanceLogData::tCodec tN2kPGN128275Codec;
+typedef tN2kDistanceLogFloatData::tCodec tN2kPGN128275FloatCodec;
+typedef tN2kDistanceLogTicksData::tCodec tN2kPGN128275TicksCodec;
+
+//*****************************************************************************
+// Position rapid
+template<typename tValue> struct tN2kLatLonRapidValues {
+  tValue Latitude;
+  tValue Longitude;
+
+  typedef tN2kLatLonRapidValues T;
+  typedef tN2kScaledField<T,tValue,&T::Latitude,0,4,true,1,10000000> tLatitude;
+  typedef tN2kScaledField<T,tValue,&T::Longitude,4,4,true,1,10000000> tLongitude;
+  typedef tN2kPGNCodec<129025L,3,8,T,tLatitude,tLongitude> tCodec;
+};
+
+typedef tN2kLatLonRapidValues<double> tN2kLatLonRapidData;
+typedef tN2kLatLonRapidValues<float> tN2kLatLonRapidFloatData;
+typedef tN2kLatLonRapidValues<int32_t> tN2kLatLonRapidTicksData;
+typedef tN2kLatLonRapidData::tCodec tN2kPGN129025Codec;
+typedef tN2kLatLonRapidFloatData::tCodec tN2kPGN129025FloatCodec;
+typedef tN2kLatLonRapidTicksData::tCodec tN2kPGN129025TicksCodec;
+
+//*****************************************************************************
+// COG SOG rapid
+template<typename tValue> struct tN2kCOGSOGRapidValues {
+  unsigned char SID;
+  unsigned char Reference; // tN2kHeadingReference
+  tValue COG;
+  tValue SOG;
+
+  typedef tN2kCOGSOGRapidValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kBitField<T,unsigned char,&T::Reference,1,0,2> tReference;
+  typedef tN2kScaledField<T,tValue,&T::COG,2,2,false,1,10000> tCOG;
+  typedef tN2kScaledField<T,tValue,&T::SOG,4,2,false,1,100> tSOG;
+  typedef tN2kPGNCodec<129026L,3,8,T,tSID,tReference,tCOG,tSOG> tCodec;
+};
+
+typedef tN2kCOGSOGRapidValues<double> tN2kCOGSOGRapidData;
+typedef tN2kCOGSOGRapidValues<float> tN2kCOGSOGRapidFloatData;
+typedef tN2kCOGSOGRapidValues<int32_t> tN2kCOGSOGRapidTicksData;
+typedef tN2kCOGSOGRapidData::tCodec tN2kPGN129026Codec;
+typedef tN2kCOGSOGRapidFloatData::tCodec tN2kPGN129026FloatCodec;
+typedef tN2kCOGSOGRapidTicksData::tCodec tN2kPGN129026TicksCodec;
+
+//*****************************************************************************
+// Local offset
+template<typename tValue> struct tN2kLocalOffsetValues {
+  uint16_t DaysSince1970;
+  tValue SecondsSinceMidnight;
+  int16_t LocalOffset;
+
+  typedef tN2kLocalOffsetValues T;
+  typedef tN2kIntField<T,uint16_t,&T::DaysSince1970,0> tDaysSince1970;
+  typedef tN2kScaledField<T,tValue,&T::SecondsSinceMidnight,2,4,false,1,10000> tSecondsSinceMidnight;
+  typedef tN2kIntField<T,int16_t,&T::LocalOffset,6> tLocalOffset;
+  typedef tN2kPGNCodec<129033L,6,8,T,tDaysSince1970,tSecondsSinceMidnight,tLocalOffset> tCodec;
+};
+
+typedef tN2kLocalOffsetValues<double> tN2kLocalOffsetData;
+typedef tN2kLocalOffsetValues<float> tN2kLocalOffsetFloatData;
+typedef tN2kLocalOffsetValues<int32_t> tN2kLocalOffsetTicksData;
+typedef tN2kLocalOffsetData::tCodec tN2kPGN129033Codec;
+typedef tN2kLocalOffsetFloatData::tCodec tN2kPGN129033FloatCodec;
+typedef tN2kLocalOffsetTicksData::tCodec tN2kPGN129033TicksCodec;
+
+//*****************************************************************************
+// AIS Class A Position Report
+template<typename tValue> struct tN2kAISClassAPositionValues {
+  uint8_t MessageID;
+  unsigned char Repeat; // tN2kAISRepeat
+  uint32_t UserID;
+  tValue Longitude;
+  tValue Latitude;
+  bool Accuracy;
+  bool RAIM;
+  uint8_t Seconds;
+  tValue COG;
+  tValue SOG;
+  tValue Heading;
+  tValue ROT;
+  unsigned char NavStatus; // tN2kAISNavStatus
+
+  typedef tN2kAISClassAPositionValues T;
+  typedef tN2kBitField<T,uint8_t,&T::MessageID,0,0,6> tMessageID;
+  typedef tN2kBitField<T,unsigned char,&T::Repeat,0,6,2> tRepeat;
+  typedef tN2kIntField<T,uint32_t,&T::UserID,1> tUserID;
+  typedef tN2kScaledField<T,tValue,&T::Longitude,5,4,true,1,10000000> tLongitude;
+  typedef tN2kScaledField<T,tValue,&T::Latitude,9,4,true,1,10000000> tLatitude;
+  typedef tN2kBitField<T,bool,&T::Accuracy,13,0,1> tAccuracy;
+  typedef tN2kBitField<T,bool,&T::RAIM,13,1,1> tRAIM;
+  typedef tN2kBitField<T,uint8_t,&T::Seconds,13,2,6> tSeconds;
+  typedef tN2kScaledField<T,tValue,&T::COG,14,2,false,1,10000> tCOG;
+  typedef tN2kScaledField<T,tValue,&T::SOG,16,2,false,1,100> tSOG;
+  typedef tN2kScaledField<T,tValue,&T::Heading,21,2,false,1,10000> tHeading;
+  typedef tN2kScaledField<T,tValue,&T::ROT,23,2,true,1,320000000> tROT;
+  typedef tN2kBitField<T,unsigned char,&T::NavStatus,25,0,4> tNavStatus;
+  typedef tN2kPGNCodec<129038L,6,27,T,tMessageID,tRepeat,tUserID,tLongitude,tLatitude,tAccuracy,tRAIM,tSeconds,tCOG,tSOG,tHeading,tROT,tNavStatus> tCodec;
+};
+
+typedef tN2kAISClassAPositionValues<double> tN2kAISClassAPositionData;
+typedef tN2kAISClassAPositionValues<float> tN2kAISClassAPositionFloatData;
+typedef tN2kAISClassAPositionValues<int32_t> tN2kAISClassAPositionTicksData;
+typedef tN2kAISClassAPositionData::tCodec tN2kPGN129038Codec;
+typedef tN2kAISClassAPositionFloatData::tCodec tN2kPGN129038FloatCodec;
+typedef tN2kAISClassAPositionTicksData::tCodec tN2kPGN129038TicksCodec;
+
+//*****************************************************************************
+// AIS Class B Position Report
+template<typename tValue> struct tN2kAISClassBPositionValues {
+  uint8_t MessageID;
+  unsigned char Repeat; // tN2kAISRepeat
+  uint32_t UserID;
+  tValue Longitude;
+  tValue Latitude;
+  bool Accuracy;
+  bool RAIM;
+  uint8_t Seconds;
+  tValue COG;
+  tValue SOG;
+  tValue Heading;
+  unsigned char Unit; // tN2kAISUnit
+  bool Display;
+  bool DSC;
+  bool Band;
+  bool Msg22;
+  unsigned char Mode; // tN2kAISMode
+  bool State;
+
+  typedef tN2kAISClassBPositionValues T;
+  typedef tN2kBitField<T,uint8_t,&T::MessageID,0,0,6> tMessageID;
+  typedef tN2kBitField<T,unsigned char,&T::Repeat,0,6,2> tRepeat;
+  typedef tN2kIntField<T,uint32_t,&T::UserID,1> tUserID;
+  typedef tN2kScaledField<T,tValue,&T::Longitude,5,4,true,1,10000000> tLongitude;
+  typedef tN2kScaledField<T,tValue,&T::Latitude,9,4,true,1,10000000> tLatitude;
+  typedef tN2kBitField<T,bool,&T::Accuracy,13,0,1> tAccuracy;
+  typedef tN2kBitField<T,bool,&T::RAIM,13,1,1> tRAIM;
+  typedef tN2kBitField<T,uint8_t,&T::Seconds,13,2,6> tSeconds;
+  typedef tN2kScaledField<T,tValue,&T::COG,14,2,false,1,10000> tCOG;
+  typedef tN2kScaledField<T,tValue,&T::SOG,16,2,false,1,100> tSOG;
+  typedef tN2kScaledField<T,tValue,&T::Heading,21,2,false,1,10000> tHeading;
+  typedef tN2kBitField<T,unsigned char,&T::Unit,24,2,1> tUnit;
+  typedef tN2kBitField<T,bool,&T::Display,24,3,1> tDisplay;
+  typedef tN2kBitField<T,bool,&T::DSC,24,4,1> tDSC;
+  typedef tN2kBitField<T,bool,&T::Band,24,5,1> tBand;
+  typedef tN2kBitField<T,bool,&T::Msg22,24,6,1> tMsg22;
+  typedef tN2kBitField<T,unsigned char,&T::Mode,24,7,1> tMode;
+  typedef tN2kBitField<T,bool,&T::State,25,0,1> tState;
+  typedef tN2kPGNCodec<129039L,6,26,T,tMessageID,tRepeat,tUserID,tLongitude,tLatitude,tAccuracy,tRAIM,tSeconds,tCOG,tSOG,tHeading,tUnit,tDisplay,tDSC,tBand,tMsg22,tMode,tState> tCodec;
+};
+
+typedef tN2kAISClassBPositionValues<double> tN2kAISClassBPositionData;
+typedef tN2kAISClassBPositionValues<float> tN2kAISClassBPositionFloatData;
+typedef tN2kAISClassBPositionValues<int32_t> tN2kAISClassBPositionTicksData;
+typedef tN2kAISClassBPositionData::tCodec tN2kPGN129039Codec;
+typedef tN2kAISClassBPositionFloatData::tCodec tN2kPGN129039FloatCodec;
+typedef tN2kAISClassBPositionTicksData::tCodec tN2kPGN129039TicksCodec;
+
+//*****************************************************************************
+// Cross Track Error
+template<typename tValue> struct tN2kXTEValues {
+  unsigned char SID;
+  unsigned char XTEMode; // tN2kXTEMode
+  bool NavigationTerminated;
+  tValue XTE;
+
+  typedef tN2kXTEValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kBitField<T,unsigned char,&T::XTEMode,1,0,4> tXTEMode;
+  typedef tN2kBitField<T,bool,&T::NavigationTerminated,1,6,1> tNavigationTerminated;
+  typedef tN2kScaledField<T,tValue,&T::XTE,2,4,true,1,100> tXTE;
+  typedef tN2kPGNCodec<129283L,6,8,T,tSID,tXTEMode,tNavigationTerminated,tXTE> tCodec;
+};
+
+typedef tN2kXTEValues<double> tN2kXTEData;
+typedef tN2kXTEValues<float> tN2kXTEFloatData;
+typedef tN2kXTEValues<int32_t> tN2kXTETicksData;
+typedef tN2kXTEData::tCodec tN2kPGN129283Codec;
+typedef tN2kXTEFloatData::tCodec tN2kPGN129283FloatCodec;
+typedef tN2kXTETicksData::tCodec tN2kPGN129283TicksCodec;
+
+//*****************************************************************************
+// Navigation info
+template<typename tValue> struct tN2kNavigationInfoValues {
+  unsigned char SID;
+  tValue DistanceToWaypoint;
+  unsigned char BearingReference; // tN2kHeadingReference
+  bool PerpendicularCrossed;
+  bool ArrivalCircleEntered;
+  unsigned char CalculationType; // tN2kDistanceCalculationType
+  tValue ETATime;
+  uint16_t ETADate;
+  tValue BearingOriginToDestinationWaypoint;
+  tValue BearingPositionToDestinationWaypoint;
+  uint32_t OriginWaypointNumber;
+  uint32_t DestinationWaypointNumber;
+  tValue DestinationLatitude;
+  tValue DestinationLongitude;
+  tValue WaypointClosingVelocity;
+
+  typedef tN2kNavigationInfoValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kScaledField<T,tValue,&T::DistanceToWaypoint,1,4,false,1,100> tDistanceToWaypoint;
+  typedef tN2kBitField<T,unsigned char,&T::BearingReference,5,0,2> tBearingReference;
+  typedef tN2kBitField<T,bool,&T::PerpendicularCrossed,5,2,2> tPerpendicularCrossed;
+  typedef tN2kBitField<T,bool,&T::ArrivalCircleEntered,5,4,2> tArrivalCircleEntered;
+  typedef tN2kBitField<T,unsigned char,&T::CalculationType,5,6,2> tCalculationType;
+  typedef tN2kScaledField<T,tValue,&T::ETATime,6,4,false,1,10000> tETATime;
+  typedef tN2kIntField<T,uint16_t,&T::ETADate,10> tETADate;
+  typedef tN2kScaledField<T,tValue,&T::BearingOriginToDestinationWaypoint,12,2,false,1,10000> tBearingOriginToDestinationWaypoint;
+  typedef tN2kScaledField<T,tValue,&T::BearingPositionToDestinationWaypoint,14,2,false,1,10000> tBearingPositionToDestinationWaypoint;
+  typedef tN2kIntField<T,uint32_t,&T::OriginWaypointNumber,16> tOriginWaypointNumber;
+  typedef tN2kIntField<T,uint32_t,&T::DestinationWaypointNumber,20> tDestinationWaypointNumber;
+  typedef tN2kScaledField<T,tValue,&T::DestinationLatitude,24,4,true,1,10000000> tDestinationLatitude;
+  typedef tN2kScaledField<T,tValue,&T::DestinationLongitude,28,4,true,1,10000000> tDestinationLongitude;
+  typedef tN2kScaledField<T,tValue,&T::WaypointClosingVelocity,32,2,true,1,100> tWaypointClosingVelocity;
+  typedef tN2kPGNCodec<129284L,6,34,T,tSID,tDistanceToWaypoint,tBearingReference,tPerpendicularCrossed,tArrivalCircleEntered,tCalculationType,tETATime,tETADate,tBearingOriginToDestinationWaypoint,tBearingPositionToDestinationWaypoint,tOriginWaypointNumber,tDestinationWaypointNumber,tDestinationLatitude,tDestinationLongitude,tWaypointClosingVelocity> tCodec;
+};
+
+typedef tN2kNavigationInfoValues<double> tN2kNavigationInfoData;
+typedef tN2kNavigationInfoValues<float> tN2kNavigationInfoFloatData;
+typedef tN2kNavigationInfoValues<int32_t> tN2kNavigationInfoTicksData;
+typedef tN2kNavigationInfoData::tCodec tN2kPGN129284Codec;
+typedef tN2kNavigationInfoFloatData::tCodec tN2kPGN129284FloatCodec;
+typedef tN2kNavigationInfoTicksData::tCodec tN2kPGN129284TicksCodec;
+
+//*****************************************************************************
+// Wind Speed
+template<typename tValue> struct tN2kWindSpeedValues {
+  unsigned char SID;
+  tValue WindSpeed;
+  tValue WindAngle;
+  unsigned char WindReference; // tN2kWindReference
+
+  typedef tN2kWindSpeedValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kScaledField<T,tValue,&T::WindSpeed,1,2,false,1,100> tWindSpeed;
+  typedef tN2kScaledField<T,tValue,&T::WindAngle,3,2,false,1,10000> tWindAngle;
+  typedef tN2kBitField<T,unsigned char,&T::WindReference,5,0,3> tWindReference;
+  typedef tN2kPGNCodec<130306L,6,8,T,tSID,tWindSpeed,tWindAngle,tWindReference> tCodec;
+};
+
+typedef tN2kWindSpeedValues<double> tN2kWindSpeedData;
+typedef tN2kWindSpeedValues<float> tN2kWindSpeedFloatData;
+typedef tN2kWindSpeedValues<int32_t> tN2kWindSpeedTicksData;
+typedef tN2kWindSpeedData::tCodec tN2kPGN130306Codec;
+typedef tN2kWindSpeedFloatData::tCodec tN2kPGN130306FloatCodec;
+typedef tN2kWindSpeedTicksData::tCodec tN2kPGN130306TicksCodec;
+
+//*****************************************************************************
+// Outside Environmental parameters
+template<typename tValue> struct tN2kOutsideEnvironmentalValues {
+  unsigned char SID;
+  tValue WaterTemperature;
+  tValue OutsideAmbientAirTemperature;
+  tValue AtmosphericPressure;
+
+  typedef tN2kOutsideEnvironmentalValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kScaledField<T,tValue,&T::WaterTemperature,1,2,false,1,100> tWaterTemperature;
+  typedef tN2kScaledField<T,tValue,&T::OutsideAmbientAirTemperature,3,2,false,1,100> tOutsideAmbientAirTemperature;
+  typedef tN2kScaledField<T,tValue,&T::AtmosphericPressure,5,2,false,100> tAtmosphericPressure;
+  typedef tN2kPGNCodec<130310L,5,8,T,tSID,tWaterTemperature,tOutsideAmbientAirTemperature,tAtmosphericPressure> tCodec;
+};
+
+typedef tN2kOutsideEnvironmentalValues<double> tN2kOutsideEnvironmentalData;
+typedef tN2kOutsideEnvironmentalValues<float> tN2kOutsideEnvironmentalFloatData;
+typedef tN2kOutsideEnvironmentalValues<int32_t> tN2kOutsideEnvironmentalTicksData;
+typedef tN2kOutsideEnvironmentalData::tCodec tN2kPGN130310Codec;
+typedef tN2kOutsideEnvironmentalFloatData::tCodec tN2kPGN130310FloatCodec;
+typedef tN2kOutsideEnvironmentalTicksData::tCodec tN2kPGN130310TicksCodec;
+
+//*****************************************************************************
+// Environmental parameters
+template<typename tValue> struct tN2kEnvironmentalValues {
+  unsigned char SID;
+  unsigned char TempSource; // tN2kTempSource
+  unsigned char HumiditySource; // tN2kHumiditySource
+  tValue Temperature;
+  tValue Humidity;
+  tValue AtmosphericPressure;
+
+  typedef tN2kEnvironmentalValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kBitField<T,unsigned char,&T::TempSource,1,0,6> tTempSource;
+  typedef tN2kBitField<T,unsigned char,&T::HumiditySource,1,6,2> tHumiditySource;
+  typedef tN2kScaledField<T,tValue,&T::Temperature,2,2,false,1,100> tTemperature;
+  typedef tN2kScaledField<T,tValue,&T::Humidity,4,2,true,4,1000> tHumidity;
+  typedef tN2kScaledField<T,tValue,&T::AtmosphericPressure,6,2,false,100> tAtmosphericPressure;
+  typedef tN2kPGNCodec<130311L,5,8,T,tSID,tTempSource,tHumiditySource,tTemperature,tHumidity,tAtmosphericPressure> tCodec;
+};
+
+typedef tN2kEnvironmentalValues<double> tN2kEnvironmentalData;
+typedef tN2kEnvironmentalValues<float> tN2kEnvironmentalFloatData;
+typedef tN2kEnvironmentalValues<int32_t> tN2kEnvironmentalTicksData;
+typedef tN2kEnvironmentalData::tCodec tN2kPGN130311Codec;
+typedef tN2kEnvironmentalFloatData::tCodec tN2kPGN130311FloatCodec;
+typedef tN2kEnvironmentalTicksData::tCodec tN2kPGN130311TicksCodec;
+
+//*****************************************************************************
+// Temperature
+template<typename tValue> struct tN2kTemperatureValues {
+  unsigned char SID;
+  unsigned char TempInstance;
+  unsigned char TempSource; // tN2kTempSource
+  tValue ActualTemperature;
+  tValue SetTemperature;
+
+  typedef tN2kTemperatureValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kIntField<T,unsigned char,&T::TempInstance,1> tTempInstance;
+  typedef tN2kIntField<T,unsigned char,&T::TempSource,2> tTempSource;
+  typedef tN2kScaledField<T,tValue,&T::ActualTemperature,3,2,false,1,100> tActualTemperature;
+  typedef tN2kScaledField<T,tValue,&T::SetTemperature,5,2,false,1,100> tSetTemperature;
+  typedef tN2kPGNCodec<130312L,5,8,T,tSID,tTempInstance,tTempSource,tActualTemperature,tSetTemperature> tCodec;
+};
+
+typedef tN2kTemperatureValues<double> tN2kTemperatureData;
+typedef tN2kTemperatureValues<float> tN2kTemperatureFloatData;
+typedef tN2kTemperatureValues<int32_t> tN2kTemperatureTicksData;
+typedef tN2kTemperatureData::tCodec tN2kPGN130312Codec;
+typedef tN2kTemperatureFloatData::tCodec tN2kPGN130312FloatCodec;
+typedef tN2kTemperatureTicksData::tCodec tN2kPGN130312TicksCodec;
+
+//*****************************************************************************
+// Humidity
+template<typename tValue> struct tN2kHumidityValues {
+  unsigned char SID;
+  unsigned char HumidityInstance;
+  unsigned char HumiditySource; // tN2kHumiditySource
+  tValue ActualHumidity;
+  tValue SetHumidity;
+
+  typedef tN2kHumidityValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kIntField<T,unsigned char,&T::HumidityInstance,1> tHumidityInstance;
+  typedef tN2kIntField<T,unsigned char,&T::HumiditySource,2> tHumiditySource;
+  typedef tN2kScaledField<T,tValue,&T::ActualHumidity,3,2,true,4,1000> tActualHumidity;
+  typedef tN2kScaledField<T,tValue,&T::SetHumidity,5,2,true,4,1000> tSetHumidity;
+  typedef tN2kPGNCodec<130313L,5,8,T,tSID,tHumidityInstance,tHumiditySource,tActualHumidity,tSetHumidity> tCodec;
+};
+
+typedef tN2kHumidityValues<double> tN2kHumidityData;
+typedef tN2kHumidityValues<float> tN2kHumidityFloatData;
+typedef tN2kHumidityValues<int32_t> tN2kHumidityTicksData;
+typedef tN2kHumidityData::tCodec tN2kPGN130313Codec;
+typedef tN2kHumidityFloatData::tCodec tN2kPGN130313FloatCodec;
+typedef tN2kHumidityTicksData::tCodec tN2kPGN130313TicksCodec;
+
+//*****************************************************************************
+// Pressure
+template<typename tValue> struct tN2kPressureValues {
+  unsigned char SID;
+  unsigned char PressureInstance;
+  unsigned char PressureSource; // tN2kPressureSource
+  tValue ActualPressure;
+
+  typedef tN2kPressureValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kIntField<T,unsigned char,&T::PressureInstance,1> tPressureInstance;
+  typedef tN2kIntField<T,unsigned char,&T::PressureSource,2> tPressureSource;
+  typedef tN2kScaledField<T,tValue,&T::ActualPressure,3,4,false,1,10> tActualPressure;
+  typedef tN2kPGNCodec<130314L,5,8,T,tSID,tPressureInstance,tPressureSource,tActualPressure> tCodec;
+};
+
+typedef tN2kPressureValues<double> tN2kPressureData;
+typedef tN2kPressureValues<float> tN2kPressureFloatData;
+typedef tN2kPressureValues<int32_t> tN2kPressureTicksData;
+typedef tN2kPressureData::tCodec tN2kPGN130314Codec;
+typedef tN2kPressureFloatData::tCodec tN2kPGN130314FloatCodec;
+typedef tN2kPressureTicksData::tCodec tN2kPGN130314TicksCodec;
+
+//*****************************************************************************
+// Temperature extended range
+template<typename tValue> struct tN2kTemperatureExtValues {
+  unsigned char SID;
+  unsigned char TempInstance;
+  unsigned char TempSource; // tN2kTempSource
+  tValue ActualTemperature;
+  tValue SetTemperature;
+
+  typedef tN2kTemperatureExtValues T;
+  typedef tN2kIntField<T,unsigned char,&T::SID,0> tSID;
+  typedef tN2kIntField<T,unsigned char,&T::TempInstance,1> tTempInstance;
+  typedef tN2kIntField<T,unsigned char,&T::TempSource,2> tTempSource;
+  typedef tN2kScaledField<T,tValue,&T::ActualTemperature,3,3,true,1,1000> tActualTemperature;
+  typedef tN2kScaledField<T,tValue,&T::SetTemperature,6,2,true,1,10> tSetTemperature;
+  typedef tN2kPGNCodec<130316L,5,8,T,tSID,tTempInstance,tTempSource,tActualTemperature,tSetTemperature> tCodec;
+};
+
+typedef tN2kTemperatureExtValues<double> tN2kTemperatureExtData;
+typedef tN2kTemperatureExtValues<float> tN2kTemperatureExtFloatData;
+typedef tN2kTemperatureExtValues<int32_t> tN2kTemperatureExtTicksData;
+typedef tN2kTemperatureExtData::tCodec tN2kPGN130316Codec;
+typedef tN2kTemperatureExtFloatData::tCodec tN2kPGN130316FloatCodec;
+typedef tN2kTemperatureExtTicksData::tCodec tN2kPGN130316TicksCodec;
+
+//*****************************************************************************
+// Small Craft Status (Trim Tab Position)
+struct tN2kTrimTabData {
+  int8_t PortTrimTab;
+  int8_t StbdTrimTab;
+
+  typedef tN2kTrimTabData T;
+  typedef tN2kIntField<T,int8_t,&T::PortTrimTab,0> tPortTrimTab;
+  typedef tN2kIntField<T,int8_t,&T::StbdTrimTab,1> tStbdTrimTab;
+  typedef tN2kPGNCodec<130576L,6,3,T,tPortTrimTab,tStbdTrimTab> tCodec;
+};
+
+typedef tN2kTrimTabData::tCodec tN2kPGN130576Codec;
+#endif
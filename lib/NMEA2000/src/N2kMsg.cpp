@@ -291,6 +291,55 @@ double tN2kMsg::Get8ByteDouble(double precision, int &Index, double def) const {
   } else return def;
 }
 
+//*****************************************************************************
+float tN2kMsg::Get1ByteFloat(float precision, int &Index, float def) const {
+  if (Index<DataLen) {
+    return GetBuf1ByteFloat(precision,Index,Data,def);
+  } else return def;
+}
+
+//*****************************************************************************
+float tN2kMsg::Get1ByteUFloat(float precision, int &Index, float def) const {
+  if (Index<DataLen) {
+    return GetBuf1ByteUFloat(precision,Index,Data,def);
+  } else return def;
+}
+
+//*****************************************************************************
+float tN2kMsg::Get2ByteFloat(float precision, int &Index, float def) const {
+  if (Index+2<=DataLen) {
+    return GetBuf2ByteFloat(precision,Index,Data,def);
+  } else return def;
+}
+
+//*****************************************************************************
+float tN2kMsg::Get2ByteUFloat(float precision, int &Index, float def) const {
+  if (Index+2<=DataLen) {
+    return GetBuf2ByteUFloat(precision,Index,Data,def);
+  } else return def;
+}
+
+//*****************************************************************************
+float tN2kMsg::Get3ByteFloat(float precision, int &Index, float def) const {
+  if (Index+3<=DataLen) {
+    return GetBuf3ByteFloat(precision,Index,Data,def);
+  } else return def;
+}
+
+//*****************************************************************************
+float tN2kMsg::Get4ByteFloat(float precision, int &Index, float def) const {
+  if (Index+4<=DataLen) {
+    return GetBuf4ByteFloat(precision,Index,Data,def);
+  } else return def;
+}
+
+//*****************************************************************************
+float tN2kMsg::Get4ByteUFloat(float precision, int &Index, float def) const {
+  if (Index+4<=DataLen) {
+    return GetBuf4ByteUFloat(precision,Index,Data,def);
+  } else return def;
+}
+
 //*****************************************************************************
 bool tN2kMsg::GetStr(char *StrBuf, size_t Length, int &Index) const {
   unsigned char vb;
@@ -571,6 +620,62 @@ double GetBuf4ByteUDouble(double precision, int &index, const unsigned char *buf
   return vl * precision;
 }
 
+//*****************************************************************************
+float GetBuf1ByteFloat(float precision, int &index, const unsigned char *buf, float def) {
+  int8_t vl = GetBuf<int8_t>(1, index, buf);
+  if (vl==0x7f) return def;
+
+  return vl * precision;
+}
+
+//*****************************************************************************
+float GetBuf1ByteUFloat(float precision, int &index, const unsigned char *buf, float def) {
+  uint8_t vl = GetBuf<uint8_t>(1, index, buf);
+  if (vl==0xff) return def;
+
+  return vl * precision;
+}
+
+//*****************************************************************************
+float GetBuf2ByteFloat(float precision, int &index, const unsigned char *buf, float def) {
+  int16_t vl = GetBuf<int16_t>(2, index, buf);
+  if (vl==0x7fff) return def;
+
+  return vl * precision;
+}
+
+//*****************************************************************************
+float GetBuf2ByteUFloat(float precision, int &index, const unsigned char *buf, float def) {
+  uint16_t vl = GetBuf<uint16_t>(2, index, buf);
+  if (vl==0xffff) return def;
+
+  return vl * precision;
+}
+
+//*****************************************************************************
+float GetBuf3ByteFloat(float precision, int &index, const unsigned char *buf, float def) {
+  int32_t vl = GetBuf<int32_t>(3, index, buf);
+  if (vl==0x007fffff) return def;
+
+  return vl * precision;
+}
+
+//*****************************************************************************
+float GetBuf4ByteFloat(float precision, int &index, const unsigned char *buf, float def) {
+  int32_t vl = GetBuf<int32_t>(4, index, buf);
+  if (vl==0x7fffffff) return def;
+
+  return vl * precision;
+}
+
+//*****************************************************************************
+float GetBuf4ByteUFloat(float precision, int &index, const unsigned char *buf, float def) {
+  uint32_t vl = GetBuf<uint32_t>(4, index, buf);
+  if (vl==0xffffffff) return def;
+
+  return vl * precision;
+}
+
 //*****************************************************************************
 void SetBuf2ByteDouble(double v, double precision, int &index, unsigned char *buf) {
   int16_t vi = (int16_t)round(v/precision);
@@ -32,6 +32,7 @@ Definition for NMEA2000 message class used in my NMEA2000 libraries.
 #include <stdint.h>
 
 const double   N2kDoubleNA=-1e9;
+const float    N2kFloatNA=-1e9;
 const uint8_t  N2kUInt8NA=0xff;
 const int8_t   N2kInt8NA=0x7f;
 const uint16_t N2kUInt16NA=0xffff;
@@ -43,6 +44,7 @@ const int32_t  N2kInt32NA=0x7fffffff;
 #endif
 
 inline bool N2kIsNA(double v) { return v==N2kDoubleNA; }
+inline bool N2kIsNA(float v) { return v==N2kFloatNA; }
 inline bool N2kIsNA(uint8_t v) { return v==N2kUInt8NA; }
 inline bool N2kIsNA(int8_t v) { return v==N2kInt8NA; }
 inline bool N2kIsNA(uint16_t v) { return v==N2kUInt16NA; }
@@ -78,6 +80,15 @@ double GetBuf3ByteDouble(double precision, int &index, const unsigned char *buf,
 double GetBuf4ByteDouble(double precision, int &index, const unsigned char *buf, double def=0);
 double GetBuf4ByteUDouble(double precision, int &index, const unsigned char *buf, double def=-1);
 double GetBuf8ByteDouble(double precision, int &index, const unsigned char *buf, double def=0);
+// Float versions for targets with single precision FPU only. 4 byte values
+// have more significant digits than float, so they lose resolution.
+float GetBuf1ByteFloat(float precision, int &index, const unsigned char *buf, float def=0);
+float GetBuf1ByteUFloat(float precision, int &index, const unsigned char *buf, float def=-1);
+float GetBuf2ByteFloat(float precision, int &index, const unsigned char *buf, float def=0);
+float GetBuf2ByteUFloat(float precision, int &index, const unsigned char *buf, float def=-1);
+float GetBuf3ByteFloat(float precision, int &index, const unsigned char *buf, float def=0);
+float GetBuf4ByteFloat(float precision, int &index, const unsigned char *buf, float def=0);
+float GetBuf4ByteUFloat(float precision, int &index, const unsigned char *buf, float def=-1);
 
 
 class tN2kMsg
@@ -136,6 +147,13 @@ public:
   double Get4ByteDouble(double precision, int &Index, double def=N2kDoubleNA) const;
   double Get4ByteUDouble(double precision, int &Index, double def=N2kDoubleNA) const;
   double Get8ByteDouble(double precision, int &Index, double def=N2kDoubleNA) const;
+  float Get1ByteFloat(float precision, int &Index, float def=N2kFloatNA) const;
+  float Get1ByteUFloat(float precision, int &Index, float def=N2kFloatNA) const;
+  float Get2ByteFloat(float precision, int &Index, float def=N2kFloatNA) const;
+  float Get2ByteUFloat(float precision, int &Index, float def=N2kFloatNA) const;
+  float Get3ByteFloat(float precision, int &Index, float def=N2kFloatNA) const;
+  float Get4ByteFloat(float precision, int &Index, float def=N2kFloatNA) const;
+  float Get4ByteUFloat(float precision, int &Index, float def=N2kFloatNA) const;
   bool GetStr(char *StrBuf, size_t Length, int &Index) const;
   bool GetStr(size_t StrBufSize, char *StrBuf, size_t Length, unsigned char nulChar, int &Index) const;
   bool GetVarStr(size_t &StrBufSize, char *StrBuf, int &Index) const;
@@ -0,0 +1,203 @@
+/* 
+N2kMsgScheduler.cpp
+
+Copyright (c) 2015-2018 Timo Lappalainen, Kave Oy, www.kave.fi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "N2kMsgScheduler.h"
+
+//*****************************************************************************
+tN2kMsgScheduler::tN2kMsgScheduler() {
+  Pool=0;
+  PoolSize=0;
+  FreeList=NoEntry;
+  Due.Head=Due.Tail=NoEntry;
+  for (uint8_t l=0; l<Levels; l++) {
+    LevelCount[l]=0;
+    for (uint8_t s=0; s<Slots; s++) Wheel[l][s].Head=Wheel[l][s].Tail=NoEntry;
+  }
+  Current=0;
+  memset(&Statistics,0,sizeof(Statistics));
+}
+
+//*****************************************************************************
+tN2kMsgScheduler::~tN2kMsgScheduler() {
+  delete[] Pool;
+}
+
+//*****************************************************************************
+void tN2kMsgScheduler::Init(uint16_t _PoolSize, unsigned long Now) {
+  delete[] Pool;
+  if ( _PoolSize==NoEntry ) _PoolSize--;
+  PoolSize=_PoolSize;
+  Pool=( PoolSize>0 ? new tEntry[PoolSize] : 0 );
+  if ( Pool==0 ) PoolSize=0; // Allocation failed, Add rejects all messages
+  FreeList=NoEntry;
+  for (uint16_t i=PoolSize; i>0; i--) {
+    Pool[i-1].Next=FreeList;
+    FreeList=i-1;
+  }
+  Due.Head=Due.Tail=NoEntry;
+  for (uint8_t l=0; l<Levels; l++) {
+    LevelCount[l]=0;
+    for (uint8_t s=0; s<Slots; s++) Wheel[l][s].Head=Wheel[l][s].Tail=NoEntry;
+  }
+  Current=Now;
+  memset(&Statistics,0,sizeof(Statistics));
+}
+
+//*****************************************************************************
+void tN2kMsgScheduler::ResetStatistics() {
+  uint16_t InUse=Statistics.InUse;
+  memset(&Statistics,0,sizeof(Statistics));
+  Statistics.InUse=Statistics.MaxInUse=InUse;
+}
+
+//*****************************************************************************
+void tN2kMsgScheduler::Append(tList &List, uint16_t Index) {
+  Pool[Index].Next=NoEntry;
+  if ( List.Tail==NoEntry ) {
+    List.Head=Index;
+  } else {
+    Pool[List.Tail].Next=Index;
+  }
+  List.Tail=Index;
+}
+
+//*****************************************************************************
+// Puts entry to level, which slot covers its SendTime counted from Current.
+// Entry with SendTime before Current is due already, since its ms has been
+// handled, so it goes right to due list.
+void tN2kMsgScheduler::Place(uint16_t Index) {
+  unsigned long Time=Pool[Index].SendTime;
+  long Delta=(long)(Time-Current);
+
+  if ( Delta<0 ) { Append(Due,Index); return; }
+  uint8_t Level=0;
+  if ( Delta>=(1L<<(Levels*SlotBits)) ) { // Beyond wheel, wait in last slot
+    Time=Current+(1UL<<(Levels*SlotBits))-1;
+    Level=Levels-1;
+  } else {
+    while ( Level<Levels-1 && Delta>=(1L<<((Level+1)*SlotBits)) ) Level++;
+  }
+  Append(Wheel[Level][(Time>>(Level*SlotBits)) & SlotMask],Index);
+  LevelCount[Level]++;
+}
+
+//*****************************************************************************
+// Places entries of Level slot reached by Current again to lower levels.
+void tN2kMsgScheduler::Cascade(uint8_t Level) {
+  tList &Slot=Wheel[Level][(Current>>(Level*SlotBits)) & SlotMask];
+  uint16_t Index=Slot.Head;
+  Slot.Head=Slot.Tail=NoEntry;
+  while ( Index!=NoEntry ) {
+    uint16_t Next=Pool[Index].Next;
+    LevelCount[Level]--;
+    Place(Index);
+    Index=Next;
+  }
+}
+
+//*****************************************************************************
+void tN2kMsgScheduler::ExpireSlot() {
+  tList &Slot=Wheel[0][Current & SlotMask];
+  if ( Slot.Head==NoEntry ) return;
+
+  for (uint16_t Index=Slot.Head; Index!=NoEntry; Index=Pool[Index].Next) LevelCount[0]--;
+  if ( Due.Tail==NoEntry ) {
+    Due.Head=Slot.Head;
+  } else {
+    Pool[Due.Tail].Next=Slot.Head;
+  }
+  Due.Tail=Slot.Tail;
+  Slot.Head=Slot.Tail=NoEntry;
+}
+
+//*****************************************************************************
+bool tN2kMsgScheduler::Add(const tN2kMsg &N2kMsg, unsigned long SendTime, int DeviceIndex) {
+  if ( FreeList==NoEntry ) {
+    Statistics.Rejected++;
+    return false;
+  }
+
+  uint16_t Index=FreeList;
+  FreeList=Pool[Index].Next;
+  Pool[Index].N2kMsg=N2kMsg;
+  Pool[Index].SendTime=SendTime;
+  Pool[Index].DeviceIndex=DeviceIndex;
+  Place(Index);
+
+  Statistics.Scheduled++;
+  Statistics.InUse++;
+  if ( Statistics.InUse>Statistics.MaxInUse ) Statistics.MaxInUse=Statistics.InUse;
+  return true;
+}
+
+//*****************************************************************************
+void tN2kMsgScheduler::Advance(unsigned long Now) {
+  const unsigned long Level1Mask=(1UL<<(2*SlotBits))-1;
+
+  while ( (long)(Now-Current)>=0 ) {
+    if ( LevelCount[0]==0 && LevelCount[1]==0 && LevelCount[2]==0 ) { Current=Now+1; break; }
+
+    if ( (Current & SlotMask)==0 ) {
+      if ( (Current & Level1Mask)==0 ) Cascade(2);
+      Cascade(1);
+    }
+
+    if ( LevelCount[0]==0 ) { // Nothing to expire before next cascade
+      unsigned long Next=( LevelCount[1]==0 ? (Current | Level1Mask) : (Current | SlotMask) )+1;
+      if ( (long)(Next-Now)>0 ) { Current=Now+1; break; }
+      Current=Next;
+      continue;
+    }
+
+    ExpireSlot();
+    Current++;
+  }
+}
+
+//*****************************************************************************
+bool tN2kMsgScheduler::PeekDue(const tN2kMsg *&N2kMsg, int &DeviceIndex, unsigned long &SendTime) const {
+  if ( Due.Head==NoEntry ) return false;
+
+  N2kMsg=&Pool[Due.Head].N2kMsg;
+  DeviceIndex=Pool[Due.Head].DeviceIndex;
+  SendTime=Pool[Due.Head].SendTime;
+  return true;
+}
+
+//*****************************************************************************
+void tN2kMsgScheduler::ReleaseDue(unsigned long Now, bool Sent) {
+  if ( Due.Head==NoEntry ) return;
+
+  uint16_t Index=Due.Head;
+  Due.Head=Pool[Index].Next;
+  if ( Due.Head==NoEntry ) Due.Tail=NoEntry;
+  Pool[Index].Next=FreeList;
+  FreeList=Index;
+
+  unsigned long Lateness=( (long)(Now-Pool[Index].SendTime)>0 ? Now-Pool[Index].SendTime : 0 );
+  if ( Sent ) { Statistics.Sent++; } else { Statistics.Failed++; }
+  Statistics.TotalLateness+=Lateness;
+  if ( Lateness>Statistics.MaxLateness ) Statistics.MaxLateness=Lateness;
+  Statistics.InUse--;
+}
@@ -0,0 +1,110 @@
+/* 
+N2kMsgScheduler.h
+
+Copyright (c) 2015-2018 Timo Lappalainen, Kave Oy, www.kave.fi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _tN2kMsgScheduler_H_
+#define _tN2kMsgScheduler_H_
+
+#include <stdint.h>
+#include "N2kMsg.h"
+
+// Keeps messages, which should be sent later, in hierarchical timer wheel.
+// Wheel has 3 levels with 64 slots each. Level 0 slot is 1 ms, level 1 slot
+// 64 ms and level 2 slot 4096 ms, so wheel covers about 4.4 minutes. Later
+// messages wait in last level 2 slot and will be placed again, when it
+// cascades.
+//
+// Messages will be copied to fixed pool, so memory is bounded. Insert is
+// O(1). Advance handles one slot per ms, but skips over empty levels, so
+// expiry is O(1) per message plus at most 64 steps per level.
+class tN2kMsgScheduler
+{
+public:
+  struct tStatistics {
+    uint32_t Scheduled;     // Messages accepted
+    uint32_t Rejected;      // Messages rejected, since pool was full
+    uint32_t Sent;          // Messages released and sent
+    uint32_t Failed;        // Messages released, but send failed
+    uint32_t TotalLateness; // Sum of ms released messages were late. Average is TotalLateness/(Sent+Failed).
+    uint32_t MaxLateness;
+    uint16_t InUse;
+    uint16_t MaxInUse;
+  };
+
+protected:
+  static const uint8_t SlotBits=6;
+  static const uint8_t Slots=1<<SlotBits;
+  static const uint8_t SlotMask=Slots-1;
+  static const uint8_t Levels=3;
+  static const uint16_t NoEntry=0xffff;
+
+  struct tEntry {
+    tN2kMsg N2kMsg;
+    unsigned long SendTime;
+    uint16_t Next;
+    int16_t DeviceIndex;
+  };
+
+  struct tList {
+    uint16_t Head;
+    uint16_t Tail;
+  };
+
+  tEntry *Pool;
+  uint16_t PoolSize;
+  uint16_t FreeList;
+  tList Wheel[Levels][Slots];
+  uint16_t LevelCount[Levels];
+  tList Due;
+  unsigned long Current; // Next ms to be handled
+  tStatistics Statistics;
+
+  void Append(tList &List, uint16_t Index);
+  void Place(uint16_t Index);
+  void Cascade(uint8_t Level);
+  void ExpireSlot();
+
+public:
+  tN2kMsgScheduler();
+  ~tN2kMsgScheduler();
+
+  // Allocates pool for _PoolSize messages. Clears all scheduled messages.
+  void Init(uint16_t _PoolSize, unsigned long Now);
+
+  // Copies message to pool. Message will be due at SendTime or right away,
+  // if SendTime has passed. Returns false, if pool is full.
+  bool Add(const tN2kMsg &N2kMsg, unsigned long SendTime, int DeviceIndex);
+
+  // Moves messages with SendTime<=Now to due list.
+  void Advance(unsigned long Now);
+
+  // Gives first due message in order of SendTime. Call ReleaseDue after
+  // handling it.
+  bool PeekDue(const tN2kMsg *&N2kMsg, int &DeviceIndex, unsigned long &SendTime) const;
+  void ReleaseDue(unsigned long Now, bool Sent);
+
+  uint16_t GetPoolSize() const { return PoolSize; }
+  const tStatistics &GetStatistics() const { return Statistics; }
+  void ResetStatistics();
+};
+
+#endif
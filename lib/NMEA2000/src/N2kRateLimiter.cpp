@@ -0,0 +1,161 @@
+/* 
+N2kRateLimiter.cpp
+
+Copyright (c) 2015-2018 Timo Lappalainen, Kave Oy, www.kave.fi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include "N2kRateLimiter.h"
+
+//*****************************************************************************
+tN2kRateLimiter::tN2kRateLimiter() {
+  Limits=0;
+  MaxLimits=0;
+  LimitCount=0;
+  Table=0;
+  TableMask=0;
+  MaxEntries=0;
+  EntryCount=0;
+  TableFull=0;
+}
+
+//*****************************************************************************
+tN2kRateLimiter::~tN2kRateLimiter() {
+  delete[] Limits;
+  delete[] Table;
+}
+
+//*****************************************************************************
+void tN2kRateLimiter::Init(uint8_t _MaxLimits, uint16_t _MaxBuckets) {
+  delete[] Limits;
+  delete[] Table;
+  if ( _MaxLimits==NoLimit ) _MaxLimits--;
+  MaxLimits=_MaxLimits;
+  MaxEntries=(uint16_t)_MaxLimits+_MaxBuckets;
+  uint16_t TableSize=8;
+  while ( TableSize<2*MaxEntries && TableSize<0x8000 ) TableSize<<=1; // Keep load under 50%
+  if ( MaxEntries>TableSize/2 ) MaxEntries=TableSize/2;
+  TableMask=TableSize-1;
+  Limits=new tLimit[MaxLimits];
+  Table=new tEntry[TableSize];
+  memset(Table,0,TableSize*sizeof(tEntry));
+  LimitCount=0;
+  EntryCount=0;
+  TableFull=0;
+}
+
+//*****************************************************************************
+// Entries will never be removed, so linear probing needs no deleted markers.
+tN2kRateLimiter::tEntry *tN2kRateLimiter::Find(uint32_t _Key, bool Add) {
+  if ( Table==0 ) return 0;
+
+  uint16_t i=Home(_Key);
+  for (; Table[i].Key!=0; i=(i+1) & TableMask) {
+    if ( Table[i].Key==_Key ) return &Table[i];
+  }
+  if ( !Add || EntryCount>=MaxEntries ) return 0;
+
+  EntryCount++;
+  Table[i].Key=_Key;
+  return &Table[i];
+}
+
+//*****************************************************************************
+bool tN2kRateLimiter::SetLimit(unsigned long PGN, uint16_t Interval, uint8_t Burst, tPolicy Policy) {
+  tEntry *Entry=Find(Key(PGN,LimitSource),false);
+  uint8_t Limit;
+
+  if ( Entry!=0 ) {
+    Limit=Entry->Limit;
+  } else {
+    if ( LimitCount>=MaxLimits ) return false;
+    Entry=Find(Key(PGN,LimitSource),true);
+    if ( Entry==0 ) return false;
+    Limit=LimitCount++;
+    Entry->Limit=Limit;
+    Limits[Limit].PGN=PGN;
+    memset(&Limits[Limit].Statistics,0,sizeof(tStatistics));
+  }
+
+  if ( Burst==0 ) Burst=1;
+  Limits[Limit].Interval=Interval;
+  Limits[Limit].MaxCredit=(uint32_t)Burst*Interval;
+  Limits[Limit].Policy=Policy;
+
+  return true;
+}
+
+//*****************************************************************************
+tN2kRateLimiter::tResult tN2kRateLimiter::Check(unsigned long PGN, unsigned char Source, unsigned long Now, uint8_t &Limit) {
+  Limit=NoLimit;
+  if ( LimitCount==0 ) return rlr_Pass;
+
+  tEntry *LimitEntry=Find(Key(PGN,LimitSource),false);
+  if ( LimitEntry==0 ) return rlr_Pass;
+
+  tLimit &PGNLimit=Limits[LimitEntry->Limit];
+  if ( PGNLimit.Interval==0 ) return rlr_Pass;
+
+  tEntry *Bucket=Find(Key(PGN,Source),false);
+  if ( Bucket==0 ) {
+    Bucket=Find(Key(PGN,Source),true);
+    if ( Bucket==0 ) { TableFull++; return rlr_Pass; }
+    Bucket->Limit=LimitEntry->Limit;
+    Bucket->Credit=PGNLimit.MaxCredit; // Start with full burst
+    Bucket->LastTime=Now;
+  }
+
+  unsigned long Elapsed=Now-Bucket->LastTime;
+  Bucket->LastTime=Now;
+  if ( Bucket->Credit>PGNLimit.MaxCredit ) Bucket->Credit=PGNLimit.MaxCredit; // Limit has been changed
+  Bucket->Credit=( Elapsed>=PGNLimit.MaxCredit-Bucket->Credit ? PGNLimit.MaxCredit : Bucket->Credit+Elapsed );
+
+  if ( Bucket->Credit>=PGNLimit.Interval ) {
+    Bucket->Credit-=PGNLimit.Interval;
+    PGNLimit.Statistics.Passed++;
+    return rlr_Pass;
+  }
+
+  Limit=LimitEntry->Limit;
+  if ( PGNLimit.Policy==rlp_Coalesce ) return rlr_Coalesce;
+  PGNLimit.Statistics.Dropped++;
+  return rlr_Drop;
+}
+
+//*****************************************************************************
+void tN2kRateLimiter::CountCoalesced(uint8_t Limit, bool Coalesced) {
+  if ( Limit>=LimitCount ) return;
+  if ( Coalesced ) {
+    Limits[Limit].Statistics.Coalesced++;
+  } else {
+    Limits[Limit].Statistics.Dropped++;
+  }
+}
+
+//*****************************************************************************
+const tN2kRateLimiter::tStatistics *tN2kRateLimiter::GetStatistics(unsigned long PGN) const {
+  if ( Table==0 ) return 0;
+
+  uint32_t _Key=Key(PGN,LimitSource);
+  for (uint16_t i=Home(_Key); Table[i].Key!=0; i=(i+1) & TableMask) {
+    if ( Table[i].Key==_Key ) return &Limits[Table[i].Limit].Statistics;
+  }
+  return 0;
+}
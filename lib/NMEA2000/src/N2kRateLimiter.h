@@ -0,0 +1,106 @@
+/* 
+N2kRateLimiter.h
+
+Copyright (c) 2015-2018 Timo Lappalainen, Kave Oy, www.kave.fi
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the
+Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _tN2kRateLimiter_H_
+#define _tN2kRateLimiter_H_
+
+#include <stdint.h>
+
+// Token bucket rate limiter for sent messages. Limits are set per PGN and
+// every source sending that PGN gets own bucket. Bucket gets one token per
+// Interval ms and keeps at most Burst tokens. Tokens are kept as ms credit,
+// so no floating point is needed.
+//
+// Limits and buckets are in one open addressing hash table. Limit entry has
+// source 0xff, which is not valid sending source. So message with PGN
+// without limit costs one probe.
+class tN2kRateLimiter
+{
+public:
+  typedef enum { rlp_Drop, // Messages over limit will be dropped
+                 rlp_Coalesce // Messages over limit replace same message waiting in send buffer or will be dropped
+               } tPolicy;
+
+  typedef enum { rlr_Pass, rlr_Drop, rlr_Coalesce } tResult;
+
+  struct tStatistics {
+    uint32_t Passed;
+    uint32_t Dropped;
+    uint32_t Coalesced;
+  };
+
+protected:
+  static const uint8_t NoLimit=0xff;
+  static const unsigned char LimitSource=0xff;
+
+  struct tLimit {
+    unsigned long PGN;
+    uint32_t MaxCredit; // Burst*Interval
+    uint16_t Interval;
+    uint8_t Policy;
+    tStatistics Statistics;
+  };
+
+  struct tEntry {
+    uint32_t Key;   // 0 for empty. PGN and source.
+    uint32_t Credit;
+    unsigned long LastTime;
+    uint8_t Limit;
+  };
+
+  tLimit *Limits;
+  uint8_t MaxLimits;
+  uint8_t LimitCount;
+  tEntry *Table;
+  uint16_t TableMask;
+  uint16_t MaxEntries;
+  uint16_t EntryCount;
+  uint32_t TableFull; // Sources, which could not get bucket and were not limited
+
+  static uint32_t Key(unsigned long PGN, unsigned char Source) { return ((PGN & 0x3ffffUL) | ((uint32_t)Source<<18)) + 1; }
+  uint16_t Home(uint32_t _Key) const { return (uint16_t)(((uint32_t)(_Key*2654435761UL))>>16) & TableMask; }
+  tEntry *Find(uint32_t _Key, bool Add);
+
+public:
+  tN2kRateLimiter();
+  ~tN2kRateLimiter();
+
+  // Allocates room for _MaxLimits limits and _MaxBuckets source buckets.
+  // Clears all limits.
+  void Init(uint8_t _MaxLimits, uint16_t _MaxBuckets);
+
+  // Sets or changes limit for PGN. Interval 0 removes limit. Returns false, if there is no room.
+  bool SetLimit(unsigned long PGN, uint16_t Interval, uint8_t Burst=1, tPolicy Policy=rlp_Drop);
+
+  // Takes token for message, if PGN has limit. Returns rlr_Drop or rlr_Coalesce
+  // according to policy, if bucket is empty. Limit will be set to index for
+  // counting coalescing result.
+  tResult Check(unsigned long PGN, unsigned char Source, unsigned long Now, uint8_t &Limit);
+  void CountCoalesced(uint8_t Limit, bool Coalesced);
+
+  // Returns statistics for PGN or 0, if it does not have limit.
+  const tStatistics *GetStatistics(unsigned long PGN) const;
+  uint32_t GetTableFull() const { return TableFull; }
+};
+
+#endif
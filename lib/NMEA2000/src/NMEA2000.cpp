@@ -106,6 +106,11 @@ void N2kPrintFreeMemory(const char *Source) {
 #define TP_CM_AbortNoResources 2	// System resources were needed for another task so this connection managed session was terminated.
 #define TP_CM_AbortTimeout 3 //	A timeout occurred and this is the connection abort to close the session.
 
+#define TP_BAM_MinInterval 50 // ms between BAM data packets
+#define TP_BAM_MaxInterval 200
+#define TP_T3 1250 // ms to wait CTS or ACK after RTS or last data packet
+#define TP_T4 1050 // ms to wait next CTS after CTS hold
+
 
 const unsigned long DefTransmitMessages[] PROGMEM = {
                                         59392L, /* ISO Acknowledgement */
@@ -139,90 +144,93 @@ const unsigned long DefReceiveMessages[] PROGMEM = {
 #endif
                                        0};
                                        
-bool IsSingleFrameSystemMessage(unsigned long PGN) {
-                                  switch (PGN) {
-                                      case  59392L: /* ISO Acknowledgement */
-                                      case   TP_DT: /* Multi packet data transfer, TP.DT */
-                                      case   TP_CM: /* Multi packet connection management, TP.CM */
-                                      case  59904L: /* ISO Request */
-                                      case  60928L: /* ISO Address Claim */
-                                      return true;
-                                  }
-                                  return false;
-}
-
-bool IsFastPacketSystemMessage(unsigned long PGN) {
-                                  switch (PGN) {
-                                      case  65240L: /* Commanded Address*/
-                                      case 126208L: /* NMEA Request/Command/Acknowledge group function */
-                                      return true;
-                                  }
-                                  return false;
-}
-
-bool IsDefaultSingleFrameMessage(unsigned long PGN) {
-                                  switch (PGN) {
-                                      case 126992L: // System date/time
-                                      case 126993L: /* Heartbeat */
-                                      case 127245L: // Rudder
-                                      case 127250L: // Vessel Heading
-                                      case 127251L: // Rate of Turn
-                                      case 127257L: // Attitude
-                                      case 127488L: // Engine parameters rapid
-                                      case 127493L: // Transmission parameters: dynamic
-                                      case 127501L: // Binary status report
-                                      case 127505L: // Fluid level
-                                      case 127508L: // Battery Status
-                                      case 127513L: // Battery Configuration Status
-                                      case 128259L: // Boat speed
-                                      case 128267L: // Water depth
-                                      case 129025L: // Lat/lon rapid
-                                      case 129026L: // COG SOG rapid
-                                      case 129283L: // Cross Track Error
-                                      case 130306L: // Wind Speed
-                                      case 130310L: // Outside Environmental parameters
-                                      case 130311L: // Environmental parameters
-                                      case 130312L: // Temperature
-                                      case 130314L: // Pressure
-                                      case 130316L: // Temperature extended range
-                                      case 130576L: // Small Craft Status (Trim Tab position)
-                                      return true;
-                                  }
-                                  return false;
-}
-
-bool IsMandatoryFastPacketMessage(unsigned long PGN) {
-                                  switch (PGN) {
-                                      case 126464L: /* PGN List (Transmit and Receive) */
-                                      case 126996L: /* Product information */
-                                      case 126998L: /* Configuration information */
-                                      return true;
-                                  }
-                                  return false;
-}
-
-bool IsDefaultFastPacketMessage(unsigned long PGN) {
-                                  switch (PGN) {
-                                      case 127237L: /* Heading/Track control */
-                                      case 127489L: /* Engine parameters dynamic */
-                                      case 127506L: /* DC Detailed status */
-                                      case 128275L: /* Distance log */
-                                      case 129029L: /* GNSS Position Data */
-                                      case 129038L: /*AIS Class A Position Report*/
-                                      case 129039L: /*AIS Class B Position Report*/
-                                      case 129284L: // Navigation info
-                                      case 129285L: // Waypoint list
-                                      case 129540L: /* GNSS Sats in View */
-                                      case 129794L: /*AIS Class A Static data*/
-                                      case 129802L: /*AIS Safety Related Broadcast Message*/
-                                      case 129809L: /*AIS Class B Static Data: Part A*/
-                                      case 129810L: /*AIS Class B Static Data Part B*/
-                                      case 130074L: // Waypoint list
-                                      return true;
-                                  }
-                                  return false;
+const unsigned long SingleFrameSystemMessages[] PROGMEM = {
+                                        59392L, /* ISO Acknowledgement */
+                                         TP_DT, /* Multi packet data transfer, TP.DT */
+                                         TP_CM, /* Multi packet connection management, TP.CM */
+                                        59904L, /* ISO Request */
+                                        60928L, /* ISO Address Claim */
+                                       0};
+
+const unsigned long FastPacketSystemMessages[] PROGMEM = {
+                                        65240L, /* Commanded Address*/
+                                       126208L, /* NMEA Request/Command/Acknowledge group function */
+                                       0};
+
+const unsigned long DefaultSingleFrameMessages[] PROGMEM = {
+                                       126992L, // System date/time
+                                       126993L, /* Heartbeat */
+                                       127245L, // Rudder
+                                       127250L, // Vessel Heading
+                                       127251L, // Rate of Turn
+                                       127257L, // Attitude
+                                       127488L, // Engine parameters rapid
+                                       127493L, // Transmission parameters: dynamic
+                                       127501L, // Binary status report
+                                       127505L, // Fluid level
+                                       127508L, // Battery Status
+                                       127513L, // Battery Configuration Status
+                                       128259L, // Boat speed
+                                       128267L, // Water depth
+                                       129025L, // Lat/lon rapid
+                                       129026L, // COG SOG rapid
+                                       129283L, // Cross Track Error
+                                       130306L, // Wind Speed
+                                       130310L, // Outside Environmental parameters
+                                       130311L, // Environmental parameters
+                                       130312L, // Temperature
+                                       130314L, // Pressure
+                                       130316L, // Temperature extended range
+                                       130576L, // Small Craft Status (Trim Tab position)
+                                       0};
+
+const unsigned long MandatoryFastPacketMessages[] PROGMEM = {
+                                       126464L, /* PGN List (Transmit and Receive) */
+                                       126996L, /* Product information */
+                                       126998L, /* Configuration information */
+                                       0};
+
+const unsigned long DefaultFastPacketMessages[] PROGMEM = {
+                                       127237L, /* Heading/Track control */
+                                       127489L, /* Engine parameters dynamic */
+                                       127506L, /* DC Detailed status */
+                                       128275L, /* Distance log */
+                                       129029L, /* GNSS Position Data */
+                                       129038L, /*AIS Class A Position Report*/
+                                       129039L, /*AIS Class B Position Report*/
+                                       129284L, // Navigation info
+                                       129285L, // Waypoint list
+                                       129540L, /* GNSS Sats in View */
+                                       129794L, /*AIS Class A Static data*/
+                                       129802L, /*AIS Safety Related Broadcast Message*/
+                                       129809L, /*AIS Class B Static Data: Part A*/
+                                       129810L, /*AIS Class B Static Data Part B*/
+                                       130074L, // Waypoint list
+                                       0};
+
+//*****************************************************************************
+static bool IsPGNInList(unsigned long PGN, const unsigned long *List) {
+  if ( List==0 || PGN==0 ) return false;
+  unsigned long ListPGN;
+  for (int i=0; (ListPGN=pgm_read_dword(&List[i]))!=0; i++) {
+    if ( ListPGN==PGN ) return true;
+  }
+  return false;
 }
 
+//*****************************************************************************
+static int PGNListLength(const unsigned long *List) {
+  int i=0;
+  if ( List!=0 ) for (; pgm_read_dword(&List[i])!=0; i++);
+  return i;
+}
+
+bool IsSingleFrameSystemMessage(unsigned long PGN) { return IsPGNInList(PGN,SingleFrameSystemMessages); }
+bool IsFastPacketSystemMessage(unsigned long PGN) { return IsPGNInList(PGN,FastPacketSystemMessages); }
+bool IsDefaultSingleFrameMessage(unsigned long PGN) { return IsPGNInList(PGN,DefaultSingleFrameMessages); }
+bool IsMandatoryFastPacketMessage(unsigned long PGN) { return IsPGNInList(PGN,MandatoryFastPacketMessages); }
+bool IsDefaultFastPacketMessage(unsigned long PGN) { return IsPGNInList(PGN,DefaultFastPacketMessages); }
+
 const tNMEA2000::tProductInformation DefProductInformation PROGMEM = {
                                        2101,               // N2kVersion
                                        666,                // ProductCode
@@ -283,16 +291,62 @@ tNMEA2000::tNMEA2000() {
   ForwardStream=0;
 
   for (int i=0; i<N2kMessageGroups; i++) {SingleFrameMessages[i]=0; FastPacketMessages[i]=0;}
+#if !defined(N2K_NO_PGN_CLASS_TABLE)
+  PGNClassTable=0;
+  PGNClassCount=0;
+#endif
 
   N2kCANMsgBuf=0;
   MaxN2kCANMsgs=0;
 
   MaxCANSendFrames=40;
   MaxCANReceiveFrames=0; // Use driver default
+  MaxReadFramesOnParse=20;
+  MaxParseTime=0;
+  HasHeldFrame=false;
+  ResetParseStatistics();
+  ResetSendStatistics();
+  CoalescedMessages=0;
+#if !defined(N2K_NO_SEND_RATE_LIMIT)
+  SendRateLimiter=0;
+#endif
+#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
+  TPSessions=0;
+  MaxTPSessions=4;
+  TPSessionOrder=0;
+  ResetTPStatistics();
+#endif
+#if !defined(N2K_NO_SCHEDULED_SEND)
+  MsgScheduler=0;
+  MaxScheduledMsgs=4;
+#endif
+#if !defined(N2K_NO_RX_STATISTICS)
+  RxPGNStatistics=0;
+  MaxRxPGNStatistics=0;
+  RxSourceEvents=0;
+  RxStatistics.SlotsInUse=0;
+  ResetRxStatistics();
+#endif
+#if !defined(N2K_NO_TX_LATENCY)
+  TxPriorityLatency=0;
+  TxPGNLatency=0;
+  MaxTxPGNLatency=0;
+  TxSlowest=0;
+  MaxTxSlowest=0;
+  ResetTxLatency();
+#endif
   CANSendFrameBuf=0;
 
   MsgHandler=0;
   MsgHandlers=0;
+  FrameCaptureHandler=0;
+  FrameCaptureContext=0;
+#if !defined(N2K_NO_MSG_HANDLER_TABLE)
+  MsgHandlerSpans=0;
+  MsgHandlerSpanCount=0;
+  FirstPGNMsgHandler=0;
+  MsgHandlersChanged=false;
+#endif
   ISORqstHandler=0;
 
   DeviceReady=false;
@@ -311,12 +365,13 @@ tNMEA2000::tNMEA2000() {
                                      DefInstallationDescription2);
   Devices=0;
   DeviceCount=1;
+  SourceDevices=0;
 }
 
 //*****************************************************************************
 void tNMEA2000::SetDeviceCount(const uint8_t _DeviceCount) {
-  // Note that we can set this only before any initialization. Limit count to 10.
-  if ( Devices==0 && _DeviceCount>=1 && _DeviceCount<10 ) DeviceCount=_DeviceCount;
+  // Note that we can set this only before any initialization. Limit count to available addresses.
+  if ( Devices==0 && _DeviceCount>=1 && _DeviceCount<=N2kMaxCanBusAddress+1 ) DeviceCount=_DeviceCount;
 }
 
 //*****************************************************************************
@@ -324,7 +379,12 @@ void tNMEA2000::InitDevices() {
   if ( Devices==0 ) {
     N2kDbgln("Init devices");
     Devices=new tInternalDevice[DeviceCount];
-    MaxCANSendFrames*=DeviceCount; // We need bigger buffer for sending all information
+    MaxCANSendFrames*=(DeviceCount<10?DeviceCount:10); // We need bigger buffer for sending all information
+    if ( DeviceCount>1 ) { // Avoid scanning devices for every received message
+      SourceDevices=new uint8_t[N2kNullCanBusAddress];
+      for (int i=0; i<N2kNullCanBusAddress; i++) SourceDevices[i]=0xff;
+      SourceDevices[0]=0; // All devices have source 0 until SetMode
+    }
 //    for (int i=0; i<DeviceCount; i++) Devices[i].tDevice();
     // We set default device information here.
     Devices[0].LocalProductInformation=0;
@@ -440,35 +500,63 @@ size_t tNMEA2000::GetFastPacketTxPGNCount(int iDev) {
   return FPTxPGNCount;
 }
 
+#define SequenceCounterUsed 0x80000000UL
+
 //*****************************************************************************
+// Returns index of PGN counter or of empty entry, where it should be added.
+// Table must have at least one empty entry.
+static uint16_t FindSequenceCounter(const uint32_t *Counters, uint16_t Size, unsigned long PGN) {
+  uint16_t Mask=Size-1;
+  uint16_t i=(uint16_t)(((uint32_t)(PGN*2654435761UL))>>16) & Mask;
+
+  for (; Counters[i]!=0; i=(i+1) & Mask) {
+    if ( (Counters[i] & 0x00ffffffUL)==PGN ) break;
+  }
+  return i;
+}
+
+//*****************************************************************************
+// Every PGN gets own counter. Table will be kept at most half full, so lookup
+// takes about one probe independent of transmit list length.
 int tNMEA2000::GetSequenceCounter(unsigned long PGN, int iDev) {
   if ( !IsValidDevice(iDev) ) return 0;
-  
-  if ( Devices[iDev].PGNSequenceCounters==0 ) { // Sequence counters has not yet been initialized
-    Devices[iDev].MaxPGNSequenceCounters=GetFastPacketTxPGNCount(iDev)+1; // Reserve 1 for undefined PGNs
-    Devices[iDev].PGNSequenceCounters=new unsigned long[Devices[iDev].MaxPGNSequenceCounters];
-    for ( size_t i=0; i<Devices[iDev].MaxPGNSequenceCounters; i++ ) Devices[iDev].PGNSequenceCounters[i]=0;
-  }
-  if ( Devices[iDev].PGNSequenceCounters==0 ) return 0; // Should not be. Only in case of memory allocation problem.
-  size_t last=Devices[iDev].MaxPGNSequenceCounters-1;
-  unsigned long sc;
-  for ( size_t i=0; i<last; i++ ) {
-    if ( Devices[iDev].PGNSequenceCounters[i]==0 ) { // Empty place, use this
-      Devices[iDev].PGNSequenceCounters[i]=PGN;
-      return 0; // Start from sequence 0
-    }
-    if ( (Devices[iDev].PGNSequenceCounters[i]&0x00ffffff) == PGN ) { // Found counter, use it
-      sc=Devices[iDev].PGNSequenceCounters[i]>>24;
-      sc++; if (sc>7) sc=0; // Get next counter
-      Devices[iDev].PGNSequenceCounters[i]=PGN | (sc << 24);
+  tInternalDevice &Device=Devices[iDev];
+
+  PGN&=0x00ffffffUL;
+  if ( Device.PGNSequenceCounters!=0 ) {
+    uint16_t i=FindSequenceCounter(Device.PGNSequenceCounters,Device.PGNSequenceCounterSize,PGN);
+    if ( Device.PGNSequenceCounters[i]!=0 ) { // Found counter, use it
+      uint32_t sc=((Device.PGNSequenceCounters[i]>>24)+1) & 0x7; // Get next counter
+      Device.PGNSequenceCounters[i]=SequenceCounterUsed | PGN | (sc << 24);
       return sc;
     }
   }
-  // PGN counter not found, so use common
-  sc=Devices[iDev].PGNSequenceCounters[last];
-  sc++; if (sc>7) sc=0;
-  Devices[iDev].PGNSequenceCounters[last]=sc;
-  return sc;
+
+  // New PGN. Grow table, if it would get over half full.
+  if ( 2*(Device.PGNSequenceCounterCount+1)>Device.PGNSequenceCounterSize && Device.PGNSequenceCounterSize<0x8000 ) {
+    uint16_t Size=( Device.PGNSequenceCounterSize>0 ? 2*Device.PGNSequenceCounterSize : 8 );
+    if ( Device.PGNSequenceCounters==0 ) { // Reserve room for known fast packet PGNs
+      size_t Known=GetFastPacketTxPGNCount(iDev);
+      while ( Size<2*Known && Size<0x8000 ) Size<<=1;
+    }
+    uint32_t *Counters=new uint32_t[Size];
+    if ( Counters!=0 ) {
+      memset(Counters,0,Size*sizeof(uint32_t));
+      for (uint16_t i=0; i<Device.PGNSequenceCounterSize; i++) {
+        uint32_t Entry=Device.PGNSequenceCounters[i];
+        if ( Entry!=0 ) Counters[FindSequenceCounter(Counters,Size,Entry & 0x00ffffffUL)]=Entry;
+      }
+      delete[] Device.PGNSequenceCounters;
+      Device.PGNSequenceCounters=Counters;
+      Device.PGNSequenceCounterSize=Size;
+    }
+  }
+  // Should not be. Only in case of memory allocation problem.
+  if ( Device.PGNSequenceCounterCount+1>=Device.PGNSequenceCounterSize ) return 0;
+
+  Device.PGNSequenceCounters[FindSequenceCounter(Device.PGNSequenceCounters,Device.PGNSequenceCounterSize,PGN)]=SequenceCounterUsed | PGN;
+  Device.PGNSequenceCounterCount++;
+  return 0; // Start from sequence 0
 }
 
 #if !defined(N2K_NO_GROUP_FUNCTION_SUPPORT)
@@ -754,21 +842,25 @@ void tNMEA2000::SetDeviceInformationInstances(
 //*****************************************************************************
 void tNMEA2000::SetSingleFrameMessages(const unsigned long *_SingleFrameMessages) {
   SingleFrameMessages[0]=_SingleFrameMessages;
+  UpdatePGNClassTable();
 }
 
 //*****************************************************************************
 void tNMEA2000::SetFastPacketMessages(const unsigned long *_FastPacketMessages) {
   FastPacketMessages[0]=_FastPacketMessages;
+  UpdatePGNClassTable();
 }
 
 //*****************************************************************************
 void tNMEA2000::ExtendSingleFrameMessages(const unsigned long *_SingleFrameMessages) {
   SingleFrameMessages[1]=_SingleFrameMessages;
+  UpdatePGNClassTable();
 }
 
 //*****************************************************************************
 void tNMEA2000::ExtendFastPacketMessages(const unsigned long *_FastPacketMessages) {
   FastPacketMessages[1]=_FastPacketMessages;
+  UpdatePGNClassTable();
 }
 
 //*****************************************************************************
@@ -789,9 +881,12 @@ void tNMEA2000::ExtendReceiveMessages(const unsigned long *_Messages, int iDev)
 void tNMEA2000::SetMode(tN2kMode _N2kMode, unsigned long _N2kSource) {
   InitDevices();
   N2kMode=_N2kMode;
+  // Start addresses wrap inside claimable range, so each of up to 252 devices gets own address.
+  unsigned char Source=_N2kSource%(N2kMaxCanBusAddress+1);
   for (int i=0; i<DeviceCount; i++) {
-    Devices[i].N2kSource=_N2kSource+i;
+    SetDeviceSource(i,Source);
     Devices[i].UpdateAddressClaimEndSource();
+    Source=( Source<N2kMaxCanBusAddress ? Source+1 : 0 );
   }
   AddressChanged=false;
 }
@@ -801,8 +896,12 @@ void tNMEA2000::InitCANFrameBuffers() {
     if ( CANSendFrameBuf==0 && !IsInitialized() ) {
       if ( MaxCANSendFrames>0 ) CANSendFrameBuf = new tCANSendFrame[MaxCANSendFrames];
       N2kDbg("Initialize frame buffer. Size: "); N2kDbg(MaxCANSendFrames); N2kDbg(", address:"); N2kDbgln((uint32_t)CANSendFrameBuf);
-      CANSendFrameBufferWrite=0;
-      CANSendFrameBufferRead=0;
+      for (int i=0; i<8; i++) { SendQueues[i].Head=SendQueues[i].Tail=SendQueues[i].Count=0; }
+      CANSendFrameFree=0;
+      CANSendFrameFreeCount=( CANSendFrameBuf!=0 ? MaxCANSendFrames : 0 );
+      for (uint16_t i=0; i<CANSendFrameFreeCount; i++) CANSendFrameBuf[i].Next=i+1;
+      SendPriorityLock=0xff;
+      SendLockFramesLeft=0;
     }
 
     // Receive buffer has sense only with interrupt handling. So it must be handled on inherited class.
@@ -814,11 +913,19 @@ bool tNMEA2000::Open() {
   if (!DeviceReady) {
     InitCANFrameBuffers();
     InitDevices();
+#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
+    if ( TPSessions==0 && MaxTPSessions>0 ) {
+      TPSessions=new tTPSession[MaxTPSessions];
+      for (uint8_t i=0; i<MaxTPSessions; i++) TPSessions[i].State=tps_Free;
+    }
+#endif
 
     if ( N2kCANMsgBuf==0 ) {
       if ( MaxN2kCANMsgs==0 ) MaxN2kCANMsgs=5;
       N2kCANMsgBuf = new tN2kCANMsg[MaxN2kCANMsgs];
       for (int i=0; i<MaxN2kCANMsgs; i++) N2kCANMsgBuf[i].FreeMessage();
+      N2kCANMsgIndex.Init(MaxN2kCANMsgs);
+      UpdatePGNClassTable();
 
 #if !defined(N2K_NO_GROUP_FUNCTION_SUPPORT)
       // On first open try add also default group function handlers
@@ -881,42 +988,221 @@ unsigned long N2ktoCanID(unsigned char priority, unsigned long PGN, unsigned lon
 }
 
 //*****************************************************************************
+// Sends buffered frames by priority. Returns true, if driver took all frames.
+// While fast packet is being sent, only its priority will be sent, so other
+// frames do not get between its frames. Then returns true, when its queue is
+// empty, so SendFrame can send next frame of fast packet directly.
 bool tNMEA2000::SendFrames()
-{ uint16_t temp;
-
+{
   if ( CANSendFrameBuf==0 ) return true; // This can be in case, where inherited class defines own buffering.
 
-  while (CANSendFrameBufferRead!=CANSendFrameBufferWrite) {
-    temp = (CANSendFrameBufferRead + 1) % MaxCANSendFrames;
-    if ( CANSendFrame(CANSendFrameBuf[temp].id, CANSendFrameBuf[temp].len, CANSendFrameBuf[temp].buf, CANSendFrameBuf[temp].wait_sent) ) {
-      CANSendFrameBufferRead=temp;
-      N2kFrameOutDbg("Frame unbuffered "); N2kFrameOutDbgln(CANSendFrameBuf[temp].id);
-    } else return false;
+  while (true) {
+    uint8_t Priority=SendPriorityLock;
+    if ( Priority<8 ) {
+      if ( SendQueues[Priority].Count==0 ) return true;
+    } else {
+      for (Priority=0; Priority<8 && SendQueues[Priority].Count==0; Priority++);
+      if ( Priority==8 ) return true;
+    }
+
+    tSendQueue &Queue=SendQueues[Priority];
+    uint16_t Index=Queue.Head;
+    tCANSendFrame &Frame=CANSendFrameBuf[Index];
+    if ( !CANSendFrame(Frame.id, Frame.len, Frame.buf, Frame.wait_sent) ) return false;
+    N2kFrameOutDbg("Frame unbuffered "); N2kFrameOutDbgln(Frame.id);
+
+    unsigned long Delay=millis()-Frame.QueuedAt;
+    tSendStatistics &Statistics=SendStatistics[Priority];
+    Statistics.TotalDelay+=Delay;
+    if ( Delay>Statistics.MaxDelay ) Statistics.MaxDelay=( Delay<0xffff ? Delay : 0xffff );
+
+    Queue.Head=Frame.Next;
+    Queue.Count--;
+    Frame.Next=CANSendFrameFree;
+    CANSendFrameFree=Index;
+    CANSendFrameFreeCount++;
+    CANSendFrameDone(Frame.id,Frame.buf,Frame.wait_sent,Delay);
   }
+}
 
-  return true;
+//*****************************************************************************
+// Counts sent frame and keeps priority lock until last frame of fast packet
+// has been sent. Fast packet frames are sent with wait_sent.
+void tNMEA2000::CANSendFrameDone(unsigned long id, const unsigned char *buf, bool FastPacket, unsigned long Delay) {
+  uint8_t Priority=(id>>26) & 0x7;
+  SendStatistics[Priority].Frames++;
+  if ( !FastPacket ) {
+#if !defined(N2K_NO_TX_LATENCY)
+    if ( TxPriorityLatency!=0 ) CountTxLatency(id,Delay);
+#endif
+    return;
+  }
+
+  if ( (buf[0] & 0x1f)==0 ) {
+    SendLockFramesLeft=( buf[1]>6 ? (buf[1]-6-1)/7+1 : 0 );
+  } else if ( SendLockFramesLeft>0 ) {
+    SendLockFramesLeft--;
+  }
+  SendPriorityLock=( SendLockFramesLeft>0 ? Priority : 0xff );
+#if !defined(N2K_NO_TX_LATENCY)
+  // All frames of fast packet were queued at same time, so last frame tells message latency
+  if ( TxPriorityLatency!=0 && SendLockFramesLeft==0 ) CountTxLatency(id,Delay);
+#endif
+}
+
+#if !defined(N2K_NO_TX_LATENCY)
+//*****************************************************************************
+static void AddTxLatency(tNMEA2000::tTxLatencyHistogram &Histogram, uint16_t Latency) {
+  uint8_t Bucket=0;
+  for (uint16_t l=Latency; l>0 && Bucket<tNMEA2000::TxLatencyBuckets-1; l>>=1) Bucket++;
+  if ( Histogram.Count[Bucket]<0xffff ) Histogram.Count[Bucket]++;
+  if ( Latency>Histogram.MaxLatency ) Histogram.MaxLatency=Latency;
+}
+
+//*****************************************************************************
+void tNMEA2000::CountTxLatency(unsigned long id, unsigned long Latency) {
+  unsigned char Priority;
+  unsigned long PGN;
+  unsigned char Source;
+  unsigned char Destination;
+  uint16_t ms=( Latency<0xffff ? Latency : 0xffff );
+
+  CanIdToN2k(id,Priority,PGN,Source,Destination);
+  AddTxLatency(TxPriorityLatency[Priority],ms);
+
+  if ( TxPGNLatency!=0 ) {
+    uint8_t i=0;
+    for ( ; i<TxPGNLatencyCount && TxPGNLatency[i].PGN!=PGN; i++ );
+    if ( i==TxPGNLatencyCount && TxPGNLatencyCount<MaxTxPGNLatency ) {
+      TxPGNLatency[i].PGN=PGN;
+      memset(&TxPGNLatency[i].Histogram,0,sizeof(TxPGNLatency[i].Histogram));
+      TxPGNLatencyCount++;
+    }
+    if ( i<TxPGNLatencyCount ) AddTxLatency(TxPGNLatency[i].Histogram,ms);
+  }
+
+  if ( TxSlowest==0 ) return;
+  uint8_t Index;
+  if ( TxSlowestCount<MaxTxSlowest ) {
+    Index=TxSlowestCount++;
+  } else if ( ms>TxSlowest[TxSlowestMin].Latency ) {
+    Index=TxSlowestMin;
+  } else return;
+  TxSlowest[Index].PGN=PGN;
+  TxSlowest[Index].SentTime=millis();
+  TxSlowest[Index].Latency=ms;
+  TxSlowest[Index].Priority=Priority;
+  TxSlowest[Index].Source=Source;
+  if ( TxSlowestCount==MaxTxSlowest ) { // Find new fastest, which will be replaced next
+    TxSlowestMin=0;
+    for (uint8_t i=1; i<TxSlowestCount; i++) {
+      if ( TxSlowest[i].Latency<TxSlowest[TxSlowestMin].Latency ) TxSlowestMin=i;
+    }
+  }
 }
 
+//*****************************************************************************
+void tNMEA2000::SetTxLatencyTracing(uint8_t MaxPGNs, uint8_t Slowest) {
+  if ( TxPriorityLatency!=0 ) delete[] TxPriorityLatency;
+  if ( TxPGNLatency!=0 ) delete[] TxPGNLatency;
+  if ( TxSlowest!=0 ) delete[] TxSlowest;
+  TxPriorityLatency=( MaxPGNs>0 || Slowest>0 ? new tTxLatencyHistogram[8] : 0 );
+  TxPGNLatency=( MaxPGNs>0 ? new tTxPGNLatency[MaxPGNs] : 0 );
+  MaxTxPGNLatency=MaxPGNs;
+  TxSlowest=( Slowest>0 ? new tTxLatencyTrace[Slowest] : 0 );
+  MaxTxSlowest=Slowest;
+
+  ResetTxLatency();
+}
+
+//*****************************************************************************
+void tNMEA2000::ResetTxLatency() {
+  if ( TxPriorityLatency!=0 ) memset(TxPriorityLatency,0,8*sizeof(tTxLatencyHistogram));
+  TxPGNLatencyCount=0;
+  TxSlowestCount=0;
+  TxSlowestMin=0;
+}
+
+//*****************************************************************************
+static void PrintTxLatencyHistogram(N2kStream *OutStream, const tNMEA2000::tTxLatencyHistogram &Histogram) {
+  for (uint8_t i=0; i<tNMEA2000::TxLatencyBuckets; i++) { OutStream->print(Histogram.Count[i]); OutStream->print(F(" ")); }
+  OutStream->print(F("max ")); OutStream->println(Histogram.MaxLatency);
+}
+
+//*****************************************************************************
+void tNMEA2000::PrintTxLatency(N2kStream *OutStream) {
+  if ( OutStream==0 ) OutStream=ForwardStream;
+  if ( OutStream==0 || TxPriorityLatency==0 ) return;
+
+  OutStream->print(F("Tx latency ms:"));
+  for (uint8_t i=0; i<TxLatencyBuckets; i++) { OutStream->print(F(" ")); OutStream->print(i==0?0:1<<(i-1)); }
+  OutStream->println(F("+"));
+  for (uint8_t Priority=0; Priority<8; Priority++) {
+    OutStream->print(F("Priority ")); OutStream->print(Priority); OutStream->print(F(": "));
+    PrintTxLatencyHistogram(OutStream,TxPriorityLatency[Priority]);
+  }
+  for (uint8_t i=0; i<TxPGNLatencyCount; i++) {
+    OutStream->print(F("PGN ")); OutStream->print(TxPGNLatency[i].PGN); OutStream->print(F(": "));
+    PrintTxLatencyHistogram(OutStream,TxPGNLatency[i].Histogram);
+  }
+
+  // Print slowest first by selecting next slower than previous printed
+  uint16_t Below=0xffff;
+  uint8_t Printed=0;
+  while ( Printed<TxSlowestCount ) {
+    uint16_t Latency=0;
+    for (uint8_t i=0; i<TxSlowestCount; i++) {
+      if ( TxSlowest[i].Latency<=Below && TxSlowest[i].Latency>=Latency ) Latency=TxSlowest[i].Latency;
+    }
+    for (uint8_t i=0; i<TxSlowestCount; i++) {
+      if ( TxSlowest[i].Latency!=Latency ) continue;
+      OutStream->print(F("Slow PGN ")); OutStream->print(TxSlowest[i].PGN);
+      OutStream->print(F(" priority ")); OutStream->print(TxSlowest[i].Priority);
+      OutStream->print(F(" source ")); OutStream->print(TxSlowest[i].Source);
+      OutStream->print(F(" latency ")); OutStream->print(TxSlowest[i].Latency);
+      OutStream->print(F(" ms at ")); OutStream->println(TxSlowest[i].SentTime);
+      Printed++;
+    }
+    if ( Latency==0 ) break;
+    Below=Latency-1;
+  }
+}
+#endif
+
 //*****************************************************************************
 bool tNMEA2000::SendFrame(unsigned long id, unsigned char len, const unsigned char *buf, bool wait_sent) {
 
-  if ( !SendFrames() || !CANSendFrame(id,len,buf,wait_sent) ) { // If we can not sent frame immediately, add it to buffer
-    tCANSendFrame *Frame=GetNextFreeCANSendFrame();
+  if ( SendFrames() && CANSendFrame(id,len,buf,wait_sent) ) {
+    CANSendFrameDone(id,buf,wait_sent);
+  } else { // If we can not sent frame immediately, add it to buffer
+    uint8_t Priority=(id>>26) & 0x7;
+    tCANSendFrame *Frame=GetNextFreeCANSendFrame(Priority);
     if ( Frame==0 ) {
       N2kFrameOutDbg("Frame failed "); N2kFrameOutDbgln(id);
+      SendStatistics[Priority].Dropped++;
+      SendPriorityLock=0xff; // Rest of fast packet will not come
+      SendLockFramesLeft=0;
       return false;
     }
     len=N2kMax<unsigned char>(len,8);
     Frame->id=id;
     Frame->len=len;
     Frame->wait_sent=wait_sent;
+    Frame->QueuedAt=millis();
     for (int i=0; i<len; i++) Frame->buf[i]=buf[i];
+    SendStatistics[Priority].QueuedFrames++;
+    if ( SendQueues[Priority].Count>SendStatistics[Priority].MaxQueued ) SendStatistics[Priority].MaxQueued=SendQueues[Priority].Count;
     N2kFrameOutDbg("Frame buffered "); N2kFrameOutDbgln(id);
   }
 
   return true;
 }
 
+//*****************************************************************************
+void tNMEA2000::ResetSendStatistics() {
+  memset(SendStatistics,0,sizeof(SendStatistics));
+}
+
 #if !defined(N2K_NO_HEARTBEAT_SUPPORT)
 //*****************************************************************************
 void tNMEA2000::SetHeartbeatInterval(unsigned long interval, bool SetAsDefault, int iDev) {
@@ -965,19 +1251,139 @@ void tNMEA2000::SendHeartbeat(bool force) {
 #endif
 
 //*****************************************************************************
-tNMEA2000::tCANSendFrame *tNMEA2000::GetNextFreeCANSendFrame() {
-  if (CANSendFrameBuf==0) return 0;
+// Takes frame from free list and appends it to queue of Priority.
+tNMEA2000::tCANSendFrame *tNMEA2000::GetNextFreeCANSendFrame(uint8_t Priority) {
+  if (CANSendFrameBuf==0 || CANSendFrameFreeCount==0) return 0;
 
-  uint16_t temp = (CANSendFrameBufferWrite + 1) % MaxCANSendFrames;
+  uint16_t Index=CANSendFrameFree;
+  CANSendFrameFree=CANSendFrameBuf[Index].Next;
+  CANSendFrameFreeCount--;
+
+  tSendQueue &Queue=SendQueues[Priority & 0x7];
+  CANSendFrameBuf[Index].Next=MaxCANSendFrames;
+  if ( Queue.Count==0 ) { Queue.Head=Index; } else { CANSendFrameBuf[Queue.Tail].Next=Index; }
+  Queue.Tail=Index;
+  Queue.Count++;
+
+  return &(CANSendFrameBuf[Index]);
+}
+
+//*****************************************************************************
+// Checks that all frames of message can be sent or buffered, so message will
+// be either sent as whole or rejected before any frame goes to the bus.
+// Driver may accept some frames directly, but in worst case all will be buffered.
+// Message with more frames than buffer size can never be queued as whole.
+bool tNMEA2000::HasSendFrameSpace(int Frames) {
+  if ( CANSendFrameBuf==0 ) return true; // Inherited class buffers. Try anyway.
+  if ( Frames>MaxCANSendFrames ) return false;
+  if ( GetCANSendFrameBufFree()>=Frames ) return true;
+  SendFrames(); // Try to make room
+  return ( GetCANSendFrameBufFree()>=Frames );
+}
+
+//*****************************************************************************
+// Fills frame FrameNo of fast packet. Order is sequence counter in upper 3 bits.
+static void SetFastPacketFrame(const tN2kMsg &N2kMsg, int FrameNo, unsigned char Order, unsigned char *buf) {
+  int cur;
+  int j;
 
-  if (temp != CANSendFrameBufferRead) {
-    CANSendFrameBufferWrite = temp;
-    return &(CANSendFrameBuf[CANSendFrameBufferWrite]);
+  buf[0]=FrameNo|Order;
+  if ( FrameNo==0 ) {
+    buf[1]=N2kMsg.DataLen; //total bytes in fast packet
+    cur=0;
+    j=2;
   } else {
-    return 0;
+    cur=6+(FrameNo-1)*7;
+    j=1;
   }
+  for (; j<8 && cur<N2kMsg.DataLen; j++, cur++) buf[j]=N2kMsg.Data[cur];
+  for (; j<8; j++) buf[j]=0xff;
+}
+
+//*****************************************************************************
+// Replaces data of message with same CAN id, which waits in send buffer and
+// has not started sending. Fast packet keeps its place and sequence counter.
+// Returns false, if there is no such message.
+bool tNMEA2000::CoalesceQueuedMsg(unsigned long canId, const tN2kMsg &N2kMsg, bool FastPacket) {
+  if ( CANSendFrameBuf==0 ) return false;
+
+  uint8_t Priority=(canId>>26) & 0x7;
+  tSendQueue &Queue=SendQueues[Priority];
+  uint16_t Index=Queue.Head;
+  for (uint16_t i=0; i<Queue.Count; i++, Index=CANSendFrameBuf[Index].Next) {
+    tCANSendFrame &Frame=CANSendFrameBuf[Index];
+    if ( Frame.id!=canId ) continue;
+    if ( !FastPacket ) {
+      if ( Frame.wait_sent ) continue;
+      Frame.len=N2kMsg.DataLen;
+      for (int j=0; j<N2kMsg.DataLen; j++) Frame.buf[j]=N2kMsg.Data[j];
+    } else {
+      if ( !Frame.wait_sent || (Frame.buf[0] & 0x1f)!=0 ) continue; // Not first frame, so message has started sending
+      if ( Frame.buf[1]!=N2kMsg.DataLen ) return false;
+      // Frames of one fast packet are consecutive in queue.
+      int Frames=(N2kMsg.DataLen>6 ? (N2kMsg.DataLen-6-1)/7+1+1 : 1 );
+      unsigned char Order=Frame.buf[0] & 0xe0;
+      for (int iFrame=0; iFrame<Frames; iFrame++, Index=CANSendFrameBuf[Index].Next) {
+        SetFastPacketFrame(N2kMsg,iFrame,Order,CANSendFrameBuf[Index].buf);
+      }
+    }
+    SendStatistics[Priority].Coalesced++;
+    return true;
+  }
+
+  return false;
 }
 
+#if !defined(N2K_NO_SEND_RATE_LIMIT)
+//*****************************************************************************
+bool tNMEA2000::SetSendRateLimit(unsigned long PGN, uint16_t Interval, uint8_t Burst, tN2kRateLimiter::tPolicy Policy,
+                                 uint8_t MaxLimits, uint16_t MaxBuckets) {
+  if ( SendRateLimiter==0 ) {
+    if ( Interval==0 ) return true;
+    SendRateLimiter=new tN2kRateLimiter();
+    SendRateLimiter->Init(MaxLimits,MaxBuckets);
+  }
+  return SendRateLimiter->SetLimit(PGN,Interval,Burst,Policy);
+}
+#endif
+
+#if !defined(N2K_NO_SCHEDULED_SEND)
+//*****************************************************************************
+bool tNMEA2000::SendMsgAt(const tN2kMsg &N2kMsg, unsigned long SendTime, int DeviceIndex) {
+  if ( MsgScheduler==0 ) {
+    MsgScheduler=new tN2kMsgScheduler();
+    MsgScheduler->Init(MaxScheduledMsgs,millis());
+  }
+  return MsgScheduler->Add(N2kMsg,SendTime,DeviceIndex);
+}
+
+//*****************************************************************************
+// Message will wait, if there is no room for all its frames, so that due messages
+// keep their order and will not be dropped by full send buffer. TP message needs
+// room only for RTS or BAM frame, since its data frames are sent later.
+void tNMEA2000::SendScheduledMessages() {
+  if ( MsgScheduler==0 ) return;
+
+  unsigned long Now=millis();
+  const tN2kMsg *N2kMsg;
+  int DeviceIndex;
+  unsigned long SendTime;
+
+  MsgScheduler->Advance(Now);
+  while ( MsgScheduler->PeekDue(N2kMsg,DeviceIndex,SendTime) ) {
+    int frames=1;
+#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
+    if ( N2kMsg->IsTPMessage() ) {
+      frames=1;
+    } else
+#endif
+    if ( N2kMsg->DataLen>8 || IsFastPacket(*N2kMsg) ) frames=(N2kMsg->DataLen>6 ? (N2kMsg->DataLen-6-1)/7+1+1 : 1 );
+    if ( !HasSendFrameSpace(frames) ) break;
+    MsgScheduler->ReleaseDue(Now,SendMsg(*N2kMsg,DeviceIndex));
+  }
+}
+#endif
+
 //*****************************************************************************
 void tNMEA2000::SendPendingInformation() {
   for (int i=0; i<DeviceCount; i++ ) {
@@ -1017,7 +1423,23 @@ bool tNMEA2000::SendMsg(const tN2kMsg &N2kMsg, int DeviceIndex) {
       N2kMsgDbg("Can ID:"); N2kMsgDbgln(canId);
       if ( IsAddressClaimStarted(DeviceIndex) && N2kMsg.PGN!=N2kPGNIsoAddressClaim ) return false;
 
-      if (N2kMsg.DataLen<=8 && !IsFastPacket(N2kMsg) ) { // We can send single frame
+#if !defined(N2K_NO_SEND_RATE_LIMIT)
+      if ( SendRateLimiter!=0 ) {
+        uint8_t Limit;
+        switch ( SendRateLimiter->Check(N2kMsg.PGN,N2kMsg.Source,millis(),Limit) ) {
+          case tN2kRateLimiter::rlr_Pass: break;
+          case tN2kRateLimiter::rlr_Drop: return false;
+          case tN2kRateLimiter::rlr_Coalesce:
+            result=CoalesceQueuedMsg(canId,N2kMsg,N2kMsg.DataLen>8 || IsFastPacket(N2kMsg));
+            SendRateLimiter->CountCoalesced(Limit,result);
+            return result;
+        }
+      }
+#endif
+      if ( IsPGNInList(N2kMsg.PGN,CoalescedMessages) &&
+           CoalesceQueuedMsg(canId,N2kMsg,N2kMsg.DataLen>8 || IsFastPacket(N2kMsg)) ) {
+        result=true;
+      } else if (N2kMsg.DataLen<=8 && !IsFastPacket(N2kMsg) ) { // We can send single frame
           DbgPrintBuf(N2kMsg.DataLen, N2kMsg.Data,true);
           result=SendFrame(canId, N2kMsg.DataLen, N2kMsg.Data,false);
           if (!result && ForwardStream!=0 && ForwardType==tNMEA2000::fwdt_Text) { ForwardStream->print(F("PGN ")); ForwardStream->print(N2kMsg.PGN); ForwardStream->println(F(" send failed")); }
@@ -1030,31 +1452,16 @@ bool tNMEA2000::SendMsg(const tN2kMsg &N2kMsg, int DeviceIndex) {
 #endif
         {
           unsigned char temp[8]; // {0,0,0,0,0,0,0,0};
-          int cur=0;
           int frames=(N2kMsg.DataLen>6 ? (N2kMsg.DataLen-6-1)/7+1+1 : 1 );
+          if ( !HasSendFrameSpace(frames) ) { // Reject whole message, so there will be no truncated message on bus
+            if (ForwardStream!=0 && ForwardType==tNMEA2000::fwdt_Text) { ForwardStream->print(F("PGN ")); ForwardStream->print(N2kMsg.PGN); ForwardStream->println(F(" send failed, no room for frames")); }
+            return false;
+          }
           int Order=GetSequenceCounter(N2kMsg.PGN,DeviceIndex)<<5;
           result=true;
           for (int i = 0; i<frames && result; i++) {
-              temp[0] = i|Order; //frame counter
-              if (i==0) {
-                  temp[1] = N2kMsg.DataLen; //total bytes in fast packet
-                  //send the first 6 bytes
-                  for (int j = 2; j<8; j++) {
-                       temp[j]=N2kMsg.Data[cur];
-                       cur++;
-                   }
-                  N2kPrintFreeMemory("SendMsg, fastpacket");
-              } else {
-                   int j=1;
-                   //send the next 7 data bytes
-                   for (; j<8 && cur<N2kMsg.DataLen; j++) {
-                       temp[j]=N2kMsg.Data[cur];
-                       cur++;
-                   }
-                   for (; j<8; j++) {
-                       temp[j]=0xff;
-                   }
-              }
+              SetFastPacketFrame(N2kMsg,i,Order,temp);
+              if (i==0) N2kPrintFreeMemory("SendMsg, fastpacket");
               // delay(3);
               DbgPrintBuf(8,temp,true);
               result=SendFrame(canId, 8, temp, true);
@@ -1087,7 +1494,7 @@ void tNMEA2000::SetDebugMode(tDebugMode _dbMode) {
 }
 
 //*****************************************************************************
-bool tNMEA2000::IsFastPacketPGN(unsigned long PGN) {
+bool tNMEA2000::IsFastPacketPGNFromLists(unsigned long PGN) {
   if ( IsFastPacketSystemMessage(PGN) || IsMandatoryFastPacketMessage(PGN) || 
        ( FastPacketMessages[0]==0 && IsDefaultFastPacketMessage(PGN) ) ) return true;
   int i;
@@ -1112,7 +1519,7 @@ bool tNMEA2000::IsFastPacket(const tN2kMsg &N2kMsg) {
 }
 
 //*****************************************************************************
-bool tNMEA2000::CheckKnownMessage(unsigned long PGN, bool &SystemMessage, bool &FastPacket) {
+bool tNMEA2000::CheckKnownMessageFromLists(unsigned long PGN, bool &SystemMessage, bool &FastPacket) {
   int i;
 //    return true;
     FastPacket=false;
@@ -1149,6 +1556,100 @@ bool tNMEA2000::CheckKnownMessage(unsigned long PGN, bool &SystemMessage, bool &
     return false;
 }
 
+#if !defined(N2K_NO_PGN_CLASS_TABLE)
+//*****************************************************************************
+// Collects all PGNs from active lists, sorts them and saves classification
+// for each. Unlisted PGNs are unknown, so they need no entry.
+void tNMEA2000::UpdatePGNClassTable() {
+  if ( !IsInitialized() ) return; // Table will be built on Open
+
+  if ( PGNClassTable!=0 ) delete[] PGNClassTable;
+  PGNClassTable=0;
+  PGNClassCount=0;
+
+  const unsigned long *Lists[5+2*N2kMessageGroups];
+  int ListCount=0;
+  Lists[ListCount++]=SingleFrameSystemMessages;
+  Lists[ListCount++]=FastPacketSystemMessages;
+  Lists[ListCount++]=MandatoryFastPacketMessages;
+  if ( SingleFrameMessages[0]==0 ) Lists[ListCount++]=DefaultSingleFrameMessages;
+  if ( FastPacketMessages[0]==0 ) Lists[ListCount++]=DefaultFastPacketMessages;
+  for (unsigned char igroup=0; igroup<N2kMessageGroups; igroup++) {
+    if ( SingleFrameMessages[igroup]!=0 ) Lists[ListCount++]=SingleFrameMessages[igroup];
+    if ( FastPacketMessages[igroup]!=0 ) Lists[ListCount++]=FastPacketMessages[igroup];
+  }
+
+  int Count=0;
+  for (int iList=0; iList<ListCount; iList++) Count+=PGNListLength(Lists[iList]);
+  if ( Count==0 ) return;
+
+  PGNClassTable=new tPGNClass[Count];
+  for (int iList=0; iList<ListCount; iList++) {
+    unsigned long PGN;
+    for (int i=0; (PGN=pgm_read_dword(&Lists[iList][i]))!=0; i++) {
+      // Insertion sort, drop duplicates
+      int j=PGNClassCount;
+      for (; j>0 && PGNClassTable[j-1].PGN>PGN; j--);
+      if ( j>0 && PGNClassTable[j-1].PGN==PGN ) continue;
+      for (int k=PGNClassCount; k>j; k--) PGNClassTable[k]=PGNClassTable[k-1];
+      PGNClassTable[j].PGN=PGN;
+      PGNClassCount++;
+    }
+  }
+
+  for (uint16_t i=0; i<PGNClassCount; i++) {
+    bool SystemMessage;
+    bool FastPacket;
+    uint8_t Flags=0;
+    if ( CheckKnownMessageFromLists(PGNClassTable[i].PGN,SystemMessage,FastPacket) ) Flags|=pgnc_Known;
+    if ( SystemMessage ) Flags|=pgnc_System;
+    if ( FastPacket ) Flags|=pgnc_FastPacket;
+    if ( IsFastPacketPGNFromLists(PGNClassTable[i].PGN) ) Flags|=pgnc_FastPacketPGN;
+    PGNClassTable[i].Flags=Flags;
+  }
+}
+
+//*****************************************************************************
+uint8_t tNMEA2000::GetPGNClass(unsigned long PGN) {
+  uint16_t Low=0;
+  uint16_t High=PGNClassCount;
+
+  while ( Low<High ) {
+    uint16_t Mid=(Low+High)/2;
+    if ( PGNClassTable[Mid].PGN<PGN ) {
+      Low=Mid+1;
+    } else {
+      High=Mid;
+    }
+  }
+
+  return ( Low<PGNClassCount && PGNClassTable[Low].PGN==PGN ? PGNClassTable[Low].Flags : 0 );
+}
+#else
+void tNMEA2000::UpdatePGNClassTable() {}
+#endif
+
+//*****************************************************************************
+bool tNMEA2000::IsFastPacketPGN(unsigned long PGN) {
+#if !defined(N2K_NO_PGN_CLASS_TABLE)
+  if ( PGNClassTable!=0 ) return (GetPGNClass(PGN) & pgnc_FastPacketPGN)!=0;
+#endif
+  return IsFastPacketPGNFromLists(PGN);
+}
+
+//*****************************************************************************
+bool tNMEA2000::CheckKnownMessage(unsigned long PGN, bool &SystemMessage, bool &FastPacket) {
+#if !defined(N2K_NO_PGN_CLASS_TABLE)
+  if ( PGNClassTable!=0 ) {
+    uint8_t Flags=GetPGNClass(PGN);
+    SystemMessage=(Flags & pgnc_System)!=0;
+    FastPacket=(Flags & pgnc_FastPacket)!=0;
+    return (Flags & pgnc_Known)!=0;
+  }
+#endif
+  return CheckKnownMessageFromLists(PGN,SystemMessage,FastPacket);
+}
+
 //*****************************************************************************
 void CopyBufToCANMsg(tN2kCANMsg &CANMsg, unsigned char start, unsigned char len, unsigned char *buf) {
         for (int j=start; (j<len) & (CANMsg.CopiedLen<CANMsg.N2kMsg.MaxDataLen); j++, CANMsg.CopiedLen++) {
@@ -1162,70 +1663,149 @@ void tNMEA2000::FindFreeCANMsgIndex(unsigned long PGN, unsigned char Source, uns
 #else
 void tNMEA2000::FindFreeCANMsgIndex(unsigned long PGN, unsigned char Source, unsigned char Destination, uint8_t &MsgIndex) {
 #endif
-  unsigned long OldestMsgTime,CurTime;
-  int OldestIndex;
+#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
+  uint32_t Key=( TPMsg ? tN2kCANMsgIndex::TPKey(Source,Destination) : tN2kCANMsgIndex::FastPacketKey(PGN,Source) );
+#else
+  uint32_t Key=tN2kCANMsgIndex::FastPacketKey(PGN,Source);
+#endif
+
+  MsgIndex=N2kCANMsgIndex.Find(Key); // Restart message under reception
+  if ( MsgIndex<MaxN2kCANMsgs ) {
+#if !defined(N2K_NO_RX_STATISTICS)
+    CountRxEvent(rxe_Restart,N2kCANMsgBuf[MsgIndex].N2kMsg.PGN,Source);
+#endif
+    return;
+  }
+
+  MsgIndex=N2kCANMsgIndex.GetFree();
+  if ( MsgIndex<MaxN2kCANMsgs ) return;
+
+  MsgIndex=N2kCANMsgIndex.GetOldest();
+  if ( MsgIndex<MaxN2kCANMsgs && N2kCANMsgBuf[MsgIndex].N2kMsg.MsgTime+Max_N2kMsgBuf_Time<millis() ) {
+#if !defined(N2K_NO_RX_STATISTICS)
+    CountRxEvent(rxe_Eviction,N2kCANMsgBuf[MsgIndex].N2kMsg.PGN,N2kCANMsgBuf[MsgIndex].N2kMsg.Source);
+#endif
+    FreeCANMsg(MsgIndex); // Use the old one, which has timed out
+  } else {
+    MsgIndex=MaxN2kCANMsgs;
+#if !defined(N2K_NO_RX_STATISTICS)
+    CountRxEvent(rxe_NoFreeSlot,PGN,Source);
+#endif
+  }
+}
 
-  for (MsgIndex=0, CurTime=OldestMsgTime=millis(), OldestIndex=MaxN2kCANMsgs;
-       MsgIndex<MaxN2kCANMsgs &&
-       !( N2kCANMsgBuf[MsgIndex].FreeMsg ||
-         ( N2kCANMsgBuf[MsgIndex].N2kMsg.PGN==PGN 
-           && N2kCANMsgBuf[MsgIndex].N2kMsg.Source==Source
-           && N2kCANMsgBuf[MsgIndex].N2kMsg.Destination==Destination
+//*****************************************************************************
+// Marks slot initialized for PGN, source and destination used and indexes it.
+void tNMEA2000::UseCANMsg(uint8_t MsgIndex) {
+  const tN2kMsg &N2kMsg=N2kCANMsgBuf[MsgIndex].N2kMsg;
+  N2kCANMsgBuf[MsgIndex].FreeMsg=false;
 #if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
-           && N2kCANMsgBuf[MsgIndex].N2kMsg.IsTPMessage()==TPMsg
-#endif
-         )
-        );
-       MsgIndex++) { // Find free message place
-    if (N2kCANMsgBuf[MsgIndex].N2kMsg.MsgTime<OldestMsgTime) {
-      OldestIndex=MsgIndex;
-      OldestMsgTime=N2kCANMsgBuf[MsgIndex].N2kMsg.MsgTime;
-    }
+  if ( N2kMsg.IsTPMessage() ) {
+    N2kCANMsgIndex.Use(MsgIndex,tN2kCANMsgIndex::TPKey(N2kMsg.Source,N2kMsg.Destination));
+  } else
+#endif
+  {
+    N2kCANMsgIndex.Use(MsgIndex,tN2kCANMsgIndex::FastPacketKey(N2kMsg.PGN,N2kMsg.Source));
   }
-  if ( MsgIndex==MaxN2kCANMsgs && OldestMsgTime+Max_N2kMsgBuf_Time<CurTime) {
-    MsgIndex=OldestIndex; // Use the old one, which has timed out
-    N2kCANMsgBuf[MsgIndex].FreeMessage();
+#if !defined(N2K_NO_RX_STATISTICS)
+  UpdateRxSlotsInUse();
+#endif
+}
+
+//*****************************************************************************
+void tNMEA2000::FreeCANMsg(uint8_t MsgIndex) {
+  N2kCANMsgIndex.Release(MsgIndex);
+  N2kCANMsgBuf[MsgIndex].FreeMessage();
+#if !defined(N2K_NO_RX_STATISTICS)
+  UpdateRxSlotsInUse();
+#endif
+}
+
+#if !defined(N2K_NO_RX_STATISTICS)
+//*****************************************************************************
+void tNMEA2000::UpdateRxSlotsInUse() {
+  RxStatistics.SlotsInUse=N2kCANMsgIndex.GetBusyCount();
+  if ( RxStatistics.SlotsInUse>RxStatistics.MaxSlotsInUse ) RxStatistics.MaxSlotsInUse=RxStatistics.SlotsInUse;
+}
+
+//*****************************************************************************
+// Events are rare compared to frames, so linear search of PGN table is fine.
+void tNMEA2000::CountRxEvent(tRxEvent Event, unsigned long PGN, unsigned char Source) {
+  RxStatistics.Events[Event]++;
+
+  if ( RxSourceEvents!=0 && RxSourceEvents[Source][Event]<0xffff ) RxSourceEvents[Source][Event]++;
+
+  if ( RxPGNStatistics==0 ) return;
+  uint8_t i=0;
+  for ( ; i<RxPGNStatisticsCount && RxPGNStatistics[i].PGN!=PGN; i++ );
+  if ( i==RxPGNStatisticsCount ) {
+    if ( RxPGNStatisticsCount>=MaxRxPGNStatistics ) { RxStatistics.UntrackedPGNEvents++; return; }
+    RxPGNStatistics[i].PGN=PGN;
+    memset(RxPGNStatistics[i].Events,0,sizeof(RxPGNStatistics[i].Events));
+    RxPGNStatisticsCount++;
   }
+  if ( RxPGNStatistics[i].Events[Event]<0xffff ) RxPGNStatistics[i].Events[Event]++;
+}
+
+//*****************************************************************************
+void tNMEA2000::SetRxStatisticsSize(uint8_t MaxPGNs, bool BySource) {
+  if ( RxPGNStatistics!=0 ) delete[] RxPGNStatistics;
+  RxPGNStatistics=( MaxPGNs>0 ? new tRxPGNStatistics[MaxPGNs] : 0 );
+  MaxRxPGNStatistics=MaxPGNs;
+
+  if ( RxSourceEvents!=0 ) delete[] RxSourceEvents;
+  RxSourceEvents=( BySource ? new uint16_t[256][rxe_Count] : 0 );
 
+  ResetRxStatistics();
 }
 
+//*****************************************************************************
+void tNMEA2000::ResetRxStatistics() {
+  memset(RxStatistics.Events,0,sizeof(RxStatistics.Events));
+  RxStatistics.UntrackedPGNEvents=0;
+  RxStatistics.MaxSlotsInUse=RxStatistics.SlotsInUse;
+  RxPGNStatisticsCount=0;
+  if ( RxSourceEvents!=0 ) memset(RxSourceEvents,0,256*sizeof(RxSourceEvents[0]));
+}
+#endif
+
 #if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
 
 //*****************************************************************************
-bool tNMEA2000::SendTPCM_BAM(int iDev) {
+bool tNMEA2000::SendTPCM_BAM(const tTPSession &Session) {
   if ( !IsActiveNode() ) return false;
 
   tN2kMsg N2kMsg;
   
-  N2kMsg.Source=Devices[iDev].N2kSource;
+  N2kMsg.Source=Devices[Session.Device].N2kSource;
   N2kMsg.Destination=0xff;
   N2kMsg.SetPGN(TP_CM);
   N2kMsg.Priority=6;
   N2kMsg.AddByte(TP_CM_BAM);
-  int nBytes=Devices[iDev].PendingTPMsg.DataLen;
+  int nBytes=Session.Msg.DataLen;
   N2kMsg.Add2ByteUInt(nBytes);
   N2kMsg.AddByte(nBytes/7+(nBytes%7!=0?1:0));
   N2kMsg.AddByte(0xff); // Reserved;
-  N2kMsg.Add3ByteInt(Devices[iDev].PendingTPMsg.PGN);
-  return SendMsg(N2kMsg,iDev);
+  N2kMsg.Add3ByteInt(Session.Msg.PGN);
+  return SendMsg(N2kMsg,Session.Device);
 }
 
 //*****************************************************************************
-bool tNMEA2000::SendTPCM_RTS(int iDev) {
+bool tNMEA2000::SendTPCM_RTS(const tTPSession &Session) {
   if ( !IsActiveNode() ) return false;
 
   tN2kMsg N2kMsg;
-  N2kMsg.Source=Devices[iDev].N2kSource;
-  N2kMsg.Destination=Devices[iDev].PendingTPMsg.Destination;
+  N2kMsg.Source=Devices[Session.Device].N2kSource;
+  N2kMsg.Destination=Session.Msg.Destination;
   N2kMsg.SetPGN(TP_CM);
   N2kMsg.Priority=6;
   N2kMsg.AddByte(TP_CM_RTS);
-  int nBytes=Devices[iDev].PendingTPMsg.DataLen;
+  int nBytes=Session.Msg.DataLen;
   N2kMsg.Add2ByteUInt(nBytes);
   N2kMsg.AddByte(nBytes/7+(nBytes%7!=0?1:0));
   N2kMsg.AddByte(0xff); // Reserved;
-  N2kMsg.Add3ByteInt(Devices[iDev].PendingTPMsg.PGN);
-  return SendMsg(N2kMsg,iDev);
+  N2kMsg.Add3ByteInt(Session.Msg.PGN);
+  return SendMsg(N2kMsg,Session.Device);
 }
 
 unsigned char TPCtsPackets(unsigned char nPackets) { return tNMEA2000::N2kMax<unsigned char>(1,tNMEA2000::N2kMin<unsigned char>(nPackets,TP_MAX_FRAMES)); }
@@ -1286,27 +1866,22 @@ void tNMEA2000::SendTPCM_Abort(unsigned long PGN, unsigned char Destination, int
 //*****************************************************************************
 // Caller should take care of not calling this after all has been done. 
 // Use HasAllTPDTSent for checking.
-bool tNMEA2000::SendTPDT(int iDev) {
+bool tNMEA2000::SendTPDT(tTPSession &Session) {
   tN2kMsg N2kMsg;
-  N2kMsg.Source=Devices[iDev].N2kSource;
-  N2kMsg.Destination=Devices[iDev].PendingTPMsg.Destination;
+  N2kMsg.Source=Devices[Session.Device].N2kSource;
+  N2kMsg.Destination=Session.Msg.Destination;
   N2kMsg.SetPGN(TP_DT);
   N2kMsg.Priority=6;
-  N2kMsg.AddByte(Devices[iDev].NextDTSequence+1);
-  int iByteToSend=Devices[iDev].NextDTSequence*7;
+  N2kMsg.AddByte(Session.NextDTSequence+1);
+  int iByteToSend=Session.NextDTSequence*7;
   for ( int i=0; i<7; i++,iByteToSend++ ) {
-    if ( iByteToSend<Devices[iDev].PendingTPMsg.DataLen ) {
-      N2kMsg.AddByte(Devices[iDev].PendingTPMsg.Data[iByteToSend]);
+    if ( iByteToSend<Session.Msg.DataLen ) {
+      N2kMsg.AddByte(Session.Msg.Data[iByteToSend]);
     } else N2kMsg.AddByte(0xff);
   }
-  Devices[iDev].NextDTSequence++;
+  Session.NextDTSequence++;
 
-  return SendMsg(N2kMsg,iDev);
-}
-
-//*****************************************************************************
-bool tNMEA2000::HasAllTPDTSent(int iDev) {
-  return ( Devices[iDev].NextDTSequence*7>=Devices[iDev].PendingTPMsg.DataLen );
+  return SendMsg(N2kMsg,Session.Device);
 }
 
 //*****************************************************************************
@@ -1343,12 +1918,12 @@ bool tNMEA2000::TestHandleTPMessage(unsigned long PGN, unsigned char Source, uns
           N2kCANMsgBuf[MsgIndex].KnownMessage=CheckKnownMessage(TransportPGN,N2kCANMsgBuf[MsgIndex].SystemMessage,FastPacket);
           if ( nBytes < tN2kMsg::MaxDataLen &&  // Currently we can handle only tN2kMsg::MaxDataLen long messages
                (N2kCANMsgBuf[MsgIndex].KnownMessage || !HandleOnlyKnownMessages()) ) {
-            N2kCANMsgBuf[MsgIndex].FreeMsg=false;
             N2kCANMsgBuf[MsgIndex].N2kMsg.Init(7 /* Priority? */,TransportPGN,Source,Destination);
             N2kCANMsgBuf[MsgIndex].CopiedLen=0;
             N2kCANMsgBuf[MsgIndex].LastFrame=0;
             N2kCANMsgBuf[MsgIndex].N2kMsg.DataLen=nBytes;
             N2kCANMsgBuf[MsgIndex].N2kMsg.SetIsTPMessage();
+            UseCANMsg(MsgIndex);
             N2kCANMsgBuf[MsgIndex].TPMaxPackets=TPMaxPackets;
             if ( (TP_CM_Control==TP_CM_RTS) && (iDev>=0) ) { // If it was for us and not broadcast, we need to response
               SendTPCM_CTS(TransportPGN,Source,iDev,N2kCANMsgBuf[MsgIndex].TPMaxPackets,N2kCANMsgBuf[MsgIndex].LastFrame+1);
@@ -1364,39 +1939,41 @@ bool tNMEA2000::TestHandleTPMessage(unsigned long PGN, unsigned char Source, uns
         }
         break;
       }
-      case TP_CM_CTS:
-        if ( !IsValidDevice(iDev) ) break; // Should never fail
+      case TP_CM_CTS: {
+        tTPSession *Session=FindTPSession(iDev,Source);
+        if ( Session==0 ) break; // Not for us or no session with sender
         N2kMsgDbgln("Got TP CTS");
-        if ( IsBroadcast(Devices[iDev].PendingTPMsg.Destination) ) break; // We should not get controls for broadcast TP msg
-        if ( Devices[iDev].PendingTPMsg.PGN!=TransportPGN ) { // Some failure on communication
-          EndSendTPMessage(iDev); // Should we retry from beginning?
+        if ( Session->Msg.PGN!=TransportPGN ) { // Some failure on communication
+          TPStatistics.Aborted++;
+          EndSendTPMessage(*Session); // Should we retry from beginning?
           break;
         }
-        // Now respond with next data packets
         if ( buf[1]>0 ) { // Note that with 0, receiver wants to have break
-          if ( buf[2]-1!=Devices[iDev].NextDTSequence ) { // We got sequence error
-            EndSendTPMessage(iDev); // Should we retry from beginning?
+          if ( buf[2]==0 || (buf[2]-1)*7>=Session->Msg.DataLen ) { // Receiver asks packet we do not have
+            SendTPCM_Abort(TransportPGN,Source,iDev,TP_CM_AbortTimeout);
+            TPStatistics.Aborted++;
+            EndSendTPMessage(*Session);
             break;
           }
-          uint8_t MaxTPSequences=buf[1];
-          bool TPDTResult=true;
-          for ( uint8_t iSeq=0; TPDTResult &&iSeq<MaxTPSequences && !HasAllTPDTSent(iDev); iSeq++ ) TPDTResult&=SendTPDT(iDev);
-          if ( !TPDTResult ) EndSendTPMessage(iDev);
+          Session->NextDTSequence=buf[2]-1; // Receiver may also ask retransmit
+          Session->PacketsToSend=buf[1];
+          Session->State=tps_SendDT;
+          SendTPSessionData(*Session);
+        } else {
+          Session->State=tps_WaitResponse;
+          Session->NextTime=millis()+TP_T4;
         }
-        Devices[iDev].NextDTSendTime=millis()+100; // Set timeout for next response
         break;
+      }
       case TP_CM_ACK:
-        if ( !IsValidDevice(iDev) ) break; // Should never fail
-        N2kMsgDbgln("Got TP ACK");
-        if ( IsBroadcast(Devices[iDev].PendingTPMsg.Destination) ) break; // We should not get controls for broadcast TP msg
-        EndSendTPMessage(iDev);
-        break;
-      case TP_CM_Abort:
-        if ( !IsValidDevice(iDev) ) break; // Should never fail
-        N2kMsgDbgln("Got TP Abort");
-        if ( IsBroadcast(Devices[iDev].PendingTPMsg.Destination) ) break; // We should not get controls for broadcast TP msg
-        EndSendTPMessage(iDev);
+      case TP_CM_Abort: {
+        tTPSession *Session=FindTPSession(iDev,Source);
+        if ( Session==0 || Session->Msg.PGN!=TransportPGN ) break;
+        N2kMsgDbgln("Got TP ACK or Abort");
+        if ( TP_CM_Control==TP_CM_ACK ) { TPStatistics.Completed++; } else { TPStatistics.Aborted++; }
+        EndSendTPMessage(*Session);
         break;
+      }
       default:
         ;
     }
@@ -1405,14 +1982,7 @@ bool tNMEA2000::TestHandleTPMessage(unsigned long PGN, unsigned char Source, uns
   } else if ( PGN==TP_DT ) { // Datapacket
     N2kMsgDbgln("Got TP data");
     // So we need to find TP msg which sender and destination matches.
-    for (MsgIndex=0;
-         MsgIndex<MaxN2kCANMsgs && 
-         !( !N2kCANMsgBuf[MsgIndex].FreeMsg 
-            && N2kCANMsgBuf[MsgIndex].N2kMsg.IsTPMessage()
-            && N2kCANMsgBuf[MsgIndex].N2kMsg.Destination==Destination 
-            && N2kCANMsgBuf[MsgIndex].N2kMsg.Source==Source
-          );
-         MsgIndex++);
+    MsgIndex=N2kCANMsgIndex.Find(tN2kCANMsgIndex::TPKey(Source,Destination));
     // if (MsgIndex==MaxN2kCANMsgs) N2kMsgDbgln("TP data msg not found");
     // for (int i=1; i<len; i++) N2kMsgDbgln(buf[i]);
     if (MsgIndex<MaxN2kCANMsgs) { // found TP message under reception
@@ -1423,6 +1993,7 @@ bool tNMEA2000::TestHandleTPMessage(unsigned long PGN, unsigned char Source, uns
         N2kCANMsgBuf[MsgIndex].LastFrame=buf[0];
         // Transport protocol is slower, so to avoid timeout, we reset message time
         N2kCANMsgBuf[MsgIndex].N2kMsg.MsgTime=millis();
+        N2kCANMsgIndex.Touch(MsgIndex);
         if ( N2kCANMsgBuf[MsgIndex].CopiedLen>=N2kCANMsgBuf[MsgIndex].N2kMsg.DataLen ) { // all done
           N2kCANMsgBuf[MsgIndex].Ready=true;
           if ( N2kCANMsgBuf[MsgIndex].TPRequireCTS>0 && iDev>=0 ) { // send response
@@ -1435,14 +2006,22 @@ bool tNMEA2000::TestHandleTPMessage(unsigned long PGN, unsigned char Source, uns
         }
       } else { // Wrong packet - either we lost packet or sender sends wrong, so free this
         N2kMsgDbg("Invalid packet: "); N2kMsgDbgln(buf[0]);
+#if !defined(N2K_NO_RX_STATISTICS)
+        CountRxEvent(rxe_LostFrame,N2kCANMsgBuf[MsgIndex].N2kMsg.PGN,Source);
+#endif
         if ( N2kCANMsgBuf[MsgIndex].TPRequireCTS>0 && iDev>=0 ) { // We need to abort transport
           SendTPCM_Abort(N2kCANMsgBuf[MsgIndex].N2kMsg.PGN,Source,iDev,TP_CM_AbortTimeout);  // Abort transport
         }
-        N2kCANMsgBuf[MsgIndex].FreeMessage();
+        FreeCANMsg(MsgIndex);
 
       }
       if ( !N2kCANMsgBuf[MsgIndex].Ready ) MsgIndex=MaxN2kCANMsgs;
     }
+#if !defined(N2K_NO_RX_STATISTICS)
+    else {
+      CountRxEvent(rxe_OrphanFrame,TP_DT,Source); // Data frame does not tell PGN
+    }
+#endif
     return true; // We handled message
   }
 
@@ -1450,44 +2029,160 @@ bool tNMEA2000::TestHandleTPMessage(unsigned long PGN, unsigned char Source, uns
 }
 
 //*****************************************************************************
+void tNMEA2000::ResetTPStatistics() {
+  TPStatistics.Started=0;
+  TPStatistics.Completed=0;
+  TPStatistics.Aborted=0;
+  TPStatistics.TimedOut=0;
+  TPStatistics.Rejected=0;
+  TPStatistics.MaxSessions=0;
+}
+
+//*****************************************************************************
+// Returns running session of device to destination. BAM session has destination 0xff.
+tNMEA2000::tTPSession *tNMEA2000::FindTPSession(int iDev, unsigned char Destination) {
+  if ( !IsValidDevice(iDev) || TPSessions==0 ) return 0;
+
+  for (uint8_t i=0; i<MaxTPSessions; i++) {
+    if ( TPSessions[i].State!=tps_Free && TPSessions[i].State!=tps_Waiting &&
+         TPSessions[i].Device==iDev && TPSessions[i].Msg.Destination==Destination ) return &TPSessions[i];
+  }
+  return 0;
+}
+
+//*****************************************************************************
+// Receivers can not separate two sessions from same source to same destination,
+// so message waits, if there is already session running.
 bool tNMEA2000::StartSendTPMessage(const tN2kMsg& msg, int iDev) {
-  if ( !IsValidDevice(iDev) ) return false;
-  
-  if ( Devices[iDev].PendingTPMsg.PGN!=0 ) return false; // No room for sending TP message
+  if ( !IsValidDevice(iDev) || TPSessions==0 ) return false;
+
+  tTPSession *Session=0;
+  uint8_t InUse=1;
+  for (uint8_t i=0; i<MaxTPSessions; i++) {
+    if ( TPSessions[i].State!=tps_Free ) {
+      InUse++;
+    } else if ( Session==0 ) {
+      Session=&TPSessions[i];
+    }
+  }
+  if ( Session==0 ) { // No room for sending TP message
+    TPStatistics.Rejected++;
+    return false;
+  }
+  if ( InUse>TPStatistics.MaxSessions ) TPStatistics.MaxSessions=InUse;
 
-  int result=false;
+  unsigned char Destination=( IsBroadcast(msg.Destination) ? 0xff : msg.Destination );
+  bool Busy=( FindTPSession(iDev,Destination)!=0 );
+  Session->Msg=msg;
+  Session->Msg.Destination=Destination;
+  Session->Device=iDev;
+  Session->Order=TPSessionOrder++;
+  Session->State=tps_Waiting;
+  if ( Busy ) return true;
 
-  Devices[iDev].PendingTPMsg=msg;
-  Devices[iDev].NextDTSequence=0;
-  Devices[iDev].NextDTSendTime=millis()+50;
-  if ( IsBroadcast(msg.Destination) ) { // Start with BAM
-    result=SendTPCM_BAM(iDev);
+  return StartTPSession(*Session);
+}
+
+//*****************************************************************************
+bool tNMEA2000::StartTPSession(tTPSession &Session) {
+  bool result;
+
+  Session.NextDTSequence=0;
+  Session.PacketsToSend=0;
+  if ( IsBroadcast(Session.Msg.Destination) ) { // Start with BAM
+    Session.State=tps_BAM;
+    Session.NextTime=millis()+TP_BAM_MinInterval;
+    result=SendTPCM_BAM(Session);
   } else {
-    result=SendTPCM_RTS(iDev);
+    Session.State=tps_WaitResponse;
+    Session.NextTime=millis()+TP_T3;
+    result=SendTPCM_RTS(Session);
   }
-  
-  if ( !result ) EndSendTPMessage(iDev); // Currently no retry
-  
+
+  if ( result ) {
+    TPStatistics.Started++;
+  } else {
+    TPStatistics.Aborted++;
+    EndSendTPMessage(Session); // Currently no retry
+  }
+
   return result;
 }
 
 //*****************************************************************************
-void tNMEA2000::EndSendTPMessage(int iDev) {
-  Devices[iDev].PendingTPMsg.Clear();
-  Devices[iDev].NextDTSendTime=0;
+// Frees session and starts oldest session waiting for same destination.
+void tNMEA2000::EndSendTPMessage(tTPSession &Session) {
+  unsigned char Destination=Session.Msg.Destination;
+  Session.State=tps_Free;
+  Session.Msg.Clear();
+
+  tTPSession *Next=0;
+  for (uint8_t i=0; i<MaxTPSessions; i++) {
+    tTPSession &Waiting=TPSessions[i];
+    if ( Waiting.State==tps_Waiting && Waiting.Device==Session.Device && Waiting.Msg.Destination==Destination &&
+         ( Next==0 || (int16_t)(Waiting.Order-Next->Order)<0 ) ) Next=&Waiting;
+  }
+  if ( Next!=0 ) StartTPSession(*Next);
+}
+
+//*****************************************************************************
+// Sends packets allowed by CTS. Packets, which do not fit to send buffer, will
+// be sent on next calls, so long message does not need buffer for all packets.
+void tNMEA2000::SendTPSessionData(tTPSession &Session) {
+  while ( Session.PacketsToSend>0 && !HasAllTPDTSent(Session) ) {
+    if ( !HasSendFrameSpace(1) ) return;
+    if ( !SendTPDT(Session) ) {
+      SendTPCM_Abort(Session.Msg.PGN,Session.Msg.Destination,Session.Device,TP_CM_AbortNoResources);
+      TPStatistics.Aborted++;
+      EndSendTPMessage(Session);
+      return;
+    }
+    Session.PacketsToSend--;
+  }
+  Session.State=tps_WaitResponse;
+  Session.NextTime=millis()+TP_T3;
+}
+
+//*****************************************************************************
+// BAM data packets must be 50-200 ms apart. Use minimum on free bus and slow
+// down, when send buffer fills, so BAM does not starve other messages.
+unsigned long tNMEA2000::TPBAMInterval() {
+  if ( CANSendFrameBuf==0 || MaxCANSendFrames==0 ) return TP_BAM_MinInterval;
+  uint16_t Used=MaxCANSendFrames-GetCANSendFrameBufFree();
+  return TP_BAM_MinInterval+(unsigned long)(TP_BAM_MaxInterval-TP_BAM_MinInterval)*Used/MaxCANSendFrames;
 }
 
 //*****************************************************************************
 void tNMEA2000::SendPendingTPMessages() {
-  for (int iDev=0; iDev<DeviceCount; iDev++ ) {
-    if ( Devices[iDev].PendingTPMsg.PGN!=0 && Devices[iDev].NextDTSendTime<millis() ) { // Pending message and timed out
-      if ( IsBroadcast(Devices[iDev].PendingTPMsg.Destination) ) { // For broadcast we just send next data
-        SendTPDT(iDev);
-        Devices[iDev].NextDTSendTime=millis()+50;
-        if ( HasAllTPDTSent(iDev) ) EndSendTPMessage(iDev); // All done
-      } else { // We have not got response from receiver within timeout, so just end. Or should we retry?
-        EndSendTPMessage(iDev);
-      }
+  if ( TPSessions==0 ) return;
+
+  for (uint8_t i=0; i<MaxTPSessions; i++ ) {
+    tTPSession &Session=TPSessions[i];
+    switch ( Session.State ) {
+      case tps_BAM:
+        if ( (long)(millis()-Session.NextTime)<0 || !HasSendFrameSpace(1) ) break;
+        if ( !SendTPDT(Session) ) {
+          TPStatistics.Aborted++;
+          EndSendTPMessage(Session);
+        } else if ( HasAllTPDTSent(Session) ) { // All done
+          TPStatistics.Completed++;
+          EndSendTPMessage(Session);
+        } else {
+          Session.NextTime=millis()+TPBAMInterval();
+        }
+        break;
+      case tps_SendDT:
+        SendTPSessionData(Session);
+        break;
+      case tps_WaitResponse:
+        if ( (long)(millis()-Session.NextTime)<0 ) break;
+        // We have not got response from receiver within timeout, so just end. Or should we retry?
+        SendTPCM_Abort(Session.Msg.PGN,Session.Msg.Destination,Session.Device,TP_CM_AbortTimeout);
+        TPStatistics.TimedOut++;
+        EndSendTPMessage(Session);
+        break;
+      default:
+        ;
     }
   }
 }
@@ -1521,15 +2216,7 @@ uint8_t tNMEA2000::SetN2kCANBufMsg(unsigned long canId, unsigned char len, unsig
         if (FastPacket && !IsFastPacketFirstFrame(buf[0]) ) { // Not first frame
         N2kFrameInDbg("New frame="); N2kFrameInDbg(PGN); N2kFrameInDbg(" frame="); N2kFrameInDbg(buf[0],HEX); N2kFrameInDbgln();
           // Find previous slot for this PGN
-          for (MsgIndex=0;
-               MsgIndex<MaxN2kCANMsgs &&
-               !( N2kCANMsgBuf[MsgIndex].N2kMsg.PGN==PGN 
-                  && N2kCANMsgBuf[MsgIndex].N2kMsg.Source==Source
-#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
-                  && !N2kCANMsgBuf[MsgIndex].N2kMsg.IsTPMessage()
-#endif            
-                );
-               MsgIndex++);
+          MsgIndex=N2kCANMsgIndex.Find(tN2kCANMsgIndex::FastPacketKey(PGN,Source));
           if (MsgIndex<MaxN2kCANMsgs) { // we found start for this message, so add data to it.
             N2kMsgDbg("Use msg slot: "); N2kMsgDbgln(MsgIndex);
             if (N2kCANMsgBuf[MsgIndex].LastFrame+1 == buf[0]) { // Right frame is coming
@@ -1538,12 +2225,18 @@ uint8_t tNMEA2000::SetN2kCANBufMsg(unsigned long canId, unsigned char len, unsig
             } else { // We have lost frame, so free this
               N2kFrameInDbg(millis()); N2kFrameInDbg(", Lost frame ");  N2kFrameInDbg(N2kCANMsgBuf[MsgIndex].LastFrame); N2kFrameInDbg("/");  N2kFrameInDbg(buf[0]); 
               N2kFrameInDbg(", source ");  N2kFrameInDbg(Source); N2kFrameInDbg(" for: "); N2kFrameInDbgln(PGN);
-              N2kCANMsgBuf[MsgIndex].FreeMessage();
+#if !defined(N2K_NO_RX_STATISTICS)
+              CountRxEvent(rxe_LostFrame,PGN,Source);
+#endif
+              FreeCANMsg(MsgIndex);
               MsgIndex=MaxN2kCANMsgs;
             }
           } else {  // Orphan frame
               N2kFrameInDbg(millis()); N2kFrameInDbg(", Orphan frame "); N2kFrameInDbg(buf[0]); N2kFrameInDbg(", source ");  
               N2kFrameInDbg(Source); N2kFrameInDbg(" for: "); N2kFrameInDbgln(PGN);
+#if !defined(N2K_NO_RX_STATISTICS)
+              CountRxEvent(rxe_OrphanFrame,PGN,Source);
+#endif
           }
         } else { // Handle first frame
 #if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
@@ -1553,13 +2246,13 @@ uint8_t tNMEA2000::SetN2kCANBufMsg(unsigned long canId, unsigned char len, unsig
 #endif        
           if ( MsgIndex<MaxN2kCANMsgs ) { // we found free place, so handle frame
             N2kMsgDbg("Use msg slot: "); N2kMsgDbgln(MsgIndex);
-            N2kCANMsgBuf[MsgIndex].FreeMsg=false;
             N2kCANMsgBuf[MsgIndex].KnownMessage=KnownMessage;
             N2kCANMsgBuf[MsgIndex].SystemMessage=SystemMessage;
             N2kCANMsgBuf[MsgIndex].N2kMsg.Init(Priority,PGN,Source,Destination);
 #if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
             N2kCANMsgBuf[MsgIndex].N2kMsg.SetIsTPMessage(false);
 #endif            
+            UseCANMsg(MsgIndex);
             N2kCANMsgBuf[MsgIndex].CopiedLen=0;
             if (FastPacket) {
               CopyBufToCANMsg(N2kCANMsgBuf[MsgIndex],2,len,buf);
@@ -1590,12 +2283,29 @@ uint8_t tNMEA2000::SetN2kCANBufMsg(unsigned long canId, unsigned char len, unsig
    int i=DeviceCount;
 
      if ( Source<=253 ) {
+       if ( SourceDevices!=0 ) return ( SourceDevices[Source]!=0xff ? SourceDevices[Source] : -1 );
        for (i=0; i<DeviceCount && Devices[i].N2kSource!=Source; i++);
      }
 
      return (i<DeviceCount?i:-1);
  }
 
+//*****************************************************************************
+// Keeps source map up to date. If other device still has old source, map moves to it.
+void tNMEA2000::SetDeviceSource(int iDev, unsigned char Source) {
+  unsigned char OldSource=Devices[iDev].N2kSource;
+
+  Devices[iDev].N2kSource=Source;
+  if ( SourceDevices==0 ) return;
+  if ( OldSource<=253 && SourceDevices[OldSource]==iDev ) {
+    SourceDevices[OldSource]=0xff;
+    for (int i=0; i<DeviceCount; i++) {
+      if ( Devices[i].N2kSource==OldSource ) { SourceDevices[OldSource]=i; break; }
+    }
+  }
+  if ( Source<=253 && SourceDevices[Source]==0xff ) SourceDevices[Source]=iDev;
+}
+
 //*****************************************************************************
 bool tNMEA2000::IsMySource(unsigned char Source) {
     return (FindSourceDeviceIndex(Source)!=-1);
@@ -1958,7 +2668,7 @@ void tNMEA2000::HandleCommandedAddress(uint64_t CommandedName, unsigned char New
   if ( IsBroadcast(NewAddress) ) return;
   if (Devices[iDev].DeviceInformation.GetName() == CommandedName &&
       Devices[iDev].N2kSource!=NewAddress) { // We have been commanded to set our address
-    Devices[iDev].N2kSource=NewAddress;
+    SetDeviceSource(iDev,NewAddress);
     Devices[iDev].UpdateAddressClaimEndSource();
     StartAddressClaim(iDev);
     AddressChanged=true;
@@ -1989,7 +2699,7 @@ void tNMEA2000::HandleCommandedAddress(const tN2kMsg &N2kMsg) {
 void tNMEA2000::SetN2kSource(unsigned char _iAddr, int _iDev) {
   if ( !IsValidDevice(_iDev) || IsInitialized() ) return;
   InitDevices();
-  Devices[_iDev].N2kSource= _iAddr;
+  SetDeviceSource(_iDev,_iAddr);
   Devices[_iDev].UpdateAddressClaimEndSource();
 }
 
@@ -2011,31 +2721,31 @@ bool tNMEA2000::ReadResetDeviceInformationChanged() {
 
 //*****************************************************************************
 void tNMEA2000::GetNextAddress(int DeviceIndex, bool RestartAtAnd) {
-  bool FoundSame;
+  unsigned char Source=Devices[DeviceIndex].N2kSource;
+  int Other;
   // Currently simply add address
   // Note that 251 is the last source. We do not send data if address is higher than that.
   
   do {
-    if ( Devices[DeviceIndex].N2kSource==N2kNullCanBusAddress ) {
+    if ( Source==N2kNullCanBusAddress ) {
       if ( RestartAtAnd ) {
         // For null address start from beginning.
-        Devices[DeviceIndex].N2kSource=14;
+        Source=14;
+        SetDeviceSource(DeviceIndex,Source);
         Devices[DeviceIndex].UpdateAddressClaimEndSource();
       } else return;
-    } else if (Devices[DeviceIndex].N2kSource!=Devices[DeviceIndex].AddressClaimEndSource) {
-      Devices[DeviceIndex].N2kSource++;
+    } else if (Source!=Devices[DeviceIndex].AddressClaimEndSource) {
+      Source++;
       // Roll to start?
-      if ( Devices[DeviceIndex].N2kSource>N2kMaxCanBusAddress ) Devices[DeviceIndex].N2kSource=0;
+      if ( Source>N2kMaxCanBusAddress ) Source=0;
     } else {
-      Devices[DeviceIndex].N2kSource=N2kNullCanBusAddress; // Force null address = cannot claim address
+      SetDeviceSource(DeviceIndex,N2kNullCanBusAddress); // Force null address = cannot claim address
       return;
     }
-    FoundSame=false;
     // Check that we do not have same on our list
-    for (int i=0; i<DeviceCount && !FoundSame; i++) {
-      if (i!=DeviceIndex) FoundSame=(Devices[DeviceIndex].N2kSource==Devices[i].N2kSource);
-    }
-  } while (FoundSame);
+    Other=FindSourceDeviceIndex(Source);
+  } while ( Other>=0 && Other!=DeviceIndex );
+  SetDeviceSource(DeviceIndex,Source);
 }
 
 //*****************************************************************************
@@ -2072,14 +2782,34 @@ bool tNMEA2000::HandleReceivedSystemMessage(int MsgIndex) {
   return result;
 }
 
+//*****************************************************************************
+int tNMEA2000::CANGetFrames(tN2kCANFrame *Frames, int MaxFrames) {
+  int nFrames=0;
+
+  for ( ; nFrames<MaxFrames && CANGetFrame(Frames[nFrames].id,Frames[nFrames].len,Frames[nFrames].buf); nFrames++ );
+
+  return nFrames;
+}
+
+//*****************************************************************************
+void tNMEA2000::ResetParseStatistics() {
+  memset(&ParseStatistics,0,sizeof(ParseStatistics));
+}
+
+//*****************************************************************************
+// Budget was used. Read one more frame to see, if driver still has frames. It will
+// be handled first on next ParseMessages, so budget is kept.
+bool tNMEA2000::HoldNextFrame() {
+  if ( !HasHeldFrame ) HasHeldFrame=( CANGetFrames(&HeldFrame,1)>0 );
+  return HasHeldFrame;
+}
+
 //*****************************************************************************
 void tNMEA2000::ParseMessages() {
-    unsigned long canId;
-    unsigned char len = 0;
-    unsigned char buf[8];
+    tN2kCANFrame Frames[N2kCANFrameBatchSize];
     uint8_t MsgIndex;
-    static const int MaxReadFramesOnParse=20;
-    int FramesRead=0;
+    uint32_t FramesRead=0;
+    bool BudgetLimited=false;
 //    tN2kMsg N2kMsg;
 
     if (!Open()) return;  // Can not do much
@@ -2091,14 +2821,29 @@ void tNMEA2000::ParseMessages() {
     SendPendingTPMessages();
 #endif
     SendPendingInformation();
+#if !defined(N2K_NO_SCHEDULED_SEND)
+    SendScheduledMessages();
+#endif
 #if defined(DEBUG_NMEA2000_ISR)
     TestISR();
 #endif
 
-    while (FramesRead<MaxReadFramesOnParse && CANGetFrame(canId,len,buf) ) {           // check if data coming
-        FramesRead++;
-        N2kMsgDbg("Received frame, can ID:"); N2kMsgDbg(canId); N2kMsgDbg(" len:"); N2kMsgDbg(len); N2kMsgDbg(" data:"); DbgPrintBuf(len,buf,false); N2kMsgDbgln();
-        MsgIndex=SetN2kCANBufMsg(canId,len,buf);
+    unsigned long StartTime=(MaxParseTime>0?millis():0);
+    while (true) {
+      int MaxFrames=N2kCANFrameBatchSize;
+      if ( MaxReadFramesOnParse>0 ) {
+        if ( FramesRead>=MaxReadFramesOnParse ) { BudgetLimited=HoldNextFrame(); break; }
+        if ( MaxReadFramesOnParse-FramesRead<(uint32_t)MaxFrames ) MaxFrames=MaxReadFramesOnParse-FramesRead;
+      }
+      int nFrames=0;
+      if ( HasHeldFrame ) { Frames[nFrames++]=HeldFrame; HasHeldFrame=false; }
+      if ( nFrames<MaxFrames ) nFrames+=CANGetFrames(Frames+nFrames,MaxFrames-nFrames);
+      if ( nFrames<=0 ) break;
+
+      for (int i=0; i<nFrames; i++) {
+        N2kMsgDbg("Received frame, can ID:"); N2kMsgDbg(Frames[i].id); N2kMsgDbg(" len:"); N2kMsgDbg(Frames[i].len); N2kMsgDbg(" data:"); DbgPrintBuf(Frames[i].len,Frames[i].buf,false); N2kMsgDbgln();
+        if ( FrameCaptureHandler!=0 ) FrameCaptureHandler(Frames[i],FrameCaptureContext);
+        MsgIndex=SetN2kCANBufMsg(Frames[i].id,Frames[i].len,Frames[i].buf);
         if (MsgIndex<MaxN2kCANMsgs) {
           if ( !HandleReceivedSystemMessage(MsgIndex) ) {
             N2kMsgDbgln(MsgIndex);
@@ -2106,21 +2851,64 @@ void tNMEA2000::ParseMessages() {
           }
 //          N2kCANMsgBuf[MsgIndex].N2kMsg.Print(Serial);
           RunMessageHandlers(N2kCANMsgBuf[MsgIndex].N2kMsg);
-          N2kCANMsgBuf[MsgIndex].FreeMessage();
+          FreeCANMsg(MsgIndex);
           N2kMsgDbg(MsgIndex); N2kMsgDbgln();
         }
+      }
+      FramesRead+=nFrames;
+
+      if ( nFrames<MaxFrames ) break; // Driver is empty
+      if ( MaxParseTime>0 && millis()-StartTime>=MaxParseTime ) { BudgetLimited=HoldNextFrame(); break; }
     }
 
+    ParseStatistics.ParseCalls++;
+    ParseStatistics.FramesRead+=FramesRead;
+    if ( FramesRead>ParseStatistics.MaxFramesOnParse ) ParseStatistics.MaxFramesOnParse=FramesRead;
+    if ( BudgetLimited ) ParseStatistics.BudgetLimitedCalls++;
+    ParseStatistics.LastPendingFrames=CANGetPendingFrames()+(HasHeldFrame?1:0);
+    if ( ParseStatistics.LastPendingFrames>ParseStatistics.MaxPendingFrames ) ParseStatistics.MaxPendingFrames=ParseStatistics.LastPendingFrames;
+
 #if !defined(N2K_NO_HEARTBEAT_SUPPORT)
     SendHeartbeat();
 #endif
 }
 
+#if !defined(N2K_NO_MSG_HANDLER_TABLE)
 //*****************************************************************************
-void tNMEA2000::RunMessageHandlers(const tN2kMsg &N2kMsg) {
-  if ( MsgHandler!=0 ) MsgHandler(N2kMsg);
-  
+void tNMEA2000::UpdateMsgHandlerSpans() {
+  MsgHandlersChanged=false;
+  if ( MsgHandlerSpans!=0 ) delete[] MsgHandlerSpans;
+  MsgHandlerSpans=0;
+  MsgHandlerSpanCount=0;
+
   tMsgHandler *MsgHandler=MsgHandlers;
+  for ( ;MsgHandler!=0 && MsgHandler->GetPGN()==0; MsgHandler=MsgHandler->pNext);
+  FirstPGNMsgHandler=MsgHandler;
+
+  uint16_t Count=0;
+  for ( unsigned long PGN=0; MsgHandler!=0; MsgHandler=MsgHandler->pNext) {
+    if ( MsgHandler->GetPGN()!=PGN ) { Count++; PGN=MsgHandler->GetPGN(); }
+  }
+  if ( Count==0 ) return;
+
+  // List is sorted by PGN, so handlers for same PGN are one after another
+  MsgHandlerSpans=new tMsgHandlerSpan[Count];
+  for ( MsgHandler=FirstPGNMsgHandler; MsgHandler!=0; MsgHandler=MsgHandler->pNext) {
+    if ( MsgHandlerSpanCount==0 || MsgHandlerSpans[MsgHandlerSpanCount-1].PGN!=MsgHandler->GetPGN() ) {
+      MsgHandlerSpans[MsgHandlerSpanCount].PGN=MsgHandler->GetPGN();
+      MsgHandlerSpans[MsgHandlerSpanCount].First=MsgHandler;
+      MsgHandlerSpans[MsgHandlerSpanCount].Count=0;
+      MsgHandlerSpanCount++;
+    }
+    MsgHandlerSpans[MsgHandlerSpanCount-1].Count++;
+  }
+}
+#endif
+
+//*****************************************************************************
+// Walks handler list from MsgHandler on. List is sorted by PGN and handlers
+// for all PGNs are first.
+void tNMEA2000::RunMessageHandlers(tMsgHandler *MsgHandler, const tN2kMsg &N2kMsg) {
   // Loop through all pgn handlers
   for ( ;MsgHandler!=0 && MsgHandler->GetPGN()==0; MsgHandler=MsgHandler->pNext) MsgHandler->HandleMsg(N2kMsg); 
   // Loop through specific pgn handlers
@@ -2129,6 +2917,40 @@ void tNMEA2000::RunMessageHandlers(const tN2kMsg &N2kMsg) {
   }
 }
 
+//*****************************************************************************
+void tNMEA2000::RunMessageHandlers(const tN2kMsg &N2kMsg) {
+  if ( MsgHandler!=0 ) MsgHandler(N2kMsg);
+
+#if !defined(N2K_NO_MSG_HANDLER_TABLE)
+  if ( MsgHandlersChanged ) UpdateMsgHandlerSpans();
+
+  tMsgHandler *MsgHandler=MsgHandlers;
+  // Loop through all pgn handlers
+  for ( ;MsgHandler!=FirstPGNMsgHandler; MsgHandler=MsgHandler->pNext) {
+    MsgHandler->HandleMsg(N2kMsg);
+    // If handler attached or detached handlers, spans are not valid anymore
+    if ( MsgHandlersChanged ) { RunMessageHandlers(MsgHandler->pNext,N2kMsg); return; }
+  }
+
+  // Find span of specific pgn handlers
+  uint16_t Low=0;
+  uint16_t High=MsgHandlerSpanCount;
+  while ( Low<High ) {
+    uint16_t Mid=(Low+High)/2;
+    if ( MsgHandlerSpans[Mid].PGN<N2kMsg.PGN ) { Low=Mid+1; } else { High=Mid; }
+  }
+  if ( Low>=MsgHandlerSpanCount || MsgHandlerSpans[Low].PGN!=N2kMsg.PGN ) return;
+
+  MsgHandler=MsgHandlerSpans[Low].First;
+  for ( uint16_t i=MsgHandlerSpans[Low].Count; i>0; i--, MsgHandler=MsgHandler->pNext ) {
+    MsgHandler->HandleMsg(N2kMsg);
+    if ( MsgHandlersChanged ) { RunMessageHandlers(MsgHandler->pNext,N2kMsg); return; }
+  }
+#else
+  RunMessageHandlers(MsgHandlers,N2kMsg);
+#endif
+}
+
 //*****************************************************************************
 void tNMEA2000::SetMsgHandler(void (*_MsgHandler)(const tN2kMsg &N2kMsg)) {
   MsgHandler=_MsgHandler;
@@ -2157,6 +2979,9 @@ void tNMEA2000::AttachMsgHandler(tMsgHandler *_MsgHandler) {
   }
   
   _MsgHandler->pNMEA2000=this;
+#if !defined(N2K_NO_MSG_HANDLER_TABLE)
+  MsgHandlersChanged=true;
+#endif
 }
 
 //*****************************************************************************
@@ -2171,6 +2996,9 @@ void tNMEA2000::DetachMsgHandler(tMsgHandler *_MsgHandler) {
     for ( ; MsgHandler!=0 && MsgHandler->pNext!=_MsgHandler; MsgHandler=MsgHandler->pNext );
     if ( MsgHandler!=0 ) MsgHandler->pNext=_MsgHandler->pNext;
   }
+#if !defined(N2K_NO_MSG_HANDLER_TABLE)
+  _MsgHandler->pNMEA2000->MsgHandlersChanged=true;
+#endif
   _MsgHandler->pNext=0;
   _MsgHandler->pNMEA2000=0;
 }
@@ -48,6 +48,13 @@ address anymore. See also method ReadResetAddressChanged().
 #include "N2kStream.h"
 #include "N2kMsg.h"
 #include "N2kCANMsg.h"
+#include "N2kCANMsgIndex.h"
+#if !defined(N2K_NO_SEND_RATE_LIMIT)
+#include "N2kRateLimiter.h"
+#endif
+#if !defined(N2K_NO_SCHEDULED_SEND)
+#include "N2kMsgScheduler.h"
+#endif
 
 #if !defined(N2K_NO_GROUP_FUNCTION_SUPPORT)
 #include "N2kGroupFunction.h"
@@ -75,6 +82,9 @@ address anymore. See also method ReadResetAddressChanged().
 #define N2kMessageGroups 2
 #define N2kMaxCanBusAddress 251
 #define N2kNullCanBusAddress 254
+#if !defined(N2kCANFrameBatchSize)
+#define N2kCANFrameBatchSize 8 // Frames read with one CANGetFrames call on ParseMessages
+#endif
 
 class tNMEA2000
 {
@@ -228,6 +238,88 @@ public:
       inline unsigned long GetPGN() const { return PGN; }
   };
 
+public:
+  // Receive statistics of ParseMessages calls
+  struct tParseStatistics {
+    uint32_t ParseCalls;
+    uint32_t FramesRead;
+    uint32_t BudgetLimitedCalls; // Calls ended by frame or time budget while driver still had frames
+    uint32_t MaxFramesOnParse;
+    uint16_t LastPendingFrames; // Frames left in driver after last call. Needs driver support.
+    uint16_t MaxPendingFrames;
+  };
+
+  // Send queue statistics per CAN priority
+  struct tSendStatistics {
+    uint32_t Frames;       // Frames given to driver
+    uint32_t QueuedFrames; // Frames, which had to wait in send queue
+    uint32_t TotalDelay;   // Sum of queueing delays in ms. Average is TotalDelay/QueuedFrames.
+    uint32_t Dropped;      // Frames dropped, since send queue was full
+    uint32_t Coalesced;    // Queued messages replaced by newer one, see SetCoalescedMessages
+    uint16_t MaxDelay;     // ms
+    uint16_t MaxQueued;    // Queue high-water mark
+  };
+
+#if !defined(N2K_NO_TX_LATENCY)
+  // Latency from SendMsg to driver taking last frame of message in ms. Bucket 0 counts
+  // 0 ms, bucket i latencies 2^(i-1)...2^i-1 ms and last bucket all longer ones.
+  static const uint8_t TxLatencyBuckets=10;
+  struct tTxLatencyHistogram {
+    uint16_t Count[TxLatencyBuckets]; // Counters saturate at 0xffff
+    uint16_t MaxLatency;
+  };
+
+  struct tTxPGNLatency {
+    unsigned long PGN;
+    tTxLatencyHistogram Histogram;
+  };
+
+  // One of slowest sent messages
+  struct tTxLatencyTrace {
+    unsigned long PGN;
+    unsigned long SentTime; // millis(), when driver took last frame
+    uint16_t Latency;
+    uint8_t Priority;
+    uint8_t Source;
+  };
+#endif
+
+#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
+  // Statistics of sent ISO transport protocol sessions
+  struct tTPStatistics {
+    uint32_t Started;    // Sessions started with BAM or RTS
+    uint32_t Completed;  // All BAM data sent or RTS/CTS session acknowledged
+    uint32_t Aborted;    // Aborted by receiver, by sequence error or since send failed
+    uint32_t TimedOut;   // Receiver did not respond in time
+    uint32_t Rejected;   // No free session
+    uint8_t MaxSessions; // High-water mark of sessions in use. Compare to SetTPSessionPoolSize.
+  };
+#endif
+
+#if !defined(N2K_NO_RX_STATISTICS)
+  // Receive path events, where frames or messages will be dropped
+  typedef enum { rxe_OrphanFrame, // Fast packet or TP data frame without message under reception
+                 rxe_LostFrame, // Frame out of sequence. Message under reception will be dropped.
+                 rxe_Restart, // New first frame while previous message from same sender was incomplete
+                 rxe_Eviction, // Incomplete message timed out and its slot was taken for new message
+                 rxe_NoFreeSlot, // New message dropped, since all slots were busy
+                 rxe_Count
+               } tRxEvent;
+
+  struct tRxStatistics {
+    uint32_t Events[rxe_Count];
+    uint32_t UntrackedPGNEvents; // Events, which did not fit to per PGN table
+    uint8_t SlotsInUse; // Reassembly slots currently in use
+    uint8_t MaxSlotsInUse; // High-water mark. Compare to SetN2kCANMsgBufSize.
+  };
+
+  // Per PGN and per source counters saturate at 0xffff
+  struct tRxPGNStatistics {
+    unsigned long PGN;
+    uint16_t Events[rxe_Count];
+  };
+#endif
+
 public:
   // Type how to forward messages in listen mode
   typedef enum { fwdt_Actisense, // Forwards messages to output port in Actisense format. Note that some Navigation sw uses this.
@@ -271,14 +363,11 @@ protected:
     // Transmit and receive PGNs
     const unsigned long *TransmitMessages;
     const unsigned long *ReceiveMessages;
-    // Fast packet PGNs sequence counters
-    size_t MaxPGNSequenceCounters;
-    unsigned long *PGNSequenceCounters;
-#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
-      tN2kMsg PendingTPMsg;
-      unsigned long NextDTSendTime; // Time, when next data packet can be send on TP broadcast
-      uint8_t NextDTSequence;
-#endif
+    // Fast packet PGNs sequence counters in hash table, which grows on demand.
+    // Entry has PGN in bits 0-23, counter in bits 24-26 and used flag in bit 31.
+    uint16_t PGNSequenceCounterSize; // Power of 2
+    uint16_t PGNSequenceCounterCount;
+    uint32_t *PGNSequenceCounters;
 #if !defined(N2K_NO_HEARTBEAT_SUPPORT)    
     unsigned long HeartbeatInterval;
     unsigned long DefaultHeartbeatInterval;
@@ -293,12 +382,7 @@ protected:
       PendingProductInformation=0; PendingConfigurationInformation=0; 
       AddressClaimStarted=0; AddressClaimEndSource=N2kMaxCanBusAddress; //GetNextAddressFromBeginning=true;
       TransmitMessages=0; ReceiveMessages=0;
-      MaxPGNSequenceCounters=0; PGNSequenceCounters=0;
-#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
-      NextDTSendTime=0;
-      NextDTSequence=0;
-#endif
-
+      PGNSequenceCounterSize=0; PGNSequenceCounterCount=0; PGNSequenceCounters=0;
 #if !defined(N2K_NO_HEARTBEAT_SUPPORT)    
       HeartbeatInterval=60000;
       DefaultHeartbeatInterval=60000;
@@ -333,6 +417,19 @@ protected:
     unsigned int ForwardMode; // Default all messages - also system and own.
     N2kStream *ForwardStream;
     tMsgHandler *MsgHandlers;
+#if !defined(N2K_NO_MSG_HANDLER_TABLE)
+    // PGN sorted spans of MsgHandlers list, so that dispatch needs one search.
+    // Rebuilt on first dispatch after handlers has been attached or detached.
+    struct tMsgHandlerSpan {
+      unsigned long PGN;
+      tMsgHandler *First;
+      uint16_t Count;
+    };
+    tMsgHandlerSpan *MsgHandlerSpans;
+    uint16_t MsgHandlerSpanCount;
+    tMsgHandler *FirstPGNMsgHandler; // First handler after handlers for all PGNs
+    bool MsgHandlersChanged;
+#endif
 
     bool DeviceReady;
     bool AddressChanged;
@@ -341,6 +438,31 @@ protected:
     // Device information
     tInternalDevice *Devices;
     int DeviceCount;
+    uint8_t *SourceDevices; // Device index by source with multiple devices, 0xff for none
+
+#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
+    // Sent TP messages. Each device can have one session per destination and one
+    // BAM session running at a time. Others wait in the pool in order of start.
+    typedef enum { tps_Free,
+                   tps_Waiting, // Waits for previous session to same destination
+                   tps_BAM, // Sends next data packet at NextTime
+                   tps_SendDT, // Sends packets allowed by CTS as fast as send buffer allows
+                   tps_WaitResponse // Waits for CTS or ACK until NextTime
+                 } tTPState;
+    struct tTPSession {
+      tN2kMsg Msg;
+      unsigned long NextTime;
+      uint16_t Order;
+      uint8_t State;
+      uint8_t Device;
+      uint8_t NextDTSequence;
+      uint8_t PacketsToSend; // Packets left from last CTS
+    };
+    tTPSession *TPSessions;
+    uint8_t MaxTPSessions;
+    uint16_t TPSessionOrder;
+    tTPStatistics TPStatistics;
+#endif
 //    unsigned long N2kSource[Max_N2kDevices];
 
     // Configuration information
@@ -349,6 +471,17 @@ protected:
 
     const unsigned long *SingleFrameMessages[N2kMessageGroups];
     const unsigned long *FastPacketMessages[N2kMessageGroups];
+#if !defined(N2K_NO_PGN_CLASS_TABLE)
+    // Sorted classification of all PGNs in active message lists. Built on Open
+    // and when lists change, so received frames need no list scanning.
+    enum tPGNClassFlags { pgnc_Known=1, pgnc_System=2, pgnc_FastPacket=4, pgnc_FastPacketPGN=8 };
+    struct tPGNClass {
+      unsigned long PGN;
+      uint8_t Flags;
+    };
+    tPGNClass *PGNClassTable;
+    uint16_t PGNClassCount;
+#endif
     
     class tCANSendFrame
     {
@@ -357,6 +490,8 @@ protected:
       unsigned char len;
       unsigned char buf[8];
       bool wait_sent;
+      unsigned long QueuedAt;
+      uint16_t Next; // Next frame in same priority queue or free list
 
     public:
       void Clear() {id=0; len=0; for (int i=0; i<8; i++) { buf[i]=0; } }
@@ -366,15 +501,60 @@ protected:
     // Buffer for received messages.
     tN2kCANMsg *N2kCANMsgBuf;
     uint8_t MaxN2kCANMsgs;
+    tN2kCANMsgIndex N2kCANMsgIndex;
 
+    // Send buffer is shared by one FIFO per CAN priority, so frames with lower
+    // priority value go first. Frames of one fast packet are in same FIFO.
     tCANSendFrame *CANSendFrameBuf;
     uint16_t MaxCANSendFrames;
-    uint16_t CANSendFrameBufferWrite;
-    uint16_t CANSendFrameBufferRead;
+    struct tSendQueue {
+      uint16_t Head;
+      uint16_t Tail;
+      uint16_t Count;
+    };
+    tSendQueue SendQueues[8];
+    uint16_t CANSendFrameFree; // Free list head
+    uint16_t CANSendFrameFreeCount;
+    uint8_t SendPriorityLock; // Priority of fast packet being sent or 0xff
+    uint8_t SendLockFramesLeft;
+    tSendStatistics SendStatistics[8];
+    const unsigned long *CoalescedMessages;
+#if !defined(N2K_NO_SEND_RATE_LIMIT)
+    tN2kRateLimiter *SendRateLimiter;
+#endif
+#if !defined(N2K_NO_SCHEDULED_SEND)
+    tN2kMsgScheduler *MsgScheduler;
+    uint16_t MaxScheduledMsgs;
+#endif
     uint16_t MaxCANReceiveFrames;
+    uint16_t MaxReadFramesOnParse;
+    uint16_t MaxParseTime;
+    tParseStatistics ParseStatistics;
+    // Frame read after budget was used to check that driver still had frames. Handled first on next ParseMessages.
+    tN2kCANFrame HeldFrame;
+    bool HasHeldFrame;
+#if !defined(N2K_NO_RX_STATISTICS)
+    tRxStatistics RxStatistics;
+    tRxPGNStatistics *RxPGNStatistics;
+    uint8_t MaxRxPGNStatistics;
+    uint8_t RxPGNStatisticsCount;
+    uint16_t (*RxSourceEvents)[rxe_Count]; // Indexed by source
+#endif
+#if !defined(N2K_NO_TX_LATENCY)
+    tTxLatencyHistogram *TxPriorityLatency; // 8 histograms, 0 when tracing is off
+    tTxPGNLatency *TxPGNLatency;
+    uint8_t MaxTxPGNLatency;
+    uint8_t TxPGNLatencyCount;
+    tTxLatencyTrace *TxSlowest;
+    uint8_t MaxTxSlowest;
+    uint8_t TxSlowestCount;
+    uint8_t TxSlowestMin; // Index of fastest trace in full table
+#endif
 
     // Handler callbacks
     void (*MsgHandler)(const tN2kMsg &N2kMsg);                  // Normal messages
+    void (*FrameCaptureHandler)(const tN2kCANFrame &Frame, void *Context); // Raw received frames
+    void *FrameCaptureContext;
     bool (*ISORqstHandler)(unsigned long RequestedPGN, unsigned char Requester, int DeviceIndex);                 // 'ISORequest' messages
 #if !defined(N2K_NO_GROUP_FUNCTION_SUPPORT)
     tN2kGroupFunctionHandler *pGroupFunctionHandlers;
@@ -387,6 +567,11 @@ protected:
     virtual bool CANSendFrame(unsigned long id, unsigned char len, const unsigned char *buf, bool wait_sent=true)=0;
     virtual bool CANOpen()=0;
     virtual bool CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf)=0;
+    // Reads up to MaxFrames received frames and returns count of frames read. Default uses
+    // CANGetFrame. Inherit this, if driver can copy several frames from its buffer at once.
+    virtual int CANGetFrames(tN2kCANFrame *Frames, int MaxFrames);
+    // Returns count of received frames still waiting in driver. Default 0 means unknown.
+    virtual uint16_t CANGetPendingFrames() { return 0; }
     // This will be called on Open() before any other initialization. Inherit this, if buffers can be set for the driver 
     // and you want to change size of library send frame buffer size. See e.g. NMEA2000_teensy.cpp. 
     virtual void InitCANFrameBuffers();
@@ -397,11 +582,22 @@ protected:
 protected:
     bool SendFrames(); // Sends pending frames
     bool SendFrame(unsigned long id, unsigned char len, const unsigned char *buf, bool wait_sent=true);
-    tCANSendFrame *GetNextFreeCANSendFrame();
+    tCANSendFrame *GetNextFreeCANSendFrame(uint8_t Priority);
+    uint16_t GetCANSendFrameBufFree() const { return ( CANSendFrameBuf!=0 ? CANSendFrameFreeCount : 0 ); }
+    void CANSendFrameDone(unsigned long id, const unsigned char *buf, bool FastPacket, unsigned long Delay=0);
+#if !defined(N2K_NO_TX_LATENCY)
+    void CountTxLatency(unsigned long id, unsigned long Latency);
+#endif
+    bool CoalesceQueuedMsg(unsigned long canId, const tN2kMsg &N2kMsg, bool FastPacket);
+    bool HasSendFrameSpace(int Frames);
     // Currently Product Information and Configuration Information will we pended on ISO request.
     // This is because specially for broadcasted response it may take a while, when higher priority
     // devices sends their response.
     void SendPendingInformation();
+#if !defined(N2K_NO_SCHEDULED_SEND)
+    void SendScheduledMessages();
+#endif
+    bool HoldNextFrame();
 
 protected:
     void InitDevices();
@@ -410,8 +606,20 @@ protected:
     void FindFreeCANMsgIndex(unsigned long PGN, unsigned char Source, unsigned char Destination, bool TPMsg, uint8_t &MsgIndex);
 #else    
     void FindFreeCANMsgIndex(unsigned long PGN, unsigned char Source, unsigned char Destination, uint8_t &MsgIndex);
+#endif
+    void UseCANMsg(uint8_t MsgIndex);
+    void FreeCANMsg(uint8_t MsgIndex);
+#if !defined(N2K_NO_RX_STATISTICS)
+    void CountRxEvent(tRxEvent Event, unsigned long PGN, unsigned char Source);
+    void UpdateRxSlotsInUse();
 #endif
     uint8_t SetN2kCANBufMsg(unsigned long canId, unsigned char len, unsigned char *buf);
+    void UpdatePGNClassTable();
+#if !defined(N2K_NO_PGN_CLASS_TABLE)
+    uint8_t GetPGNClass(unsigned long PGN);
+#endif
+    bool IsFastPacketPGNFromLists(unsigned long PGN);
+    bool CheckKnownMessageFromLists(unsigned long PGN, bool &SystemMessage, bool &FastPacket);
     bool IsFastPacketPGN(unsigned long PGN);
     bool IsFastPacket(const tN2kMsg &N2kMsg);
     bool CheckKnownMessage(unsigned long PGN, bool &SystemMessage, bool &FastPacket);
@@ -432,6 +640,7 @@ protected:
     void GetNextAddress(int DeviceIndex, bool RestartAtAnd=false);
     bool IsMySource(unsigned char Source);
     int FindSourceDeviceIndex(unsigned char Source);
+    void SetDeviceSource(int iDev, unsigned char Source);
     int GetSequenceCounter(unsigned long PGN, int iDev);
     size_t GetFastPacketTxPGNCount(int iDev);
 
@@ -441,6 +650,10 @@ protected:
     bool ForwardOwnMessages() const { return ((ForwardMode&FwdModeBit_OwnMessages)>0); }
     bool HandleOnlyKnownMessages() const { return ((ForwardMode&HandleModeBit_OnlyKnownMessages)>0); }
     
+#if !defined(N2K_NO_MSG_HANDLER_TABLE)
+    void UpdateMsgHandlerSpans();
+#endif
+    void RunMessageHandlers(tMsgHandler *MsgHandler, const tN2kMsg &N2kMsg);
     void RunMessageHandlers(const tN2kMsg &N2kMsg);
     
     bool HandleReceivedMessage(unsigned char Destination) { 
@@ -464,15 +677,19 @@ protected:
     bool TestHandleTPMessage(unsigned long PGN, unsigned char Source, unsigned char Destination, 
                              unsigned char len, unsigned char *buf,
                              uint8_t &MsgIndex);
-    bool SendTPCM_BAM(int iDev);
-    bool SendTPCM_RTS(int iDev);
+    bool SendTPCM_BAM(const tTPSession &Session);
+    bool SendTPCM_RTS(const tTPSession &Session);
     void SendTPCM_CTS(unsigned long PGN, unsigned char Destination, int iDev, unsigned char nPackets, unsigned char NextPacketNumber);
     void SendTPCM_EndAck(unsigned long PGN, unsigned char Destination, int iDev, uint16_t nBytes, unsigned char nPackets);
     void SendTPCM_Abort(unsigned long PGN, unsigned char Destination, int iDev, unsigned char AbortCode);
-    bool SendTPDT(int iDev);
-    bool HasAllTPDTSent(int iDev);
+    bool SendTPDT(tTPSession &Session);
+    bool HasAllTPDTSent(const tTPSession &Session) { return ( Session.NextDTSequence*7>=Session.Msg.DataLen ); }
+    tTPSession *FindTPSession(int iDev, unsigned char Destination);
     bool StartSendTPMessage(const tN2kMsg& msg, int iDev);
-    void EndSendTPMessage(int iDev);
+    bool StartTPSession(tTPSession &Session);
+    void EndSendTPMessage(tTPSession &Session);
+    void SendTPSessionData(tTPSession &Session);
+    unsigned long TPBAMInterval();
     void SendPendingTPMessages();
 #endif
 #if !defined(N2K_NO_GROUP_FUNCTION_SUPPORT)
@@ -483,6 +700,7 @@ public:
     tNMEA2000();
     
     // Your device can show multiple devices on the bus. If you define more than on device, call this before any other setting.
+    // Each device claims own address, so count can be up to 252 e.g. for replaying log with original sources.
     void SetDeviceCount(const uint8_t _DeviceCount);
 
     // As default there are reservation for 5 messages. If it is not critical to handle all fast packet messages like with N2km_NodeOnly
@@ -501,6 +719,53 @@ public:
     // If you use this function, call it once before Open();
     virtual void SetN2kCANReceiveFrameBufSize(const uint16_t _MaxCANReceiveFrames) { if ( !IsInitialized() ) MaxCANReceiveFrames=_MaxCANReceiveFrames; }
 
+#if !defined(N2K_NO_ISO_MULTI_PACKET_SUPPORT)
+    // Number of TP messages (default 4), which can be sent or wait for sending at same time. Sessions
+    // to different destinations run concurrently. Each session takes full tN2kMsg. Call before Open().
+    void SetTPSessionPoolSize(uint8_t _MaxTPSessions) { if ( TPSessions==0 ) MaxTPSessions=_MaxTPSessions; }
+    const tTPStatistics &GetTPStatistics() const { return TPStatistics; }
+    void ResetTPStatistics();
+#endif
+
+    // ParseMessages reads at most MaxFrames frames (default 20) and stops reading after MaxTime ms
+    // (default 0=no time limit). Time will be checked after every frame batch. With 0 frames there is no
+    // frame limit, so set time limit or take care that bus load can not keep ParseMessages busy.
+    void SetMaxReadFramesOnParse(uint16_t MaxFrames) { MaxReadFramesOnParse=MaxFrames; }
+    void SetMaxParseTime(uint16_t MaxTime) { MaxParseTime=MaxTime; }
+    const tParseStatistics &GetParseStatistics() const { return ParseStatistics; }
+    void ResetParseStatistics();
+
+    // Send queue statistics for CAN priority 0-7.
+    const tSendStatistics &GetSendStatistics(uint8_t Priority) const { return SendStatistics[Priority & 0x7]; }
+    void ResetSendStatistics();
+
+#if !defined(N2K_NO_TX_LATENCY)
+    // Enables send latency histograms for each priority and for first MaxPGNs sent PGNs and keeps
+    // trace of Slowest slowest messages. Tracing costs few compares per sent message. 0,0 disables tracing.
+    void SetTxLatencyTracing(uint8_t MaxPGNs, uint8_t Slowest);
+    // Returns histogram of priority 0-7 or 0, if tracing is disabled.
+    const tTxLatencyHistogram *GetTxPriorityLatency(uint8_t Priority) const { return ( TxPriorityLatency!=0 ? &TxPriorityLatency[Priority & 0x7] : 0 ); }
+    const tTxPGNLatency *GetTxPGNLatency(uint8_t &Count) const { Count=TxPGNLatencyCount; return TxPGNLatency; }
+    // Returns slowest messages in no order.
+    const tTxLatencyTrace *GetTxSlowest(uint8_t &Count) const { Count=TxSlowestCount; return TxSlowest; }
+    void ResetTxLatency();
+    // Prints histograms and slowest messages, slowest first, as text to OutStream or to forward stream.
+    void PrintTxLatency(N2kStream *OutStream=0);
+#endif
+
+#if !defined(N2K_NO_RX_STATISTICS)
+    // Totals of receive path events and slot high-water mark are always counted. With this function
+    // you can also enable counters for first MaxPGNs PGNs having events and counters for each source.
+    // Per source counters take 256*rxe_Count*2 bytes.
+    void SetRxStatisticsSize(uint8_t MaxPGNs, bool BySource=false);
+    const tRxStatistics &GetRxStatistics() const { return RxStatistics; }
+    // Returns table of PGNs having events and sets Count to its length.
+    const tRxPGNStatistics *GetRxPGNStatistics(uint8_t &Count) const { Count=RxPGNStatisticsCount; return RxPGNStatistics; }
+    // Returns event counters indexed by tRxEvent for source or 0, if per source counters are not enabled.
+    const uint16_t *GetRxSourceEvents(unsigned char Source) const { return ( RxSourceEvents!=0 ? RxSourceEvents[Source] : 0 ); }
+    void ResetRxStatistics();
+#endif
+
     // Define your product information. Defaults will be set on initialization.
     // For keeping defaults use 0xffff/0xff for int/char values and nul ptr for pointers.
     // LoadEquivalency is multiplication of 50 mA, what your device will take power from
@@ -566,6 +831,27 @@ public:
     // With these messages you can extent that list. See example TemperatureMonitor
     void ExtendTransmitMessages(const unsigned long *_SingleFrameMessages, int iDev=0);
     void ExtendReceiveMessages(const unsigned long *_FastPacketMessages, int iDev=0);
+    // Messages on this list will replace same PGN from same source, which is still waiting in send
+    // buffer and has not started sending, so receivers get only freshest value. Use for periodic
+    // messages like position or heading. Fast packet will be replaced only with same length message.
+    // Pointer must be in PROGMEM.
+    void SetCoalescedMessages(const unsigned long *_CoalescedMessages) { CoalescedMessages=_CoalescedMessages; }
+#if !defined(N2K_NO_SEND_RATE_LIMIT)
+    // Limits SendMsg rate of PGN to one message per Interval ms with Burst messages burst, separately for
+    // each source. Over limit messages will be dropped or with tN2kRateLimiter::rlp_Coalesce they
+    // replace same message waiting in send buffer. Interval 0 removes limit. Limiter will be allocated
+    // on first call with room for MaxLimits PGNs and MaxBuckets PGN and source pairs.
+    bool SetSendRateLimit(unsigned long PGN, uint16_t Interval, uint8_t Burst=1,
+                          tN2kRateLimiter::tPolicy Policy=tN2kRateLimiter::rlp_Drop,
+                          uint8_t MaxLimits=16, uint16_t MaxBuckets=64);
+    const tN2kRateLimiter *GetSendRateLimiter() const { return SendRateLimiter; }
+#endif
+#if !defined(N2K_NO_SCHEDULED_SEND)
+    // Set buffer size for messages waiting SendMsgAt send time. Each message takes full tN2kMsg.
+    // Buffer will be allocated on first SendMsgAt, so call this before that.
+    void SetScheduledMsgBufSize(uint16_t _MaxScheduledMsgs) { if ( MsgScheduler==0 ) MaxScheduledMsgs=_MaxScheduledMsgs; }
+    const tN2kMsgScheduler *GetMsgScheduler() const { return MsgScheduler; }
+#endif
 
     // Set default device information.
     // For keeping defaults use 0xffff/0xff for int/char values and nul ptr for pointers.
@@ -620,6 +906,7 @@ public:
     // Note that other than N2km_ListenOnly modes will automatically start initialization and address claim procedure.
     // You have to call ParseMessages() periodically to handle these procedures.
     // If you know your system, define source something other address you allready have on your bus.
+    // With multiple devices, device i starts from _N2kSource+i wrapped to 0 after address 251.
     void SetMode(tN2kMode _N2kMode, unsigned long _N2kSource=15);
 
     // Set type how messages will be forwarded in listen mode. Defult is fwdt_Actisense
@@ -633,6 +920,12 @@ public:
 
     // Generate N2k message e.g. by using N2kMessages.h and simply send it to the bus.
     bool SendMsg(const tN2kMsg &N2kMsg, int DeviceIndex=0);
+#if !defined(N2K_NO_SCHEDULED_SEND)
+    // Copies message to be sent, when millis() reaches SendTime. ParseMessages sends
+    // messages in time order and waits, if there is no room for message frames.
+    // Returns false, if scheduled message buffer is full.
+    bool SendMsgAt(const tN2kMsg &N2kMsg, unsigned long SendTime, int DeviceIndex=0);
+#endif
 
     // Call this periodically to handle N2k messages. Note that even if you only send e.g.
     // temperature to the bus, you should call this so the code will automatically inform
@@ -644,6 +937,10 @@ public:
     void AttachMsgHandler(tMsgHandler *_MsgHandler);
     void DetachMsgHandler(tMsgHandler *_MsgHandler);
     void SetISORqstHandler(bool(*ISORequestHandler)(unsigned long RequestedPGN, unsigned char Requester, int DeviceIndex));           // ISORequest messages
+    // Set handler, which gets every received CAN frame before it will be handled, e.g. for frame logging.
+    void SetFrameCaptureHandler(void (*_FrameCaptureHandler)(const tN2kCANFrame &Frame, void *Context), void *Context=0) {
+      FrameCaptureHandler=_FrameCaptureHandler; FrameCaptureContext=Context;
+    }
 #if !defined(N2K_NO_GROUP_FUNCTION_SUPPORT)
     void AddGroupFunctionHandler(tN2kGroupFunctionHandler *pGroupFunctionHandler);
 #endif
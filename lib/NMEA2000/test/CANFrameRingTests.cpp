@@ -0,0 +1,120 @@
+/*
+  The MIT License
+
+  Copyright (c) 2017 Thomas Sarlandie thomas@sarlandie.net
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <catch.hpp>
+#include <N2kCANFrameRing.h>
+#include <string.h>
+#include <thread>
+#include <chrono>
+
+static void SetFrame(tN2kCANFrame &Frame, uint32_t n) {
+  Frame.id=n & 0x1fffffffUL;
+  Frame.len=1+n%8;
+  memset(Frame.buf,0,8);
+  for (int i=0; i<4 && i<Frame.len; i++) Frame.buf[i]=(unsigned char)(n>>(8*i));
+}
+
+static bool IsFrame(const tN2kCANFrame &Frame, uint32_t n) {
+  tN2kCANFrame Expected;
+  SetFrame(Expected,n);
+  return Frame.id==Expected.id && Frame.len==Expected.len && memcmp(Frame.buf,Expected.buf,Frame.len)==0;
+}
+
+TEST_CASE("CAN frame ring", "[canframering]") {
+  tN2kCANFrameRing Ring;
+  tN2kCANFrame Frame;
+
+  SetFrame(Frame,0);
+  REQUIRE( !Ring.Push(Frame) ); // Not initialized
+  REQUIRE( Ring.FreeSpace()==0 );
+  REQUIRE( Ring.Init(100) );
+  REQUIRE( Ring.GetSize()==128 );
+  REQUIRE( Ring.IsEmpty() );
+  REQUIRE( Ring.FreeSpace()==128 );
+
+  SECTION("full ring and wrap around") {
+    uint32_t Pushed=0, Popped=0;
+    for (int Round=0; Round<1000; Round++) { // Indexes wrap many times
+      while ( true ) {
+        SetFrame(Frame,Pushed);
+        if ( !Ring.Push(Frame) ) break;
+        Pushed++;
+      }
+      REQUIRE( Ring.Count()==128 );
+      REQUIRE( Ring.FreeSpace()==0 );
+      for (int i=0; i<100; i++) {
+        REQUIRE( Ring.Pop(Frame) );
+        REQUIRE( IsFrame(Frame,Popped++) );
+      }
+    }
+    REQUIRE( Ring.GetOverflows()==1000 );
+    tN2kCANFrame Frames[8];
+    int n;
+    while ( (n=Ring.PopFrames(Frames,8))>0 ) {
+      for (int i=0; i<n; i++) REQUIRE( IsFrame(Frames[i],Popped++) );
+    }
+    REQUIRE( Popped==Pushed );
+    REQUIRE( !Ring.Pop(Frame) );
+  }
+}
+
+// Producer and consumer threads. Every frame carries its sequence number, so
+// consumer detects lost, duplicated and reordered frames.
+static void RunStress(uint16_t Size, uint32_t Total, bool Batch) {
+  tN2kCANFrameRing Ring;
+  REQUIRE( Ring.Init(Size) );
+
+  std::thread Producer([&Ring,Total]() {
+    tN2kCANFrame Frame;
+    for (uint32_t n=0; n<Total; n++) {
+      SetFrame(Frame,n);
+      while ( !Ring.Push(Frame) ) std::this_thread::yield();
+    }
+  });
+
+  uint32_t Received=0;
+  uint32_t Errors=0;
+  tN2kCANFrame Frames[8];
+  std::chrono::steady_clock::time_point Start=std::chrono::steady_clock::now();
+  while ( Received<Total ) {
+    int n=( Batch ? Ring.PopFrames(Frames,8) : (Ring.Pop(Frames[0]) ? 1 : 0) );
+    if ( n==0 ) std::this_thread::yield(); // Needed, if there is only one core
+    for (int i=0; i<n; i++, Received++) {
+      if ( !IsFrame(Frames[i],Received) ) Errors++;
+    }
+  }
+  double Seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-Start).count();
+  Producer.join();
+
+  REQUIRE( Errors==0 );
+  REQUIRE( Ring.IsEmpty() );
+  WARN( "Ring " << Size << (Batch?" batch":" single") << ": " << (Seconds>0?Total/Seconds/1e6:0) << " M frames/s" );
+}
+
+TEST_CASE("CAN frame ring threads", "[canframering]") {
+  RunStress(256,4000000,false);
+  RunStress(256,4000000,true);
+  RunStress(8,1000000,true); // Mostly full or empty
+}
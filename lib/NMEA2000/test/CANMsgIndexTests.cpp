@@ -0,0 +1,205 @@
+/*
+  The MIT License
+
+  Copyright (c) 2017 Thomas Sarlandie thomas@sarlandie.net
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <catch.hpp>
+#include <NMEA2000.h>
+#include <N2kCANMsgIndex.h>
+#include <string.h>
+#include <stdlib.h>
+
+extern uint32_t TestMillis;
+
+TEST_CASE("CAN message slot index", "[canmsgindex]") {
+  const uint8_t MaxMsgs=40;
+  tN2kCANMsgIndex Index;
+  Index.Init(MaxMsgs);
+
+  SECTION("free and oldest slots") {
+    REQUIRE( Index.GetFree()<MaxMsgs );
+    REQUIRE( Index.GetOldest()==MaxMsgs );
+
+    Index.Use(3,tN2kCANMsgIndex::FastPacketKey(129038L,10));
+    Index.Use(7,tN2kCANMsgIndex::TPKey(10,0xff));
+    Index.Use(5,tN2kCANMsgIndex::FastPacketKey(129038L,11));
+    REQUIRE( Index.Find(tN2kCANMsgIndex::FastPacketKey(129038L,10))==3 );
+    REQUIRE( Index.Find(tN2kCANMsgIndex::TPKey(10,0xff))==7 );
+    REQUIRE( Index.Find(tN2kCANMsgIndex::FastPacketKey(129038L,12))==MaxMsgs );
+    REQUIRE( Index.GetOldest()==3 );
+
+    Index.Touch(3);
+    REQUIRE( Index.GetOldest()==7 );
+    Index.Release(7);
+    REQUIRE( Index.GetOldest()==5 );
+    REQUIRE( Index.Find(tN2kCANMsgIndex::TPKey(10,0xff))==MaxMsgs );
+  }
+
+  SECTION("all slots busy") {
+    for (uint8_t i=0; i<MaxMsgs; i++) {
+      uint8_t Slot=Index.GetFree();
+      REQUIRE( Slot<MaxMsgs );
+      Index.Use(Slot,tN2kCANMsgIndex::FastPacketKey(129038L,i));
+    }
+    REQUIRE( Index.GetFree()==MaxMsgs );
+    for (uint8_t i=0; i<MaxMsgs; i++) {
+      REQUIRE( Index.Find(tN2kCANMsgIndex::FastPacketKey(129038L,i))<MaxMsgs );
+    }
+  }
+
+  SECTION("random use and release matches linear search") {
+    uint32_t Model[MaxMsgs];
+    bool ModelBusy[MaxMsgs];
+    for (uint8_t i=0; i<MaxMsgs; i++) ModelBusy[i]=false;
+    srand(1);
+    int Errors=0;
+
+    for (int n=0; n<20000; n++) {
+      uint32_t Key=tN2kCANMsgIndex::FastPacketKey(129000L+rand()%8,rand()%16);
+      uint8_t Slot=Index.Find(Key);
+      uint8_t ModelSlot=MaxMsgs;
+      for (uint8_t i=0; i<MaxMsgs; i++) if ( ModelBusy[i] && Model[i]==Key ) ModelSlot=i;
+      if ( Slot!=ModelSlot ) Errors++;
+
+      if ( Slot<MaxMsgs ) {
+        Index.Release(Slot);
+        ModelBusy[Slot]=false;
+      } else {
+        Slot=Index.GetFree();
+        if ( Slot<MaxMsgs ) {
+          if ( ModelBusy[Slot] ) Errors++;
+          Index.Use(Slot,Key);
+          Model[Slot]=Key;
+          ModelBusy[Slot]=true;
+        }
+      }
+    }
+    REQUIRE( Errors==0 );
+  }
+}
+
+// Sends fast packets from many sources interleaved frame by frame
+class tNMEA2000_frames : public tNMEA2000 {
+protected:
+  struct tFrame {
+    unsigned long id;
+    unsigned char len;
+    unsigned char buf[8];
+  };
+  tFrame Frames[2000];
+  int FrameCount;
+  int NextFrame;
+
+  bool CANSendFrame(unsigned long, unsigned char, const unsigned char *, bool) { return true; }
+  bool CANOpen() { return true; }
+  bool CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf) {
+    if ( NextFrame>=FrameCount ) return false;
+    id=Frames[NextFrame].id;
+    len=Frames[NextFrame].len;
+    memcpy(buf,Frames[NextFrame].buf,8);
+    NextFrame++;
+    return true;
+  }
+
+public:
+  tNMEA2000_frames() : FrameCount(0), NextFrame(0) {}
+
+  void AddFrame(unsigned long id, unsigned char b0, const unsigned char *Data, int len) {
+    tFrame &Frame=Frames[FrameCount++];
+    Frame.id=id;
+    Frame.len=8;
+    Frame.buf[0]=b0;
+    memset(Frame.buf+1,0xff,7);
+    memcpy(Frame.buf+1,Data,len);
+  }
+
+  // Adds frames of fast packet messages from sources 0..Sources-1, so that
+  // frame n of every message comes before frame n+1 of any message.
+  void AddInterleaved(unsigned long PGN, int FirstSource, int Sources, int DataLen, int MaxFrames=32) {
+    unsigned char Data[223];
+    for (int frame=0; frame*7<=DataLen+1 && frame<MaxFrames; frame++) {
+      for (int src=FirstSource; src<FirstSource+Sources; src++) {
+        for (int i=0; i<DataLen; i++) Data[i]=(unsigned char)(src+i);
+        unsigned long id=(6UL<<26) | (PGN<<8) | src;
+        if ( frame==0 ) {
+          unsigned char First[7];
+          First[0]=DataLen;
+          memcpy(First+1,Data,6);
+          AddFrame(id,0,First,7);
+        } else {
+          int Start=6+(frame-1)*7;
+          int len=DataLen-Start;
+          if ( len<=0 ) continue;
+          AddFrame(id,frame,Data+Start,(len>7?7:len));
+        }
+      }
+    }
+  }
+
+  void ParseAll() { while ( NextFrame<FrameCount ) ParseMessages(); }
+};
+
+static int ReceivedMsgs;
+static int ReceivedErrors;
+
+static void CheckMsg(const tN2kMsg &N2kMsg) {
+  ReceivedMsgs++;
+  for (int i=0; i<N2kMsg.DataLen; i++) {
+    if ( N2kMsg.Data[i]!=(unsigned char)(N2kMsg.Source+i) ) { ReceivedErrors++; break; }
+  }
+}
+
+TEST_CASE("Fast packet reassembly with indexed slots", "[canmsgindex]") {
+  tNMEA2000_frames N2k;
+  ReceivedMsgs=0;
+  ReceivedErrors=0;
+  N2k.SetMsgHandler(CheckMsg);
+
+  SECTION("many interleaved sources") {
+    N2k.SetN2kCANMsgBufSize(64);
+    N2k.AddInterleaved(129039L,0,50,26);
+    N2k.ParseAll();
+    REQUIRE( ReceivedMsgs==50 );
+    REQUIRE( ReceivedErrors==0 );
+  }
+
+  SECTION("no free slot until oldest times out") {
+    N2k.SetN2kCANMsgBufSize(2);
+    TestMillis=1000;
+    N2k.AddInterleaved(129039L,0,3,26);
+    N2k.ParseAll();
+    REQUIRE( ReceivedMsgs==2 );
+
+    tNMEA2000_frames N2kTimeout;
+    N2kTimeout.SetMsgHandler(CheckMsg);
+    N2kTimeout.SetN2kCANMsgBufSize(2);
+    N2kTimeout.AddInterleaved(129039L,0,2,26,2); // Two messages never finish
+    N2kTimeout.ParseAll();
+    TestMillis+=Max_N2kMsgBuf_Time+1;
+    N2kTimeout.AddInterleaved(129039L,2,1,26);
+    N2kTimeout.ParseAll();
+    REQUIRE( ReceivedMsgs==2+1 );
+    REQUIRE( ReceivedErrors==0 );
+    TestMillis=42;
+  }
+}
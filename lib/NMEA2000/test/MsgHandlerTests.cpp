@@ -0,0 +1,106 @@
+/*
+  The MIT License
+
+  Copyright (c) 2017 Thomas Sarlandie thomas@sarlandie.net
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <catch.hpp>
+#include <NMEA2000.h>
+
+class tNMEA2000_dispatch : public tNMEA2000 {
+protected:
+  bool CANSendFrame(unsigned long, unsigned char, const unsigned char *, bool) { return true; }
+  bool CANOpen() { return true; }
+  bool CANGetFrame(unsigned long &, unsigned char &, unsigned char *) { return false; }
+
+public:
+  void Dispatch(unsigned long PGN) {
+    tN2kMsg N2kMsg;
+    N2kMsg.SetPGN(PGN);
+    RunMessageHandlers(N2kMsg);
+  }
+};
+
+class tCountHandler : public tNMEA2000::tMsgHandler {
+public:
+  int Count;
+  unsigned long LastPGN;
+  tCountHandler(unsigned long _PGN, tNMEA2000 *_pNMEA2000) : tNMEA2000::tMsgHandler(_PGN,_pNMEA2000), Count(0), LastPGN(0) {}
+  void HandleMsg(const tN2kMsg &N2kMsg) { Count++; LastPGN=N2kMsg.PGN; }
+};
+
+// Detaches other handler on first message
+class tDetachHandler : public tNMEA2000::tMsgHandler {
+public:
+  tNMEA2000::tMsgHandler *Other;
+  tDetachHandler(unsigned long _PGN, tNMEA2000 *_pNMEA2000, tNMEA2000::tMsgHandler *_Other) : tNMEA2000::tMsgHandler(_PGN,_pNMEA2000), Other(_Other) {}
+  void HandleMsg(const tN2kMsg &) { if ( Other!=0 ) GetNMEA2000()->DetachMsgHandler(Other); Other=0; }
+};
+
+TEST_CASE("Message handler dispatch", "[msghandler]") {
+  tNMEA2000_dispatch N2k;
+  tCountHandler All(0,&N2k);
+  tCountHandler Heading1(127250L,&N2k);
+  tCountHandler Position(129025L,&N2k);
+  tCountHandler Heading2(127250L,&N2k);
+  tCountHandler Wind(130306L,&N2k);
+
+  SECTION("only matching handlers") {
+    N2k.Dispatch(127250L);
+    N2k.Dispatch(127250L);
+    N2k.Dispatch(129025L);
+    N2k.Dispatch(128259L);
+    N2k.Dispatch(130307L);
+    REQUIRE( All.Count==5 );
+    REQUIRE( Heading1.Count==2 );
+    REQUIRE( Heading2.Count==2 );
+    REQUIRE( Position.Count==1 );
+    REQUIRE( Wind.Count==0 );
+  }
+
+  SECTION("attach and detach between messages") {
+    N2k.Dispatch(130306L);
+    REQUIRE( Wind.Count==1 );
+    N2k.DetachMsgHandler(&Wind);
+    N2k.Dispatch(130306L);
+    REQUIRE( Wind.Count==1 );
+    N2k.DetachMsgHandler(&Heading1);
+    N2k.Dispatch(127250L);
+    REQUIRE( Heading1.Count==0 );
+    REQUIRE( Heading2.Count==1 );
+    N2k.AttachMsgHandler(&Wind);
+    N2k.Dispatch(130306L);
+    REQUIRE( Wind.Count==2 );
+    REQUIRE( All.Count==4 );
+  }
+
+  SECTION("handler detaches other handler") {
+    tDetachHandler Detacher(127250L,&N2k,&Heading2);
+    N2k.Dispatch(127250L);
+    REQUIRE( Heading1.Count==1 );
+    REQUIRE( Heading2.Count==0 );
+    N2k.Dispatch(127250L);
+    REQUIRE( Heading1.Count==2 );
+    REQUIRE( Heading2.Count==0 );
+    REQUIRE( All.Count==2 );
+  }
+}
@@ -0,0 +1,120 @@
+/*
+  The MIT License
+
+  Copyright (c) 2017 Thomas Sarlandie thomas@sarlandie.net
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <catch.hpp>
+#include <N2kMsgScheduler.h>
+#include <vector>
+
+// Advances scheduler ms by ms and collects data byte of due messages with release time
+static void Run(tN2kMsgScheduler &Scheduler, unsigned long From, unsigned long To,
+                std::vector<unsigned char> &Order, std::vector<unsigned long> &Times, unsigned long Step=1) {
+  const tN2kMsg *N2kMsg;
+  int DeviceIndex;
+  unsigned long SendTime;
+
+  for (unsigned long Now=From; Now<=To; Now+=Step) {
+    Scheduler.Advance(Now);
+    while ( Scheduler.PeekDue(N2kMsg,DeviceIndex,SendTime) ) {
+      REQUIRE( SendTime<=Now );
+      Order.push_back(N2kMsg->Data[0]);
+      Times.push_back(Now);
+      Scheduler.ReleaseDue(Now,true);
+    }
+  }
+}
+
+static tN2kMsg Msg(unsigned char Id) {
+  tN2kMsg N2kMsg;
+  N2kMsg.SetPGN(130312L);
+  N2kMsg.AddByte(Id);
+  return N2kMsg;
+}
+
+TEST_CASE("Scheduled messages are released at send time", "[scheduler]") {
+  tN2kMsgScheduler Scheduler;
+  std::vector<unsigned char> Order;
+  std::vector<unsigned long> Times;
+  const unsigned long Start=1000;
+  Scheduler.Init(8,Start);
+
+  SECTION("order over all wheel levels") {
+    // Times on level 0, 1, 2, beyond wheel and in past
+    unsigned long SendTimes[]={ Start+3, Start+70, Start+3, Start+5000, Start+300000, Start+4100, Start-10, Start+63 };
+    for (unsigned char i=0; i<8; i++) REQUIRE( Scheduler.Add(Msg(i),SendTimes[i],0) );
+    REQUIRE( !Scheduler.Add(Msg(8),Start,0) );
+
+    Run(Scheduler,Start,Start+400000,Order,Times);
+    unsigned char Expected[]={ 6, 0, 2, 7, 1, 5, 3, 4 };
+    REQUIRE( Order.size()==8 );
+    for (size_t i=0; i<8; i++) {
+      REQUIRE( Order[i]==Expected[i] );
+      unsigned long Due=SendTimes[Expected[i]];
+      REQUIRE( Times[i]==(Due<Start?Start:Due) );
+    }
+    REQUIRE( Scheduler.GetStatistics().Scheduled==8 );
+    REQUIRE( Scheduler.GetStatistics().Rejected==1 );
+    REQUIRE( Scheduler.GetStatistics().Sent==8 );
+    REQUIRE( Scheduler.GetStatistics().MaxLateness==10 );
+    REQUIRE( Scheduler.GetStatistics().InUse==0 );
+    REQUIRE( Scheduler.GetStatistics().MaxInUse==8 );
+  }
+
+  SECTION("message for handled ms is due without delay") {
+    const tN2kMsg *N2kMsg;
+    int DeviceIndex;
+    unsigned long SendTime;
+    Scheduler.Advance(Start+50);
+    REQUIRE( Scheduler.Add(Msg(1),Start+50,0) );
+    REQUIRE( Scheduler.Add(Msg(2),Start+20,0) );
+    REQUIRE( Scheduler.PeekDue(N2kMsg,DeviceIndex,SendTime) );
+    REQUIRE( N2kMsg->Data[0]==1 );
+    Scheduler.ReleaseDue(Start+50,true);
+    REQUIRE( Scheduler.PeekDue(N2kMsg,DeviceIndex,SendTime) );
+    REQUIRE( N2kMsg->Data[0]==2 );
+    Scheduler.ReleaseDue(Start+50,true);
+    REQUIRE( Scheduler.GetStatistics().MaxLateness==30 );
+    REQUIRE( !Scheduler.PeekDue(N2kMsg,DeviceIndex,SendTime) );
+  }
+
+  SECTION("sparse calls release late messages in order") {
+    for (unsigned char i=0; i<8; i++) REQUIRE( Scheduler.Add(Msg(i),Start+10000-i*1000,0) );
+    Run(Scheduler,Start,Start+20000,Order,Times,1500);
+    REQUIRE( Order.size()==8 );
+    for (size_t i=0; i<8; i++) REQUIRE( Order[i]==7-i );
+    REQUIRE( Scheduler.GetStatistics().MaxLateness<1500 );
+    REQUIRE( Scheduler.GetStatistics().TotalLateness>0 );
+  }
+
+  SECTION("pool entries are reused") {
+    unsigned long Now=Start;
+    for (unsigned char i=0; i<100; i++) {
+      REQUIRE( Scheduler.Add(Msg(i),Now+(i*37)%5000,0) );
+      if ( i%8==7 ) Run(Scheduler,Now,Now+5000,Order,Times), Now+=5001;
+    }
+    Run(Scheduler,Now,Now+5000,Order,Times);
+    REQUIRE( Order.size()==100 );
+    REQUIRE( Scheduler.GetStatistics().MaxLateness==0 );
+  }
+}
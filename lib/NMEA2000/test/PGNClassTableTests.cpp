@@ -0,0 +1,103 @@
+/*
+  The MIT License
+
+  Copyright (c) 2017 Thomas Sarlandie thomas@sarlandie.net
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <catch.hpp>
+#include <NMEA2000.h>
+
+const unsigned long UserSingleFrameMessages[] PROGMEM = { 130323L, 127245L, 0 };
+const unsigned long UserFastPacketMessages[] PROGMEM = { 129044L, 127233L, 126464L, 0 };
+const unsigned long ExtendedFastPacketMessages[] PROGMEM = { 130323L, 65280L, 0 };
+
+class tNMEA2000_classify : public tNMEA2000 {
+protected:
+  bool CANSendFrame(unsigned long, unsigned char, const unsigned char *, bool) { return true; }
+  bool CANOpen() { return true; }
+  bool CANGetFrame(unsigned long &, unsigned char &, unsigned char *) { return false; }
+
+public:
+  bool HasTable() const { return PGNClassTable!=0; }
+
+  // Compares table lookup to list scanning for all possible PGNs. PGN 0 is
+  // left out, since list scanning finds it at the end marker of user lists.
+  int CountMismatches() {
+    int Mismatches=0;
+    for (unsigned long PGN=1; PGN<=0x1ffffUL; PGN++) {
+      bool TableSystem, TableFast, ListSystem, ListFast;
+      bool TableKnown=CheckKnownMessage(PGN,TableSystem,TableFast);
+      bool ListKnown=CheckKnownMessageFromLists(PGN,ListSystem,ListFast);
+      if ( TableKnown!=ListKnown || TableSystem!=ListSystem || TableFast!=ListFast ||
+           IsFastPacketPGN(PGN)!=IsFastPacketPGNFromLists(PGN) ) Mismatches++;
+    }
+    return Mismatches;
+  }
+
+  bool FastPacketPGN(unsigned long PGN) { return IsFastPacketPGN(PGN); }
+  bool Known(unsigned long PGN, bool &SystemMessage, bool &FastPacket) { return CheckKnownMessage(PGN,SystemMessage,FastPacket); }
+};
+
+TEST_CASE("PGN class table matches list scanning", "[classify]") {
+  tNMEA2000_classify N2k;
+  bool SystemMessage, FastPacket;
+
+  REQUIRE( !N2k.HasTable() );
+  REQUIRE( N2k.Known(129029L,SystemMessage,FastPacket) );
+
+  N2k.Open();
+  REQUIRE( N2k.HasTable() );
+
+  SECTION("default lists") {
+    REQUIRE( N2k.CountMismatches()==0 );
+
+    REQUIRE( N2k.Known(59904L,SystemMessage,FastPacket) );
+    REQUIRE( SystemMessage );
+    REQUIRE( !FastPacket );
+
+    REQUIRE( N2k.Known(126208L,SystemMessage,FastPacket) );
+    REQUIRE( SystemMessage );
+    REQUIRE( FastPacket );
+
+    REQUIRE( N2k.Known(129029L,SystemMessage,FastPacket) );
+    REQUIRE( !SystemMessage );
+    REQUIRE( FastPacket );
+
+    REQUIRE( !N2k.Known(0,SystemMessage,FastPacket) );
+    REQUIRE( !N2k.Known(130323L,SystemMessage,FastPacket) );
+  }
+
+  SECTION("user lists after open") {
+    N2k.SetSingleFrameMessages(UserSingleFrameMessages);
+    N2k.SetFastPacketMessages(UserFastPacketMessages);
+    REQUIRE( N2k.CountMismatches()==0 );
+    REQUIRE( N2k.Known(130323L,SystemMessage,FastPacket) );
+    REQUIRE( !FastPacket );
+    REQUIRE( !N2k.Known(129029L,SystemMessage,FastPacket) );
+    REQUIRE( !N2k.FastPacketPGN(0) );
+
+    N2k.ExtendFastPacketMessages(ExtendedFastPacketMessages);
+    REQUIRE( N2k.CountMismatches()==0 );
+    REQUIRE( N2k.Known(65280L,SystemMessage,FastPacket) );
+    REQUIRE( FastPacket );
+  }
+}
@@ -0,0 +1,119 @@
+/*
+  The MIT License
+
+  Copyright (c) 2017 Thomas Sarlandie thomas@sarlandie.net
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <catch.hpp>
+#include <NMEA2000.h>
+
+extern uint32_t TestMillis;
+
+// Driver with queued single frame messages. Every frame read takes 1 ms.
+class tNMEA2000_queue : public tNMEA2000 {
+protected:
+  int Queued;
+  int BatchCalls;
+
+  bool CANSendFrame(unsigned long, unsigned char, const unsigned char *, bool) { return true; }
+  bool CANOpen() { return true; }
+  bool CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf) {
+    if ( Queued==0 ) return false;
+    Queued--;
+    TestMillis++;
+    id=(2UL<<26) | (127250UL<<8) | 1; // Vessel heading from source 1
+    len=8;
+    for (int i=0; i<8; i++) buf[i]=i;
+    return true;
+  }
+  int CANGetFrames(tN2kCANFrame *Frames, int MaxFrames) {
+    BatchCalls++;
+    return tNMEA2000::CANGetFrames(Frames,MaxFrames);
+  }
+  uint16_t CANGetPendingFrames() { return Queued; }
+
+public:
+  tNMEA2000_queue() : Queued(0), BatchCalls(0) {}
+  void Queue(int Frames) { Queued+=Frames; }
+  int GetBatchCalls() const { return BatchCalls; }
+};
+
+static int HandledMsgs;
+static void CountMsg(const tN2kMsg &) { HandledMsgs++; }
+
+TEST_CASE("ParseMessages frame budget", "[parse]") {
+  tNMEA2000_queue N2k;
+  HandledMsgs=0;
+  N2k.SetMsgHandler(CountMsg);
+
+  SECTION("default budget") {
+    N2k.Queue(50);
+    N2k.ParseMessages();
+    const tNMEA2000::tParseStatistics &Stats=N2k.GetParseStatistics();
+    REQUIRE( HandledMsgs==20 );
+    REQUIRE( Stats.FramesRead==20 );
+    REQUIRE( Stats.BudgetLimitedCalls==1 );
+    REQUIRE( Stats.LastPendingFrames==30 );
+    // 8+8+4 frames and one frame to check that driver still has frames
+    REQUIRE( N2k.GetBatchCalls()==4 );
+
+    N2k.ParseMessages();
+    N2k.ParseMessages();
+    REQUIRE( HandledMsgs==50 );
+    REQUIRE( Stats.ParseCalls==3 );
+    REQUIRE( Stats.BudgetLimitedCalls==2 );
+    REQUIRE( Stats.LastPendingFrames==0 );
+    REQUIRE( Stats.MaxPendingFrames==30 );
+    REQUIRE( Stats.MaxFramesOnParse==20 );
+  }
+
+  SECTION("budget used exactly by last frames") {
+    N2k.Queue(20);
+    N2k.ParseMessages();
+    REQUIRE( HandledMsgs==20 );
+    REQUIRE( N2k.GetParseStatistics().BudgetLimitedCalls==0 );
+    REQUIRE( N2k.GetParseStatistics().LastPendingFrames==0 );
+  }
+
+  SECTION("no frame limit") {
+    N2k.SetMaxReadFramesOnParse(0);
+    N2k.Queue(100);
+    N2k.ParseMessages();
+    REQUIRE( HandledMsgs==100 );
+    REQUIRE( N2k.GetParseStatistics().BudgetLimitedCalls==0 );
+  }
+
+  SECTION("time budget") {
+    N2k.SetMaxReadFramesOnParse(0);
+    N2k.SetMaxParseTime(10);
+    N2k.Queue(100);
+    N2k.ParseMessages();
+    // Time is checked after each batch
+    REQUIRE( HandledMsgs==2*N2kCANFrameBatchSize );
+    REQUIRE( N2k.GetParseStatistics().BudgetLimitedCalls==1 );
+    REQUIRE( N2k.GetParseStatistics().LastPendingFrames==100-2*N2kCANFrameBatchSize );
+    N2k.ResetParseStatistics();
+    REQUIRE( N2k.GetParseStatistics().ParseCalls==0 );
+  }
+
+  TestMillis=42;
+}
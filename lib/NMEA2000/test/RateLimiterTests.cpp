@@ -0,0 +1,86 @@
+/*
+  The MIT License
+
+  Copyright (c) 2017 Thomas Sarlandie thomas@sarlandie.net
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <catch.hpp>
+#include <N2kRateLimiter.h>
+
+TEST_CASE("Token bucket rate limiter", "[ratelimiter]") {
+  tN2kRateLimiter Limiter;
+  Limiter.Init(4,8);
+  uint8_t Limit;
+  unsigned long Now=1000;
+
+  REQUIRE( Limiter.Check(127250L,1,Now,Limit)==tN2kRateLimiter::rlr_Pass ); // No limits
+  REQUIRE( Limiter.SetLimit(127250L,100,3) );
+  REQUIRE( Limiter.SetLimit(129029L,1000,1,tN2kRateLimiter::rlp_Coalesce) );
+  REQUIRE( Limiter.GetStatistics(130312L)==0 );
+
+  SECTION("burst and refill") {
+    for (int i=0; i<3; i++) REQUIRE( Limiter.Check(127250L,1,Now,Limit)==tN2kRateLimiter::rlr_Pass );
+    REQUIRE( Limiter.Check(127250L,1,Now,Limit)==tN2kRateLimiter::rlr_Drop );
+    REQUIRE( Limiter.Check(127250L,2,Now,Limit)==tN2kRateLimiter::rlr_Pass ); // Own bucket per source
+    REQUIRE( Limiter.Check(127250L,1,Now+99,Limit)==tN2kRateLimiter::rlr_Drop );
+    REQUIRE( Limiter.Check(127250L,1,Now+100,Limit)==tN2kRateLimiter::rlr_Pass );
+    REQUIRE( Limiter.Check(127250L,1,Now+100,Limit)==tN2kRateLimiter::rlr_Drop );
+
+    // Long pause gives only burst
+    Now+=100000;
+    int Passed=0;
+    for (int i=0; i<10; i++) if ( Limiter.Check(127250L,1,Now,Limit)==tN2kRateLimiter::rlr_Pass ) Passed++;
+    REQUIRE( Passed==3 );
+
+    // Steady rate over limit passes at limit
+    Passed=0;
+    for (int i=0; i<1000; i++) if ( Limiter.Check(127250L,1,Now+10*i,Limit)==tN2kRateLimiter::rlr_Pass ) Passed++;
+    REQUIRE( Passed==99 ); // Bucket was emptied by burst above
+
+    const tN2kRateLimiter::tStatistics *Statistics=Limiter.GetStatistics(127250L);
+    REQUIRE( Statistics!=0 );
+    REQUIRE( Statistics->Passed==3+1+1+3+99 );
+    REQUIRE( Statistics->Dropped==1+1+1+7+901 );
+  }
+
+  SECTION("coalesce policy") {
+    REQUIRE( Limiter.Check(129029L,1,Now,Limit)==tN2kRateLimiter::rlr_Pass );
+    REQUIRE( Limiter.Check(129029L,1,Now+10,Limit)==tN2kRateLimiter::rlr_Coalesce );
+    Limiter.CountCoalesced(Limit,true);
+    REQUIRE( Limiter.Check(129029L,1,Now+20,Limit)==tN2kRateLimiter::rlr_Coalesce );
+    Limiter.CountCoalesced(Limit,false);
+    REQUIRE( Limiter.GetStatistics(129029L)->Coalesced==1 );
+    REQUIRE( Limiter.GetStatistics(129029L)->Dropped==1 );
+  }
+
+  SECTION("limit removal and full tables") {
+    REQUIRE( Limiter.SetLimit(127250L,0) );
+    for (int i=0; i<10; i++) REQUIRE( Limiter.Check(127250L,1,Now,Limit)==tN2kRateLimiter::rlr_Pass );
+    REQUIRE( Limiter.SetLimit(130312L,100) );
+    REQUIRE( Limiter.SetLimit(130310L,100) );
+    REQUIRE( !Limiter.SetLimit(130311L,100) ); // 4 limits
+
+    // Sources without bucket are not limited
+    for (unsigned char Source=0; Source<20; Source++) Limiter.Check(130312L,Source,Now,Limit);
+    REQUIRE( Limiter.GetTableFull()>0 );
+  }
+}
@@ -0,0 +1,151 @@
+/*
+  The MIT License
+
+  Copyright (c) 2017 Thomas Sarlandie thomas@sarlandie.net
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <catch.hpp>
+#include <NMEA2000.h>
+#include <string.h>
+
+extern uint32_t TestMillis;
+
+// Driver giving frames added by test.
+class tNMEA2000_frames : public tNMEA2000 {
+protected:
+  tN2kCANFrame Queue[64];
+  int QueueHead;
+  int QueueTail;
+
+  bool CANSendFrame(unsigned long, unsigned char, const unsigned char *, bool) { return true; }
+  bool CANOpen() { return true; }
+  bool CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf) {
+    if ( QueueHead==QueueTail ) return false;
+    id=Queue[QueueHead].id;
+    len=Queue[QueueHead].len;
+    memcpy(buf,Queue[QueueHead].buf,8);
+    QueueHead++;
+    return true;
+  }
+
+public:
+  tNMEA2000_frames() : QueueHead(0), QueueTail(0) {}
+  // Adds fast packet frame of 43 byte message. Frame 0 is first frame.
+  void AddFastPacketFrame(unsigned long PGN, unsigned char Source, unsigned char Sequence, unsigned char Frame) {
+    tN2kCANFrame &CANFrame=Queue[QueueTail++];
+    CANFrame.id=(3UL<<26) | (PGN<<8) | Source;
+    CANFrame.len=8;
+    memset(CANFrame.buf,0xff,8);
+    CANFrame.buf[0]=(Sequence<<5) | Frame;
+    if ( Frame==0 ) CANFrame.buf[1]=43;
+  }
+  void AddFastPacket(unsigned long PGN, unsigned char Source, unsigned char Sequence) {
+    for (unsigned char i=0; i<7; i++) AddFastPacketFrame(PGN,Source,Sequence,i);
+  }
+  void Parse() {
+    ParseMessages();
+    QueueHead=QueueTail=0;
+  }
+};
+
+static int HandledMsgs;
+static void CountMsg(const tN2kMsg &) { HandledMsgs++; }
+
+TEST_CASE("Receive path statistics", "[rxstatistics]") {
+  tNMEA2000_frames N2k;
+  HandledMsgs=0;
+  N2k.SetMsgHandler(CountMsg);
+  N2k.SetMaxReadFramesOnParse(0);
+  N2k.SetRxStatisticsSize(4,true);
+  const tNMEA2000::tRxStatistics &Stats=N2k.GetRxStatistics();
+
+  SECTION("complete messages have no events") {
+    N2k.AddFastPacket(129029L,10,1);
+    N2k.AddFastPacket(129029L,11,1);
+    N2k.Parse();
+    REQUIRE( HandledMsgs==2 );
+    for (int i=0; i<tNMEA2000::rxe_Count; i++) REQUIRE( Stats.Events[i]==0 );
+    REQUIRE( Stats.SlotsInUse==0 );
+    REQUIRE( Stats.MaxSlotsInUse==1 );
+  }
+
+  SECTION("orphan and lost frames") {
+    N2k.AddFastPacketFrame(129029L,10,1,3); // Orphan
+    N2k.AddFastPacketFrame(129029L,11,2,0);
+    N2k.AddFastPacketFrame(129029L,11,2,2); // Frame 1 lost
+    N2k.AddFastPacketFrame(129029L,11,2,3); // Orphan after lost
+    N2k.Parse();
+    REQUIRE( HandledMsgs==0 );
+    REQUIRE( Stats.Events[tNMEA2000::rxe_OrphanFrame]==2 );
+    REQUIRE( Stats.Events[tNMEA2000::rxe_LostFrame]==1 );
+    REQUIRE( N2k.GetRxSourceEvents(10)[tNMEA2000::rxe_OrphanFrame]==1 );
+    REQUIRE( N2k.GetRxSourceEvents(11)[tNMEA2000::rxe_OrphanFrame]==1 );
+    REQUIRE( N2k.GetRxSourceEvents(11)[tNMEA2000::rxe_LostFrame]==1 );
+    REQUIRE( N2k.GetRxSourceEvents(12)[tNMEA2000::rxe_LostFrame]==0 );
+
+    uint8_t Count;
+    const tNMEA2000::tRxPGNStatistics *PGNStats=N2k.GetRxPGNStatistics(Count);
+    REQUIRE( Count==1 );
+    REQUIRE( PGNStats[0].PGN==129029L );
+    REQUIRE( PGNStats[0].Events[tNMEA2000::rxe_OrphanFrame]==2 );
+
+    N2k.ResetRxStatistics();
+    REQUIRE( Stats.Events[tNMEA2000::rxe_OrphanFrame]==0 );
+    N2k.GetRxPGNStatistics(Count);
+    REQUIRE( Count==0 );
+    REQUIRE( N2k.GetRxSourceEvents(10)[tNMEA2000::rxe_OrphanFrame]==0 );
+  }
+
+  SECTION("restart, eviction and full buffer") {
+    N2k.SetN2kCANMsgBufSize(3);
+    N2k.AddFastPacketFrame(129029L,10,1,0);
+    N2k.AddFastPacketFrame(129029L,10,2,0); // Restart
+    N2k.AddFastPacketFrame(129029L,11,1,0);
+    N2k.AddFastPacketFrame(129029L,12,1,0);
+    N2k.AddFastPacketFrame(129029L,13,1,0); // No free slot
+    N2k.Parse();
+    REQUIRE( Stats.Events[tNMEA2000::rxe_Restart]==1 );
+    REQUIRE( Stats.Events[tNMEA2000::rxe_NoFreeSlot]==1 );
+    REQUIRE( Stats.SlotsInUse==3 );
+    REQUIRE( Stats.MaxSlotsInUse==3 );
+    REQUIRE( N2k.GetRxSourceEvents(13)[tNMEA2000::rxe_NoFreeSlot]==1 );
+
+    TestMillis+=Max_N2kMsgBuf_Time+1;
+    N2k.AddFastPacket(129038L,14,1); // Evicts oldest
+    N2k.Parse();
+    REQUIRE( HandledMsgs==1 );
+    REQUIRE( Stats.Events[tNMEA2000::rxe_Eviction]==1 );
+    REQUIRE( N2k.GetRxSourceEvents(10)[tNMEA2000::rxe_Eviction]==1 );
+    REQUIRE( Stats.SlotsInUse==2 );
+  }
+
+  SECTION("per PGN table overflow") {
+    unsigned long PGNs[]={129029L,129038L,129039L,129540L,129794L,129809L};
+    for (int i=0; i<6; i++) N2k.AddFastPacketFrame(PGNs[i],10,1,2);
+    N2k.Parse();
+    uint8_t Count;
+    N2k.GetRxPGNStatistics(Count);
+    REQUIRE( Count==4 );
+    REQUIRE( Stats.Events[tNMEA2000::rxe_OrphanFrame]==6 );
+    REQUIRE( Stats.UntrackedPGNEvents==2 );
+  }
+}
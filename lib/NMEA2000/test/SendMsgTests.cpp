@@ -0,0 +1,439 @@
+/*
+  The MIT License
+
+  Copyright (c) 2017 Thomas Sarlandie thomas@sarlandie.net
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <catch.hpp>
+#include <NMEA2000.h>
+#include <N2kMessages.h>
+#include <vector>
+#include <string>
+#include <string.h>
+
+extern uint32_t TestMillis;
+
+// Driver accepting only Room frames until test frees room.
+class tNMEA2000_tx : public tNMEA2000 {
+protected:
+  bool CANSendFrame(unsigned long id, unsigned char len, const unsigned char *buf, bool) {
+    if ( Room==0 ) return false;
+    Room--;
+    tN2kCANFrame Frame;
+    Frame.id=id;
+    Frame.len=len;
+    for (int i=0; i<len; i++) Frame.buf[i]=buf[i];
+    Sent.push_back(Frame);
+    return true;
+  }
+  bool CANOpen() { return true; }
+  bool CANGetFrame(unsigned long &, unsigned char &, unsigned char *) { return false; }
+
+public:
+  int Room;
+  std::vector<tN2kCANFrame> Sent;
+  tNMEA2000_tx() : Room(1000) {}
+  bool Flush() { return SendFrames(); }
+};
+
+TEST_CASE("Fast packet is queued as whole or rejected", "[sendmsg]") {
+  tNMEA2000_tx N2k;
+  N2k.SetN2kCANSendFrameBufSize(14);
+  N2k.SetMode(tNMEA2000::N2km_NodeOnly,22);
+  N2k.Open();
+  TestMillis+=300; // Address claim done
+  N2k.ParseMessages();
+  N2k.Sent.clear();
+
+  tN2kMsg N2kMsg;
+  SetN2kGNSS(N2kMsg,1,17800,43200.0,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9); // 43 bytes, 7 frames
+
+  N2k.Room=3;
+  REQUIRE( N2k.SendMsg(N2kMsg) ); // 3 sent, 4 buffered
+  REQUIRE( N2k.Sent.size()==3 );
+  REQUIRE( N2k.SendMsg(N2kMsg) ); // 11 buffered in total
+  REQUIRE( !N2k.SendMsg(N2kMsg) ); // Only 3 places left
+  REQUIRE( N2k.Sent.size()==3 );
+
+  N2k.Room=1000;
+  REQUIRE( N2k.Flush() );
+  REQUIRE( N2k.Sent.size()==14 );
+
+  // Frames are complete messages with consecutive sequence counters
+  for (size_t i=0; i<N2k.Sent.size(); i++) {
+    REQUIRE( (N2k.Sent[i].buf[0] & 0x1f)==i%7 );
+    REQUIRE( (N2k.Sent[i].buf[0]>>5)==(((N2k.Sent[0].buf[0]>>5)+i/7) & 7) );
+  }
+
+  SECTION("rejected message does not use sequence counter") {
+    N2k.Room=0;
+    REQUIRE( N2k.SendMsg(N2kMsg) );
+    REQUIRE( N2k.SendMsg(N2kMsg) );
+    REQUIRE( !N2k.SendMsg(N2kMsg) );
+    N2k.Room=1000;
+    REQUIRE( N2k.SendMsg(N2kMsg) );
+    REQUIRE( N2k.Sent.size()==35 );
+    REQUIRE( (N2k.Sent[34].buf[0]>>5)==(((N2k.Sent[0].buf[0]>>5)+4) & 7) );
+  }
+}
+
+TEST_CASE("Fast packet longer than send buffer is rejected", "[sendmsg]") {
+  tNMEA2000_tx N2k;
+  N2k.SetN2kCANSendFrameBufSize(5);
+  N2k.SetMode(tNMEA2000::N2km_NodeOnly,22);
+  N2k.Open();
+  TestMillis+=300; // Address claim done
+  N2k.ParseMessages();
+  N2k.Sent.clear();
+
+  tN2kMsg N2kMsg;
+  SetN2kGNSS(N2kMsg,1,17800,43200.0,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9); // 43 bytes, 7 frames
+
+  N2k.Room=3;
+  REQUIRE( !N2k.SendMsg(N2kMsg) );
+  REQUIRE( N2k.Sent.size()==0 );
+  N2k.Room=1000;
+  REQUIRE( !N2k.SendMsg(N2kMsg) ); // Even driver would accept all
+  REQUIRE( N2k.Sent.size()==0 );
+
+  SetN2kTrueHeading(N2kMsg,1,0.5);
+  REQUIRE( N2k.SendMsg(N2kMsg) );
+  REQUIRE( N2k.Sent.size()==1 );
+}
+
+TEST_CASE("Send queue honors CAN priority", "[sendmsg]") {
+  tNMEA2000_tx N2k;
+  N2k.SetN2kCANSendFrameBufSize(40);
+  N2k.SetMode(tNMEA2000::N2km_NodeOnly,22);
+  N2k.Open();
+  TestMillis+=300; // Address claim done
+  N2k.ParseMessages();
+  N2k.Sent.clear();
+  N2k.ResetSendStatistics();
+
+  tN2kMsg GNSS, Heading, Temperature;
+  SetN2kGNSS(GNSS,1,17800,43200.0,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9); // Priority 6
+  SetN2kTrueHeading(Heading,1,0.5); // Priority 2
+  SetN2kTemperature(Temperature,1,1,N2kts_MainCabinTemperature,293.0); // Priority 5
+
+  SECTION("higher priority first") {
+    N2k.Room=0;
+    REQUIRE( N2k.SendMsg(GNSS) );
+    for (int i=0; i<5; i++) REQUIRE( N2k.SendMsg(Temperature) );
+    REQUIRE( N2k.SendMsg(Heading) );
+    TestMillis+=5;
+    N2k.Room=1000;
+    REQUIRE( N2k.Flush() );
+    REQUIRE( N2k.Sent.size()==13 );
+    REQUIRE( ((N2k.Sent[0].id>>8) & 0x1ffff)==127250L );
+    for (int i=1; i<6; i++) REQUIRE( ((N2k.Sent[i].id>>8) & 0x1ffff)==130312L );
+    for (int i=6; i<13; i++) REQUIRE( ((N2k.Sent[i].id>>8) & 0x1ffff)==129029L );
+    REQUIRE( N2k.GetSendStatistics(5).QueuedFrames==5 );
+    REQUIRE( N2k.GetSendStatistics(5).MaxQueued==5 );
+    REQUIRE( N2k.GetSendStatistics(5).MaxDelay==5 );
+    REQUIRE( N2k.GetSendStatistics(5).TotalDelay==25 );
+    REQUIRE( N2k.GetSendStatistics(2).Frames==1 );
+    REQUIRE( N2k.GetSendStatistics(6).Frames==7 );
+  }
+
+  SECTION("fast packet frames stay together") {
+    N2k.Room=1;
+    REQUIRE( N2k.SendMsg(GNSS) ); // First frame sent, 6 queued
+    REQUIRE( N2k.SendMsg(Heading) );
+    N2k.Room=1000;
+    REQUIRE( N2k.Flush() );
+    REQUIRE( N2k.Sent.size()==8 );
+    for (int i=0; i<7; i++) {
+      REQUIRE( ((N2k.Sent[i].id>>8) & 0x1ffff)==129029L );
+      REQUIRE( (N2k.Sent[i].buf[0] & 0x1f)==i );
+    }
+    REQUIRE( ((N2k.Sent[7].id>>8) & 0x1ffff)==127250L );
+
+    // Lock is released after last frame
+    N2k.Room=0;
+    REQUIRE( N2k.SendMsg(Temperature) );
+    REQUIRE( N2k.SendMsg(Heading) );
+    N2k.Room=1000;
+    REQUIRE( N2k.Flush() );
+    REQUIRE( ((N2k.Sent[8].id>>8) & 0x1ffff)==127250L );
+  }
+}
+
+const unsigned long CoalescedMessages[] PROGMEM={127250L,129029L,0};
+
+TEST_CASE("Queued periodic messages are coalesced", "[sendmsg]") {
+  tNMEA2000_tx N2k;
+  N2k.SetN2kCANSendFrameBufSize(40);
+  N2k.SetMode(tNMEA2000::N2km_NodeOnly,22);
+  N2k.SetCoalescedMessages(CoalescedMessages);
+  N2k.Open();
+  TestMillis+=300; // Address claim done
+  N2k.ParseMessages();
+  N2k.Sent.clear();
+  N2k.ResetSendStatistics();
+
+  tN2kMsg N2kMsg;
+  N2k.Room=0;
+  for (int i=0; i<10; i++) {
+    SetN2kTrueHeading(N2kMsg,i,0.1*i);
+    REQUIRE( N2k.SendMsg(N2kMsg) );
+    SetN2kGNSS(N2kMsg,i,17800,43200.0+i,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+    REQUIRE( N2k.SendMsg(N2kMsg) );
+    SetN2kTemperature(N2kMsg,i,1,N2kts_MainCabinTemperature,293.0); // Not coalesced
+    REQUIRE( N2k.SendMsg(N2kMsg) );
+  }
+  REQUIRE( N2k.GetSendStatistics(2).Coalesced==9 );
+  REQUIRE( N2k.GetSendStatistics(6).Coalesced==9 );
+  REQUIRE( N2k.GetSendStatistics(6).MaxQueued==7 );
+
+  N2k.Room=1000;
+  REQUIRE( N2k.Flush() );
+  REQUIRE( N2k.Sent.size()==1+10+7 );
+  REQUIRE( N2k.Sent[0].buf[0]==9 ); // Latest heading SID
+  tN2kMsg Expected;
+  SetN2kGNSS(Expected,9,17800,43200.0+9,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+  REQUIRE( N2k.Sent[11].buf[1]==Expected.DataLen );
+  REQUIRE( memcmp(&N2k.Sent[11].buf[2],Expected.Data,6)==0 );
+  REQUIRE( memcmp(&N2k.Sent[12].buf[1],Expected.Data+6,7)==0 );
+  for (int i=11; i<18; i++) REQUIRE( N2k.Sent[i].buf[0]==(N2k.Sent[11].buf[0] & 0xe0)+i-11 );
+
+  SECTION("started fast packet is not replaced") {
+    N2k.Room=1;
+    REQUIRE( N2k.SendMsg(N2kMsg) ); // Temperature
+    N2k.Room=0;
+    SetN2kGNSS(N2kMsg,20,17800,43200.0,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+    REQUIRE( N2k.SendMsg(N2kMsg) );
+    N2k.Room=1;
+    REQUIRE( N2k.Flush()==false ); // First frame of GNSS sent
+    SetN2kGNSS(N2kMsg,21,17800,43200.0,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+    REQUIRE( N2k.SendMsg(N2kMsg) ); // Queued after first
+    N2k.Room=1000;
+    REQUIRE( N2k.Flush() );
+    REQUIRE( N2k.Sent.size()==18+1+14 );
+    REQUIRE( N2k.Sent[19].buf[2]==20 );
+    REQUIRE( N2k.Sent[26].buf[2]==21 );
+  }
+}
+
+TEST_CASE("Send rate limit", "[sendmsg]") {
+  tNMEA2000_tx N2k;
+  N2k.SetMode(tNMEA2000::N2km_NodeOnly,22);
+  N2k.Open();
+  TestMillis+=300; // Address claim done
+  N2k.ParseMessages();
+  N2k.Sent.clear();
+  REQUIRE( N2k.SetSendRateLimit(127250L,100,2) );
+  REQUIRE( N2k.SetSendRateLimit(129029L,1000,1,tN2kRateLimiter::rlp_Coalesce) );
+
+  tN2kMsg N2kMsg;
+  SetN2kTrueHeading(N2kMsg,1,0.5);
+  REQUIRE( N2k.SendMsg(N2kMsg) );
+  REQUIRE( N2k.SendMsg(N2kMsg) );
+  REQUIRE( !N2k.SendMsg(N2kMsg) );
+  TestMillis+=100;
+  REQUIRE( N2k.SendMsg(N2kMsg) );
+  REQUIRE( N2k.Sent.size()==3 );
+
+  N2k.Room=0;
+  SetN2kGNSS(N2kMsg,1,17800,43200.0,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+  REQUIRE( N2k.SendMsg(N2kMsg) ); // Queued
+  SetN2kGNSS(N2kMsg,2,17800,43200.0,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+  REQUIRE( N2k.SendMsg(N2kMsg) ); // Over limit, coalesced
+  N2k.Room=1000;
+  REQUIRE( N2k.Flush() );
+  REQUIRE( N2k.Sent.size()==3+7 );
+  REQUIRE( N2k.Sent[3].buf[2]==2 );
+  REQUIRE( !N2k.SendMsg(N2kMsg) ); // Over limit, nothing to coalesce
+
+  const tN2kRateLimiter::tStatistics *Statistics=N2k.GetSendRateLimiter()->GetStatistics(129029L);
+  REQUIRE( Statistics->Passed==1 );
+  REQUIRE( Statistics->Coalesced==1 );
+  REQUIRE( Statistics->Dropped==1 );
+}
+
+TEST_CASE("Scheduled send", "[sendmsg]") {
+  tNMEA2000_tx N2k;
+  N2k.SetN2kCANSendFrameBufSize(7);
+  N2k.SetScheduledMsgBufSize(3);
+  N2k.SetMode(tNMEA2000::N2km_NodeOnly,22);
+  N2k.Open();
+  TestMillis+=300; // Address claim done
+  N2k.ParseMessages();
+  N2k.Sent.clear();
+
+  tN2kMsg N2kMsg;
+  SetN2kGNSS(N2kMsg,1,17800,43200.0,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9); // 7 frames
+  REQUIRE( N2k.SendMsgAt(N2kMsg,TestMillis+100) );
+  SetN2kTrueHeading(N2kMsg,1,0.5);
+  REQUIRE( N2k.SendMsgAt(N2kMsg,TestMillis+100) );
+  REQUIRE( N2k.SendMsgAt(N2kMsg,TestMillis+50) );
+  REQUIRE( !N2k.SendMsgAt(N2kMsg,TestMillis+50) );
+
+  TestMillis+=49;
+  N2k.ParseMessages();
+  REQUIRE( N2k.Sent.size()==0 );
+  TestMillis+=1;
+  N2k.ParseMessages();
+  REQUIRE( N2k.Sent.size()==1 );
+
+  // GNSS fills send buffer, so heading has to wait
+  N2k.Room=0;
+  TestMillis+=60;
+  N2k.ParseMessages();
+  INFO( N2k.GetMsgScheduler()->GetStatistics().Failed << " " << N2k.GetMsgScheduler()->GetStatistics().InUse );
+  REQUIRE( N2k.GetMsgScheduler()->GetStatistics().Sent==2 );
+  REQUIRE( N2k.GetMsgScheduler()->GetStatistics().InUse==1 );
+  N2k.Room=1000;
+  TestMillis+=5;
+  N2k.ParseMessages();
+  REQUIRE( N2k.Sent.size()==1+7+1 );
+  REQUIRE( (N2k.Sent[8].id & 0x1ffff00)==(127250L<<8) );
+
+  const tN2kMsgScheduler::tStatistics &Statistics=N2k.GetMsgScheduler()->GetStatistics();
+  REQUIRE( Statistics.Sent==3 );
+  REQUIRE( Statistics.Failed==0 );
+  REQUIRE( Statistics.Rejected==1 );
+  REQUIRE( Statistics.MaxLateness==15 );
+}
+
+TEST_CASE("Scheduled TP message needs room for one frame", "[sendmsg]") {
+  tNMEA2000_tx N2k;
+  N2k.SetN2kCANSendFrameBufSize(7);
+  N2k.SetScheduledMsgBufSize(3);
+  N2k.SetMode(tNMEA2000::N2km_NodeOnly,22);
+  N2k.Open();
+  TestMillis+=300; // Address claim done
+  N2k.ParseMessages();
+  N2k.Sent.clear();
+
+  tN2kMsg N2kMsg;
+  N2kMsg.SetPGN(130816L);
+  N2kMsg.Priority=7;
+  for (int i=0; i<200; i++) N2kMsg.AddByte(i); // 29 frames as fast packet, 29 TP data frames
+  N2kMsg.SetIsTPMessage();
+  REQUIRE( N2k.SendMsgAt(N2kMsg,TestMillis+10) );
+  SetN2kTrueHeading(N2kMsg,1,0.5);
+  REQUIRE( N2k.SendMsgAt(N2kMsg,TestMillis+10) );
+
+  TestMillis+=10;
+  N2k.ParseMessages();
+  REQUIRE( N2k.GetMsgScheduler()->GetStatistics().Sent==2 );
+  REQUIRE( N2k.Sent.size()>=2 );
+  REQUIRE( ((N2k.Sent[0].id>>8) & 0x1ff00)==0xEC00 ); // TP.CM BAM
+  REQUIRE( ((N2k.Sent[1].id>>8) & 0x1ffff)==127250L );
+}
+
+class tStringStream : public N2kStream {
+public:
+  std::string Text;
+  int read() { return -1; }
+  size_t write(const uint8_t* data, size_t size) { Text.append((const char *)data,size); return size; }
+};
+
+TEST_CASE("Send latency tracing", "[sendmsg]") {
+  tNMEA2000_tx N2k;
+  N2k.SetMode(tNMEA2000::N2km_NodeOnly,22);
+  N2k.Open();
+  TestMillis+=300; // Address claim done
+  N2k.ParseMessages();
+  REQUIRE( N2k.GetTxPriorityLatency(2)==0 );
+  N2k.SetTxLatencyTracing(2,3);
+
+  tN2kMsg N2kMsg;
+  SetN2kTrueHeading(N2kMsg,1,0.5);
+  REQUIRE( N2k.SendMsg(N2kMsg) ); // Directly to driver
+  N2k.Room=0;
+  REQUIRE( N2k.SendMsg(N2kMsg) );
+  SetN2kGNSS(N2kMsg,1,17800,43200.0,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+  REQUIRE( N2k.SendMsg(N2kMsg) );
+  TestMillis+=5;
+  SetN2kTemperature(N2kMsg,1,1,N2kts_SeaTemperature,290.0);
+  REQUIRE( N2k.SendMsg(N2kMsg) );
+  TestMillis+=20;
+  N2k.Room=1000;
+  REQUIRE( N2k.Flush() );
+
+  const tNMEA2000::tTxLatencyHistogram *Heading=N2k.GetTxPriorityLatency(2);
+  REQUIRE( Heading!=0 );
+  REQUIRE( Heading->Count[0]==1 );
+  REQUIRE( Heading->Count[5]==1 ); // 25 ms
+  REQUIRE( Heading->MaxLatency==25 );
+  const tNMEA2000::tTxLatencyHistogram *GNSS=N2k.GetTxPriorityLatency(6);
+  REQUIRE( GNSS->Count[5]==1 ); // Counted once for 7 frames
+  REQUIRE( N2k.GetTxPriorityLatency(5)->Count[5]==1 ); // 20 ms
+
+  uint8_t Count;
+  const tNMEA2000::tTxPGNLatency *PGNs=N2k.GetTxPGNLatency(Count);
+  REQUIRE( Count==2 ); // Only first 2 PGNs
+  REQUIRE( PGNs[0].PGN==127250L );
+  REQUIRE( PGNs[1].PGN==130312L ); // Sent before GNSS by priority
+
+  const tNMEA2000::tTxLatencyTrace *Slowest=N2k.GetTxSlowest(Count);
+  REQUIRE( Count==3 );
+  uint16_t Sum=0;
+  for (int i=0; i<3; i++) Sum+=Slowest[i].Latency;
+  REQUIRE( Sum==25+25+20 );
+
+  tStringStream Out;
+  N2k.PrintTxLatency(&Out);
+  size_t Heading25=Out.Text.find("Slow PGN 127250 priority 2 source 22 latency 25");
+  size_t Temperature=Out.Text.find("Slow PGN 130312 priority 5 source 22 latency 20");
+  REQUIRE( Heading25!=std::string::npos );
+  REQUIRE( Temperature!=std::string::npos );
+  REQUIRE( Heading25<Temperature );
+  REQUIRE( Out.Text.find("Priority 2: 1 0 0 0 0 1 0 0 0 0 max 25")!=std::string::npos );
+
+  // New slower message replaces fastest trace
+  N2k.Room=0;
+  SetN2kTrueHeading(N2kMsg,1,0.5);
+  REQUIRE( N2k.SendMsg(N2kMsg) );
+  TestMillis+=300;
+  N2k.Room=1000;
+  REQUIRE( N2k.Flush() );
+  Slowest=N2k.GetTxSlowest(Count);
+  Sum=0;
+  for (int i=0; i<3; i++) Sum+=Slowest[i].Latency;
+  REQUIRE( Sum==300+25+25 );
+  REQUIRE( N2k.GetTxPriorityLatency(2)->Count[9]==1 );
+}
+
+TEST_CASE("Fast packet sequence counter per PGN", "[sendmsg]") {
+  tNMEA2000_tx N2k;
+  N2k.SetMode(tNMEA2000::N2km_NodeOnly,22);
+  N2k.Open();
+  TestMillis+=300; // Address claim done
+  N2k.ParseMessages();
+
+  // PGNs outside transmit list get own counters too
+  tN2kMsg N2kMsg;
+  for (int Round=0; Round<10; Round++) {
+    for (unsigned long PGN=130816L; PGN<130816L+100; PGN++) {
+      N2kMsg.Clear();
+      N2kMsg.SetPGN(PGN);
+      for (int i=0; i<20; i++) N2kMsg.AddByte(i);
+      N2k.Sent.clear(); N2k.Room=1000;
+      REQUIRE( N2k.SendMsg(N2kMsg) );
+      REQUIRE( N2k.Sent.size()==3 );
+      for (size_t i=0; i<N2k.Sent.size(); i++) REQUIRE( (N2k.Sent[i].buf[0]>>5)==Round%8 );
+    }
+  }
+}
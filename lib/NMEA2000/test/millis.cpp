@@ -24,11 +24,18 @@
 
 #include <stdint.h>
 
+// Tests needing time to pass can change this
+uint32_t TestMillis=42;
+
 extern "C" {
 
 // So that millis() work
 uint32_t millis() {
-  return 42;
+  return TestMillis;
+}
+
+// Open() waits before address claim, which tests do not need
+void delay(uint32_t) {
 }
 
 }
@@ -36,6 +36,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 
 */
+#include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
@@ -89,11 +90,11 @@ static uint8_t nmea_compute_checksum(const char *sentence) {
  */
 static bool readNHexByte(const char *s, unsigned int n, uint32_t &value) {
   if (strlen(s) < 2*n) {
-    return -1;
+    return false;
   }
   for (unsigned int i = 0; i < 2*n; i++) {
     if (!isxdigit(s[i])) {
-      return -1;
+      return false;
     }
   }
 
@@ -117,7 +118,7 @@ size_t N2kToSailmax(const tN2kMsg &msg, uint32_t timestamp, char *buffer, size_t
   }
 
   char *s = buffer;
-  sprintf(s, "@%lu,",timestamp );
+  sprintf(s, "@%lu,",(unsigned long)timestamp );
 
   s += digits + 2;
   sprintf(s,"%06lu,",msg.PGN );
@@ -150,6 +151,9 @@ bool SailmaxToN2k(const char *buffer, uint32_t &timestamp, tN2kMsg &msg) {
 
     timestamp = 0;
     while (s[i] != ',') {
+      if (!isdigit(s[i])) {
+        return false;
+      }
       timestamp = timestamp * 10 + ((int)s[i] - 48);
       i++;
     }
@@ -159,6 +163,9 @@ bool SailmaxToN2k(const char *buffer, uint32_t &timestamp, tN2kMsg &msg) {
     // the next 6 chars are the PGN (N2k page number)
     msg.PGN = 0;
     while (s[i] != ',') {
+      if (!isdigit(s[i])) {
+        return false;
+      }
       msg.PGN = msg.PGN * 10 + ((int)s[i] - 48);
       i++;
     }
@@ -170,6 +177,9 @@ bool SailmaxToN2k(const char *buffer, uint32_t &timestamp, tN2kMsg &msg) {
       return false;
     }
     msg.Source = source;
+    if (s[2] != ',') {
+      return false;
+    }
 
     s += 3;
     int dataLen = 0;
@@ -195,16 +205,23 @@ bool SailmaxToN2k(const char *buffer, uint32_t &timestamp, tN2kMsg &msg) {
       s += 2;
     }
 
+    if (*s != '*') {
+      return false;
+    }
     s += 1;
     uint32_t checksum;
     //Serial.printf("checksum s: %s\n", s);
     if (!readNHexByte(s, 1, checksum)) {
+#if defined(ARDUINO)
       Serial.printf("readNHexByte nicht ok \n");
+#endif
       return false;
     }
 
     if (checksum != nmea_compute_checksum(buffer)) {
+#if defined(ARDUINO)
       Serial.printf("nmea_compute_checksum nicht ok \n");
+#endif
       return false;
     }
 
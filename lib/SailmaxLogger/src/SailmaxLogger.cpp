@@ -0,0 +1,226 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, Sailmax Logger
+      * Purpose:  high rate logging of N2k messages in Sailmax format to SD-Card
+      * Author:   © Ronnie Zeiller, 2018
+      * The log file is preallocated as one contiguous area on the card and
+      * written block by block without going through the FAT file system.
+      * Same approach as the LowLatencyLogger example of SdFat.
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <string.h>
+#include <SailmaxFormat.h>
+#include "SailmaxLogger.h"
+
+// max number of blocks to erase per erase call
+static const uint32_t EraseSize=262144L;
+
+//*****************************************************************************
+tSailmaxLogger::tSailmaxLogger(uint16_t _BufferBlocks, uint16_t _MaxRunBlocks) {
+  pSd=0;
+  Buffer=0;
+  BufferBlocks=(_BufferBlocks>=2?_BufferBlocks:2);
+  MaxRunBlocks=(_MaxRunBlocks>=1?_MaxRunBlocks:1);
+  FirstBlock=0;
+  FileBlocks=0;
+  BlocksWritten=0;
+  BytesLogged=0;
+  FillBlock=0;
+  FillPos=0;
+  WriteBlock=0;
+  FullBlocks=0;
+  IsOpen=false;
+  ResetStatistics();
+}
+
+//*****************************************************************************
+tSailmaxLogger::~tSailmaxLogger() {
+  if ( IsOpen ) Close();
+  if ( Buffer!=0 ) delete[] Buffer;
+}
+
+//*****************************************************************************
+void tSailmaxLogger::ResetStatistics() {
+  LoggedMessages=0;
+  DroppedMessages=0;
+  WriteErrors=0;
+  MaxWriteLatency=0;
+  MinFreeBlocks=BufferBlocks;
+}
+
+//*****************************************************************************
+bool tSailmaxLogger::Open(SAILMAX_LOGGER_SD_CLASS &sd, const char *FileName, uint32_t _FileBlocks, bool Erase) {
+  uint32_t bgnBlock, endBlock;
+
+  if ( IsOpen ) Close();
+  if ( _FileBlocks==0 ) return false;
+
+  if ( Buffer==0 ) {
+    // Use 32 bit elements, since SDIO DMA requires aligned buffer.
+    Buffer=(uint8_t *)(new uint32_t[BufferBlocks*BlockSize/sizeof(uint32_t)]);
+    if ( Buffer==0 ) return false;
+  }
+
+  if ( sd.exists(FileName) && !sd.remove(FileName) ) return false;
+  LogFile.close();
+  if ( !LogFile.createContiguous(FileName, BlockSize*_FileBlocks) ) return false;
+  if ( !LogFile.contiguousRange(&bgnBlock,&endBlock) ) {
+    LogFile.close();
+    return false;
+  }
+
+  if ( Erase ) {
+    uint32_t bgnErase=bgnBlock;
+    uint32_t endErase;
+    while ( bgnErase<endBlock ) {
+      endErase=bgnErase+EraseSize;
+      if ( endErase>endBlock ) endErase=endBlock;
+      if ( !sd.card()->erase(bgnErase,endErase) ) {
+        LogFile.close();
+        return false;
+      }
+      bgnErase=endErase+1;
+    }
+  }
+
+  pSd=&sd;
+  FirstBlock=bgnBlock;
+  FileBlocks=_FileBlocks;
+  BlocksWritten=0;
+  BytesLogged=0;
+  FillBlock=0;
+  FillPos=0;
+  WriteBlock=0;
+  FullBlocks=0;
+  ResetStatistics();
+  IsOpen=true;
+
+  return true;
+}
+
+//*****************************************************************************
+bool tSailmaxLogger::Log(const tN2kMsg &msg, uint32_t timestamp) {
+  char Line[MaxLineLen];
+
+  if ( !IsOpen ) return false;
+
+  size_t len=N2kToSailmax(msg,timestamp,Line,sizeof(Line)-2);
+  if ( len==0 ) { DroppedMessages++; return false; }
+  Line[len++]='\r';
+  Line[len++]='\n';
+
+  size_t FreeBytes=(BufferBlocks-FullBlocks)*BlockSize-FillPos;
+  if ( len>FreeBytes || BytesLogged+len>FileBlocks*BlockSize ) {
+    DroppedMessages++;
+    return false;
+  }
+
+  // Copy line to ring. It may continue on next block.
+  const char *src=Line;
+  while ( len>0 ) {
+    size_t n=BlockSize-FillPos;
+    if ( n>len ) n=len;
+    memcpy(Buffer+FillBlock*BlockSize+FillPos,src,n);
+    src+=n;
+    len-=n;
+    FillPos+=n;
+    BytesLogged+=n;
+    if ( FillPos==BlockSize ) {
+      FullBlocks++;
+      FillBlock=(FillBlock+1)%BufferBlocks;
+      FillPos=0;
+      if ( BufferBlocks-FullBlocks<MinFreeBlocks ) MinFreeBlocks=BufferBlocks-FullBlocks;
+    }
+  }
+
+  LoggedMessages++;
+  return true;
+}
+
+//*****************************************************************************
+// Writes Blocks blocks starting from WriteBlock. Blocks must be continuous in RAM.
+bool tSailmaxLogger::WriteRun(uint16_t Blocks) {
+  uint32_t usec=micros();
+  bool result=pSd->card()->writeBlocks(FirstBlock+BlocksWritten,Buffer+WriteBlock*BlockSize,Blocks);
+  usec=micros()-usec;
+  if ( usec>MaxWriteLatency ) MaxWriteLatency=usec;
+  if ( !result ) WriteErrors++;
+  // On error we still skip blocks. Otherwise all following data would be lost.
+  WriteBlock=(WriteBlock+Blocks)%BufferBlocks;
+  FullBlocks-=Blocks;
+  BlocksWritten+=Blocks;
+
+  return result;
+}
+
+//*****************************************************************************
+void tSailmaxLogger::Service() {
+  if ( !IsOpen || FullBlocks==0 ) return;
+  if ( pSd->card()->isBusy() ) return;
+
+  uint16_t Blocks=FullBlocks;
+  if ( Blocks>BufferBlocks-WriteBlock ) Blocks=BufferBlocks-WriteBlock; // up to end of ring
+  if ( Blocks>MaxRunBlocks ) Blocks=MaxRunBlocks;
+  WriteRun(Blocks);
+}
+
+//*****************************************************************************
+bool tSailmaxLogger::Close() {
+  if ( !IsOpen ) return false;
+
+  bool result=(WriteErrors==0);
+  while ( FullBlocks>0 ) {
+    uint16_t Blocks=FullBlocks;
+    if ( Blocks>BufferBlocks-WriteBlock ) Blocks=BufferBlocks-WriteBlock;
+    result&=WriteRun(Blocks);
+  }
+  if ( FillPos>0 ) {
+    // Write last partial block. Rest will be cut by truncate.
+    memset(Buffer+FillBlock*BlockSize+FillPos,0,BlockSize-FillPos);
+    FullBlocks=1;
+    result&=WriteRun(1);
+    FillPos=0;
+  }
+
+  result&=LogFile.truncate(BytesLogged);
+  result&=LogFile.close();
+  IsOpen=false;
+
+  return result;
+}
+
+//*****************************************************************************
+void tSailmaxLogger::PrintStatistics(Print &out) {
+  out.print(F("Logged messages: ")); out.println(LoggedMessages);
+  out.print(F("Dropped messages: ")); out.println(DroppedMessages);
+  out.print(F("Write errors: ")); out.println(WriteErrors);
+  out.print(F("Max block write usec: ")); out.println(MaxWriteLatency);
+  out.print(F("Min free buffers: ")); out.println(MinFreeBlocks);
+  out.print(F("Bytes logged: ")); out.println(BytesLogged);
+}
@@ -0,0 +1,153 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, Sailmax Logger
+      * Purpose:  high rate logging of N2k messages in Sailmax format to SD-Card
+      * Author:   © Ronnie Zeiller, 2018
+      * The log file is preallocated as one contiguous area on the card and
+      * written block by block without going through the FAT file system.
+      * Same approach as the LowLatencyLogger example of SdFat.
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _SailmaxLogger_h_
+#define _SailmaxLogger_h_
+
+#include <Arduino.h>
+#include <SdFat.h>
+#include <NMEA2000.h>
+#include <N2kMsg.h>
+
+// File system class used by the logger. Teensy 3.6 uses the built in SDIO slot,
+// define SAILMAX_LOGGER_SD_CLASS as SdFat for an SPI card.
+#ifndef SAILMAX_LOGGER_SD_CLASS
+#define SAILMAX_LOGGER_SD_CLASS SdFatSdio
+#endif
+
+/**
+ *  Logs N2k messages as Sailmax sentences (@timestamp,PGN,Source,Data*checksum\r\n)
+ *  into a preallocated contiguous file.
+ *
+ *  Log() only formats the sentence into a RAM ring of 512 byte blocks, so it is
+ *  cheap enough to be called for every message of a fully loaded bus.
+ *  Sentences are written as a continuous byte stream and may span blocks.
+ *  Service() must be called frequently from loop(). It writes all complete
+ *  blocks which are continuous in RAM with one multi block write directly to
+ *  the card, but only if the card is not busy.
+ *
+ *  If the ring is full, the message is dropped and counted. The worst write
+ *  latency tells how many buffer blocks are needed to survive the card's
+ *  housekeeping pauses: BufferBlocks*512 > bus byte rate * max latency.
+ */
+class tSailmaxLogger {
+public:
+  static const size_t BlockSize=512;
+  static const size_t MaxLineLen=480; // '@'+10+','+6+','+2+','+2*223+'*'+2+"\r\n"+\0
+
+protected:
+  SAILMAX_LOGGER_SD_CLASS *pSd;
+  SdFile LogFile;
+  uint8_t *Buffer;
+  uint16_t BufferBlocks;
+  uint16_t MaxRunBlocks;
+  uint32_t FirstBlock;    // first block of the file on the card
+  uint32_t FileBlocks;    // preallocated size of the file in blocks
+  uint32_t BlocksWritten; // blocks already written to the card
+  uint32_t BytesLogged;   // bytes put to the ring since Open
+  uint16_t FillBlock;     // ring index of block currently filled by Log
+  uint16_t FillPos;       // position inside FillBlock
+  uint16_t WriteBlock;    // ring index of the oldest full block
+  uint16_t FullBlocks;    // number of full blocks waiting for write
+  bool IsOpen;
+
+  uint32_t LoggedMessages;
+  uint32_t DroppedMessages;
+  uint32_t WriteErrors;
+  uint32_t MaxWriteLatency; // us
+  uint16_t MinFreeBlocks;
+
+protected:
+  bool WriteRun(uint16_t Blocks);
+
+public:
+  // BufferBlocks is the size of the RAM ring in 512 byte blocks. MaxRunBlocks
+  // limits blocks written with one call, so that Service() does not block too long.
+  tSailmaxLogger(uint16_t _BufferBlocks=32, uint16_t _MaxRunBlocks=8);
+  ~tSailmaxLogger();
+
+  /**
+   *  Creates a new contiguous file with size FileBlocks*512 bytes.
+   *  An existing file with same name will be removed. With Erase the area
+   *  will be flash erased, which makes later writes faster on most cards.
+   *  Returns false on any failure.
+   */
+  bool Open(SAILMAX_LOGGER_SD_CLASS &sd, const char *FileName, uint32_t _FileBlocks, bool Erase=true);
+
+  /**
+   *  Formats message as Sailmax sentence into the ring buffer.
+   *  Returns false, if message has been dropped due to full buffer or full file.
+   */
+  bool Log(const tN2kMsg &msg, uint32_t timestamp);
+  bool Log(const tN2kMsg &msg) { return Log(msg,msg.MsgTime); }
+
+  /**
+   *  Writes complete blocks to the card. Call this as often as possible.
+   */
+  void Service();
+
+  /**
+   *  Writes all buffered data, truncates the file to the logged length
+   *  and closes it.
+   */
+  bool Close();
+
+  bool IsLogOpen() const { return IsOpen; }
+  bool IsFull() const { return IsOpen && BytesLogged>=FileBlocks*BlockSize; }
+  uint32_t GetLoggedMessages() const { return LoggedMessages; }
+  uint32_t GetDroppedMessages() const { return DroppedMessages; }
+  uint32_t GetWriteErrors() const { return WriteErrors; }
+  uint32_t GetMaxWriteLatency() const { return MaxWriteLatency; }
+  uint16_t GetMinFreeBlocks() const { return MinFreeBlocks; }
+  uint32_t GetBytesLogged() const { return BytesLogged; }
+  void ResetStatistics();
+  void PrintStatistics(Print &out);
+};
+
+/**
+ *  Message handler, which logs all messages received by NMEA2000 object.
+ *  Usage: tSailmaxLogHandler LogHandler(&Logger,&NMEA2000);
+ */
+class tSailmaxLogHandler : public tNMEA2000::tMsgHandler {
+protected:
+  tSailmaxLogger *pLogger;
+  void HandleMsg(const tN2kMsg &N2kMsg) { pLogger->Log(N2kMsg,millis()); }
+
+public:
+  tSailmaxLogHandler(tSailmaxLogger *_pLogger, tNMEA2000 *_pNMEA2000=0) : tNMEA2000::tMsgHandler(0,_pNMEA2000), pLogger(_pLogger) {}
+};
+
+#endif
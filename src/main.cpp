@@ -62,14 +62,18 @@ bool sendNext = true;
 
 int er;
 uint32_t n = 0;
-uint32_t timeSent = 0;
-int32_t delayTime = 0;
 uint32_t timeNext = 0;
 int64_t delta     = 0;
 
 uint64_t lineNumber = 0;
 int8_t mode = 1;
 
+// Every source in logFile is own device, which claims address on the bus.
+// Messages will be sent with address claimed by device of their log source.
+static const uint8_t noDevice = 0xff;
+uint8_t sourceDevice[256];
+int deviceCount = 0;
+
 void setup() {
   Serial.begin(115200);
   Serial.printf("Starting with LogFile: %s\n", logFilename);
@@ -95,41 +99,64 @@ void setup() {
     errorHalt("Logfile does not exist");
   }
 
+  memset(sourceDevice, noDevice, sizeof(sourceDevice));
+  while ((er = logFile.fgets(line, sizeof(line))) > 0) {
+    if (SailmaxToN2k(line, timeNext, msg) && msg.Source <= N2kMaxCanBusAddress && sourceDevice[msg.Source] == noDevice) {
+      sourceDevice[msg.Source] = deviceCount++;
+    }
+  }
+  logFile.rewind();
+  Serial.printf("Sources in LogFile: %d\n", deviceCount);
+  if (deviceCount > 0) NMEA2000.SetDeviceCount(deviceCount);
+
   NMEA2000.SetMode(tNMEA2000::N2km_NodeOnly);
   //NMEA2000.SetMode(tNMEA2000::N2km_ListenAndSend);
+  for (int source = 0; source <= N2kMaxCanBusAddress; source++) {
+    if (sourceDevice[source] != noDevice) NMEA2000.SetN2kSource(source, sourceDevice[source]); // Try original address first
+  }
   NMEA2000.SetN2kCANMsgBufSize(8);
   NMEA2000.SetN2kCANSendFrameBufSize(150);
+  NMEA2000.SetScheduledMsgBufSize(16);  // Messages read ahead from logFile
   NMEA2000.SetForwardStream(&Serial);  // PC output on due native port
   NMEA2000.SetForwardType(tNMEA2000::fwdt_Text); // Show in clear text
   // NMEA2000.EnableForward(false); // Disable all msg forwarding to USB (=Serial)
 
   //NMEA2000.ExtendTransmitMessages(TransmitMessages);
   NMEA2000.Open();
+  uint32_t claimEnd = millis() + 300;
+  while (millis() < claimEnd) NMEA2000.ParseMessages(); // Address claim
 
   while ((er = logFile.fgets(line, sizeof(line))) > 0) {
     n++;
     if (SailmaxToN2k(line, timeNext, msg)){
       if (n == 1) {
-        delayTime = 0;
         delta     = millis() - timeNext;  // difference millis to timestamp from 1st sentence in logFile
-      } else {
-        delayTime = timeNext - timeSent + (delta - millis() + timeNext) - 40;
-        //Serial.printf("Line: %d Differenz: %d, Delay: %d\n", n, millis() - timeNext, delayTime);
-        if (delayTime > 0) delay(delayTime);
       }
-      Serial.printf("%d : ", n);
-      NMEA2000.SendMsg(msg, -1);
-
-      timeSent = timeNext;
+      // NMEA2000 sends message at its log time. Keep bus running, while scheduler pool is full.
+      int device = (sourceDevice[msg.Source] != noDevice ? sourceDevice[msg.Source] : -1);
+      // Waiting here instead of retrying SendMsgAt does not count rejects.
+      const tN2kMsgScheduler *scheduler = NMEA2000.GetMsgScheduler();
+      while (scheduler != 0 && scheduler->GetPoolSize() > 0 && scheduler->GetStatistics().InUse >= scheduler->GetPoolSize()) {
+        NMEA2000.ParseMessages();
+      }
+      // Pool has room, so only failed pool allocation can reject message
+      if (!NMEA2000.SendMsgAt(msg, timeNext + delta, device)) errorHalt("No memory for scheduled messages");
     } else {
       Serial.printf("Could not convert line %d\n",n);
     }
   }
+  while (NMEA2000.GetMsgScheduler() != 0 && NMEA2000.GetMsgScheduler()->GetStatistics().InUse > 0) NMEA2000.ParseMessages();
+
   if (n <= 1) {
     Serial.printf("Could not read LogFile\n");
   } else {
     Serial.printf("End of LogFile\n");
   }
+  if (NMEA2000.GetMsgScheduler() != 0) {
+    const tN2kMsgScheduler::tStatistics &stats = NMEA2000.GetMsgScheduler()->GetStatistics();
+    Serial.printf("Sent: %lu, failed: %lu, max late: %lu ms\n",
+                  (unsigned long)stats.Sent, (unsigned long)stats.Failed, (unsigned long)stats.MaxLateness);
+  }
 
 }
 
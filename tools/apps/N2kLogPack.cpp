@@ -0,0 +1,203 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  n2klog-pack, packs Sailmax logs with run records or XOR deltas
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <N2kMsg.h>
+#include <SailmaxFormat.h>
+#include "SailmaxRunLength.h"
+#include "N2kXorCodec.h"
+
+static void Usage() {
+  fprintf(stderr,
+    "Usage: n2klog-pack [-u] [-x] [-m repeats] [-w records] infile outfile\n"
+    "  -u          unpack run records or binary file back to original messages\n"
+    "  -x          pack to binary file with XOR deltas per PGN and source\n"
+    "  -m repeats  max repeats in one run record (default 64)\n"
+    "  -w records  max records waiting behind an open run (default 1024)\n");
+}
+
+static void WriteLine(const char *Line, void *Context) {
+  FILE *f=(FILE *)Context;
+  fputs(Line,f);
+  fputs("\r\n",f);
+}
+
+static void WriteMsg(const tN2kMsg &msg, uint32_t timestamp, FILE *f) {
+  char Line[MaxSailmaxLine];
+  if ( N2kToSailmax(msg,timestamp,Line,sizeof(Line))>0 ) WriteLine(Line,f);
+}
+
+static void WriteData(const uint8_t *Data, size_t len, void *Context) {
+  fwrite(Data,1,len,(FILE *)Context);
+}
+
+static size_t ReadData(uint8_t *Data, size_t size, void *Context) {
+  return fread(Data,1,size,(FILE *)Context);
+}
+
+// Gives messages of text log to handler in original sequence
+class tMsgSink {
+public:
+  virtual void Add(const tN2kMsg &msg, uint32_t timestamp)=0;
+  virtual ~tMsgSink() {}
+};
+
+static uint32_t ReadTextLog(FILE *In, tMsgSink &Sink, uint32_t &Records) {
+  char *Line=0;
+  size_t LineCapacity=0;
+  ssize_t len;
+  uint32_t Skipped=0;
+  tN2kMsg msg;
+  uint32_t timestamp;
+  tSailmaxRunExpander Expander;
+
+  while ( (len=getline(&Line,&LineCapacity,In))>0 ) {
+    while ( len>0 && ( Line[len-1]=='\n' || Line[len-1]=='\r' ) ) Line[--len]=0;
+    if ( !Expander.AddLine(Line) ) { Skipped++; continue; }
+    Records++;
+    while ( Expander.Next(msg,timestamp) ) Sink.Add(msg,timestamp);
+  }
+  Expander.Finish();
+  while ( Expander.Next(msg,timestamp) ) Sink.Add(msg,timestamp);
+
+  free(Line);
+  return Skipped;
+}
+
+class tTextSink : public tMsgSink {
+public:
+  FILE *Out;
+  uint32_t Messages;
+  tTextSink(FILE *_Out) : Out(_Out), Messages(0) {}
+  void Add(const tN2kMsg &msg, uint32_t timestamp) { WriteMsg(msg,timestamp,Out); Messages++; }
+};
+
+class tRunSink : public tMsgSink {
+public:
+  tSailmaxRunWriter Writer;
+  tRunSink(FILE *Out, uint32_t MaxRepeats, size_t MaxPending) : Writer(WriteLine,Out,MaxRepeats,MaxPending) {}
+  void Add(const tN2kMsg &msg, uint32_t timestamp) { Writer.Add(msg,timestamp); }
+};
+
+class tXorSink : public tMsgSink {
+public:
+  tN2kXorEncoder Encoder;
+  tXorSink(FILE *Out) : Encoder(WriteData,Out) {}
+  void Add(const tN2kMsg &msg, uint32_t timestamp) { Encoder.Add(msg,timestamp); }
+};
+
+int main(int argc, char *argv[]) {
+  bool Unpack=false;
+  bool Xor=false;
+  uint32_t MaxRepeats=64;
+  size_t MaxPending=1024;
+  const char *InName=0;
+  const char *OutName=0;
+
+  for (int i=1; i<argc; i++) {
+    if ( strcmp(argv[i],"-u")==0 ) {
+      Unpack=true;
+    } else if ( strcmp(argv[i],"-x")==0 ) {
+      Xor=true;
+    } else if ( strcmp(argv[i],"-m")==0 && i+1<argc ) {
+      MaxRepeats=strtoul(argv[++i],0,10);
+    } else if ( strcmp(argv[i],"-w")==0 && i+1<argc ) {
+      MaxPending=strtoul(argv[++i],0,10);
+    } else if ( argv[i][0]!='-' && InName==0 ) {
+      InName=argv[i];
+    } else if ( argv[i][0]!='-' && OutName==0 ) {
+      OutName=argv[i];
+    } else {
+      Usage();
+      return 1;
+    }
+  }
+  if ( InName==0 || OutName==0 ) {
+    Usage();
+    return 1;
+  }
+
+  FILE *In=fopen(InName,"rb");
+  if ( In==0 ) { fprintf(stderr,"Can not open %s\n",InName); return 1; }
+  FILE *Out=fopen(OutName,"wb");
+  if ( Out==0 ) { fprintf(stderr,"Can not create %s\n",OutName); fclose(In); return 1; }
+
+  uint32_t Skipped=0;
+  uint32_t Messages=0;
+  uint32_t Records=0;
+  bool result=true;
+
+  if ( Unpack ) {
+    char Magic[4];
+    bool Binary=( fread(Magic,1,sizeof(Magic),In)==sizeof(Magic) && memcmp(Magic,"N2KX",4)==0 );
+    rewind(In);
+    tTextSink Sink(Out);
+    if ( Binary ) {
+      tN2kXorDecoder Decoder(ReadData,In);
+      tN2kMsg msg;
+      uint32_t timestamp;
+      while ( Decoder.Next(msg,timestamp) ) Sink.Add(msg,timestamp);
+      if ( Decoder.IsError() ) { fprintf(stderr,"Binary file %s is damaged\n",InName); result=false; }
+      Records=Sink.Messages;
+    } else {
+      Skipped=ReadTextLog(In,Sink,Records);
+    }
+    Messages=Sink.Messages;
+  } else if ( Xor ) {
+    tXorSink Sink(Out);
+    Skipped=ReadTextLog(In,Sink,Records);
+    Messages=Records=Sink.Encoder.GetMessages();
+    Sink.Encoder.Close();
+  } else {
+    tRunSink Sink(Out,MaxRepeats,MaxPending);
+    Skipped=ReadTextLog(In,Sink,Records);
+    Sink.Writer.Flush();
+    Messages=Sink.Writer.GetMessages();
+    Records=Sink.Writer.GetRecords();
+    fprintf(stderr,"Run records: %lu\n",(unsigned long)Sink.Writer.GetRunRecords());
+  }
+
+  fseek(In,0,SEEK_END);
+  long InSize=ftell(In);
+  long OutSize=ftell(Out);
+  fclose(In);
+  if ( fclose(Out)!=0 ) { fprintf(stderr,"Write to %s failed\n",OutName); return 1; }
+
+  fprintf(stderr,"Messages: %lu, records: %lu, skipped lines: %lu\n",
+          (unsigned long)Messages,(unsigned long)Records,(unsigned long)Skipped);
+  fprintf(stderr,"Size: %ld -> %ld (%.1f%%)\n",InSize,OutSize,(InSize>0?100.0*OutSize/InSize:0.0));
+
+  return ( result ? 0 : 1 );
+}
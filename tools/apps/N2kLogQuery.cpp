@@ -0,0 +1,124 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  n2klog-query, selects messages by PGN and source using block index
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <N2kMsg.h>
+#include "HostPlatform.h"
+#include "SailmaxLogIndex.h"
+
+static void Usage() {
+  fprintf(stderr,
+    "Usage: n2klog-query [-p pgn]... [-s source]... [-b blocksize] [-f] [-d] [-c] logfile\n"
+    "  -p pgn     select PGN (decimal), can be given several times\n"
+    "  -s source  select source (hex, e.g. 23), can be given several times\n"
+    "  -b bytes   index block size for new index (default %u)\n"
+    "  -f         force rebuilding index logfile.idx\n"
+    "  -d         print decoded messages instead of log lines\n"
+    "  -c         only count matching messages\n",
+    (unsigned)tSailmaxLogIndex::DefaultBlockSize);
+}
+
+struct tOutput {
+  bool Decoded;
+  bool CountOnly;
+  tStdioStream Stream;
+};
+
+static void PrintMatch(const char *Line, uint32_t timestamp, const tN2kMsg &msg, void *Context) {
+  tOutput *Output=(tOutput *)Context;
+  if ( Output->CountOnly ) return;
+  if ( Output->Decoded ) {
+    printf("%lu : ",(unsigned long)timestamp);
+    msg.Print(&Output->Stream);
+  } else {
+    printf("%s\n",Line);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  tSailmaxLogQuery Query;
+  tOutput Output;
+  uint32_t BlockSize=0;
+  bool ForceBuild=false;
+  const char *FileName=0;
+
+  Output.Decoded=false;
+  Output.CountOnly=false;
+
+  for (int i=1; i<argc; i++) {
+    if ( strcmp(argv[i],"-p")==0 && i+1<argc ) {
+      if ( !Query.AddPGN(strtoul(argv[++i],0,10)) ) { fprintf(stderr,"Too many PGNs\n"); return 1; }
+    } else if ( strcmp(argv[i],"-s")==0 && i+1<argc ) {
+      if ( !Query.AddSource((unsigned char)strtoul(argv[++i],0,16)) ) { fprintf(stderr,"Too many sources\n"); return 1; }
+    } else if ( strcmp(argv[i],"-b")==0 && i+1<argc ) {
+      BlockSize=strtoul(argv[++i],0,10);
+    } else if ( strcmp(argv[i],"-f")==0 ) {
+      ForceBuild=true;
+    } else if ( strcmp(argv[i],"-d")==0 ) {
+      Output.Decoded=true;
+    } else if ( strcmp(argv[i],"-c")==0 ) {
+      Output.CountOnly=true;
+    } else if ( argv[i][0]!='-' && FileName==0 ) {
+      FileName=argv[i];
+    } else {
+      Usage();
+      return 1;
+    }
+  }
+  if ( FileName==0 ) {
+    Usage();
+    return 1;
+  }
+
+  tSailmaxLogIndex Index;
+  if ( !Index.Open(FileName,BlockSize,ForceBuild) ) {
+    fprintf(stderr,"Can not index %s\n",FileName);
+    return 1;
+  }
+  if ( !Query.Run(FileName,Index,PrintMatch,&Output) ) {
+    fprintf(stderr,"Can not read %s\n",FileName);
+    return 1;
+  }
+  fflush(stdout);
+
+  uint64_t Total=Index.GetFileSize();
+  fprintf(stderr,"Matches: %lu\n",(unsigned long)Query.GetMatches());
+  fprintf(stderr,"Blocks scanned: %lu, skipped: %lu\n",(unsigned long)Query.GetBlocksScanned(),(unsigned long)Query.GetBlocksSkipped());
+  fprintf(stderr,"Bytes touched: %llu of %llu (%.1f%%)\n",
+          (unsigned long long)Query.GetBytesTouched(),(unsigned long long)Total,
+          (Total>0?100.0*Query.GetBytesTouched()/Total:0.0));
+
+  return 0;
+}
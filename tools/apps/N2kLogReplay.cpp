@@ -0,0 +1,125 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  n2klog-replay, replays raw CAN frame logs through tNMEA2000
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <string.h>
+#include <N2kMsg.h>
+#include <SailmaxFormat.h>
+#include "HostPlatform.h"
+#include "SailmaxRunLength.h"
+#include "N2kFrameReplay.h"
+
+static void Usage() {
+  fprintf(stderr,
+    "Usage: n2klog-replay [-r] [-o outfile] framelog\n"
+    "  -r          replay at original frame timing instead of as fast as possible\n"
+    "  -o outfile  write reassembled messages as Sailmax log\n");
+}
+
+static FILE *Out=0;
+static uint32_t Messages=0;
+
+static void HandleMsg(const tN2kMsg &N2kMsg) {
+  Messages++;
+  if ( Out==0 ) return;
+  char Line[MaxSailmaxLine];
+  if ( N2kToSailmax(N2kMsg,N2kMsg.MsgTime,Line,sizeof(Line))>0 ) {
+    fputs(Line,Out);
+    fputs("\r\n",Out);
+  }
+}
+
+static size_t ReadData(uint8_t *Data, size_t size, void *Context) {
+  return fread(Data,1,size,(FILE *)Context);
+}
+
+int main(int argc, char *argv[]) {
+  bool Realtime=false;
+  const char *InName=0;
+  const char *OutName=0;
+
+  for (int i=1; i<argc; i++) {
+    if ( strcmp(argv[i],"-r")==0 ) {
+      Realtime=true;
+    } else if ( strcmp(argv[i],"-o")==0 && i+1<argc ) {
+      OutName=argv[++i];
+    } else if ( argv[i][0]!='-' && InName==0 ) {
+      InName=argv[i];
+    } else {
+      Usage();
+      return 1;
+    }
+  }
+  if ( InName==0 ) {
+    Usage();
+    return 1;
+  }
+
+  FILE *In=fopen(InName,"rb");
+  if ( In==0 ) { fprintf(stderr,"Can not open %s\n",InName); return 1; }
+  if ( OutName!=0 ) {
+    Out=fopen(OutName,"wb");
+    if ( Out==0 ) { fprintf(stderr,"Can not create %s\n",OutName); fclose(In); return 1; }
+  }
+
+  tN2kFrameLogReader Reader(ReadData,In);
+  uint64_t Start=HostMicros();
+  uint32_t Frames;
+  tNMEA2000::tRxStatistics RxStatistics;
+  {
+    tNMEA2000_FrameReplay Replay(Reader,Realtime);
+    Replay.SetMsgHandler(HandleMsg);
+    Replay.EnableForward(false);
+    Replay.Run();
+    Frames=Replay.GetReplayedFrames();
+    RxStatistics=Replay.GetRxStatistics();
+  }
+  double Seconds=(HostMicros()-Start)/1e6;
+
+  fclose(In);
+  bool result=!Reader.IsError();
+  if ( !result ) fprintf(stderr,"Frame log %s is damaged\n",InName);
+  if ( Out!=0 && fclose(Out)!=0 ) { fprintf(stderr,"Write to %s failed\n",OutName); return 1; }
+
+  fprintf(stderr,"Frames: %lu, messages: %lu, time: %.3f s, %.0f frames/s\n",
+          (unsigned long)Frames,(unsigned long)Messages,Seconds,(Seconds>0?Frames/Seconds:0.0));
+  fprintf(stderr,"Orphan frames: %lu, lost frames: %lu, restarts: %lu, evictions: %lu, no free slot: %lu, max slots in use: %u\n",
+          (unsigned long)RxStatistics.Events[tNMEA2000::rxe_OrphanFrame],
+          (unsigned long)RxStatistics.Events[tNMEA2000::rxe_LostFrame],
+          (unsigned long)RxStatistics.Events[tNMEA2000::rxe_Restart],
+          (unsigned long)RxStatistics.Events[tNMEA2000::rxe_Eviction],
+          (unsigned long)RxStatistics.Events[tNMEA2000::rxe_NoFreeSlot],
+          RxStatistics.MaxSlotsInUse);
+
+  return ( result ? 0 : 1 );
+}
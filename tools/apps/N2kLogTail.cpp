@@ -0,0 +1,108 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  n2klog-tail, follows a Sailmax log file while it is written
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <N2kMsg.h>
+#include <SailmaxFormat.h>
+#include "HostPlatform.h"
+#include "SailmaxFollowReader.h"
+
+static void Usage() {
+  fprintf(stderr,
+    "Usage: n2klog-tail [-n] [-r] [-p ms] logfile\n"
+    "  -n     start at end of file, show only new messages\n"
+    "  -r     print raw Sailmax lines instead of decoded messages\n"
+    "  -p ms  poll interval, if inotify is not available (default %d)\n",
+    tSailmaxFollowReader::DefaultPollInterval);
+}
+
+int main(int argc, char *argv[]) {
+  bool FromStart=true;
+  bool Raw=false;
+  int PollInterval=tSailmaxFollowReader::DefaultPollInterval;
+  const char *FileName=0;
+
+  for (int i=1; i<argc; i++) {
+    if ( strcmp(argv[i],"-n")==0 ) {
+      FromStart=false;
+    } else if ( strcmp(argv[i],"-r")==0 ) {
+      Raw=true;
+    } else if ( strcmp(argv[i],"-p")==0 && i+1<argc ) {
+      PollInterval=atoi(argv[++i]);
+    } else if ( argv[i][0]!='-' && FileName==0 ) {
+      FileName=argv[i];
+    } else {
+      Usage();
+      return 1;
+    }
+  }
+  if ( FileName==0 ) {
+    Usage();
+    return 1;
+  }
+
+  tSailmaxFollowReader Reader;
+  Reader.SetPollInterval(PollInterval);
+  if ( !Reader.Open(FileName,FromStart) ) {
+    fprintf(stderr,"Can not open %s\n",FileName);
+    return 1;
+  }
+  fprintf(stderr,"Following %s (%s)\n",FileName,(Reader.IsUsingInotify()?"inotify":"polling"));
+
+  tStdioStream Out(stdout);
+  tN2kMsg msg;
+  uint32_t timestamp;
+
+  while ( true ) {
+    if ( Raw ) {
+      const char *Line=Reader.NextLine();
+      if ( Line!=0 ) {
+        printf("%s\n",Line);
+        continue;
+      }
+      fflush(stdout);
+      Reader.WaitForData(-1);
+    } else {
+      if ( Reader.NextMsg(msg,timestamp,0) ) {
+        msg.Print(&Out);
+        continue;
+      }
+      fflush(stdout);
+      Reader.WaitForData(-1);
+    }
+  }
+
+  return 0;
+}
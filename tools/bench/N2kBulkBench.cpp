@@ -0,0 +1,217 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  n2klog-bulkbench, bulk field decode vs. ParseN2k loop
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <N2kMsg.h>
+#include <N2kMessages.h>
+#include <N2kMessageCodecs.h>
+#include <SailmaxFormat.h>
+#include "HostPlatform.h"
+#include "N2kBulkDecode.h"
+
+struct tWindColumns {
+  std::vector<float> WindSpeed, WindAngle;
+  std::vector<uint8_t> WindReference;
+  void Resize(size_t n) { WindSpeed.resize(n); WindAngle.resize(n); WindReference.resize(n); }
+};
+
+struct tHeadingColumns {
+  std::vector<float> Heading, Deviation, Variation;
+  void Resize(size_t n) { Heading.resize(n); Deviation.resize(n); Variation.resize(n); }
+};
+
+//*****************************************************************************
+static void ScalarWind(const std::vector<tN2kMsg> &Msgs, tWindColumns &c) {
+  unsigned char SID;
+  double s,a;
+  tN2kWindReference ref;
+  for (size_t i=0; i<Msgs.size(); i++) {
+    ParseN2kPGN130306(Msgs[i],SID,s,a,ref);
+    c.WindSpeed[i]=( N2kIsNA(s) ? N2kFloatNA : (float)s );
+    c.WindAngle[i]=( N2kIsNA(a) ? N2kFloatNA : (float)a );
+    c.WindReference[i]=ref;
+  }
+}
+
+//*****************************************************************************
+static void BulkWind(const uint8_t *Data, size_t Stride, size_t Count, tWindColumns &c) {
+  N2kBulkDecodeScaled<tN2kWindSpeedFloatData::tWindSpeed>(Data,Stride,Count,&c.WindSpeed[0]);
+  N2kBulkDecodeScaled<tN2kWindSpeedFloatData::tWindAngle>(Data,Stride,Count,&c.WindAngle[0]);
+  N2kBulkDecodeBits<tN2kWindSpeedFloatData::tWindReference>(Data,Stride,Count,&c.WindReference[0]);
+}
+
+//*****************************************************************************
+static void ScalarHeading(const std::vector<tN2kMsg> &Msgs, tHeadingColumns &c) {
+  unsigned char SID;
+  double h,d,v;
+  tN2kHeadingReference ref;
+  for (size_t i=0; i<Msgs.size(); i++) {
+    ParseN2kPGN127250(Msgs[i],SID,h,d,v,ref);
+    c.Heading[i]=( N2kIsNA(h) ? N2kFloatNA : (float)h );
+    c.Deviation[i]=( N2kIsNA(d) ? N2kFloatNA : (float)d );
+    c.Variation[i]=( N2kIsNA(v) ? N2kFloatNA : (float)v );
+  }
+}
+
+//*****************************************************************************
+static void BulkHeading(const uint8_t *Data, size_t Stride, size_t Count, tHeadingColumns &c) {
+  N2kBulkDecodeScaled<tN2kHeadingFloatData::tHeading>(Data,Stride,Count,&c.Heading[0]);
+  N2kBulkDecodeScaled<tN2kHeadingFloatData::tDeviation>(Data,Stride,Count,&c.Deviation[0]);
+  N2kBulkDecodeScaled<tN2kHeadingFloatData::tVariation>(Data,Stride,Count,&c.Variation[0]);
+}
+
+//*****************************************************************************
+static bool SameColumn(const std::vector<float> &a, const std::vector<float> &b, double Resolution) {
+  for (size_t i=0; i<a.size(); i++) {
+    if ( N2kIsNA(a[i]) || N2kIsNA(b[i]) ) {
+      if ( a[i]!=b[i] ) return false;
+    } else if ( fabs(a[i]-b[i])>Resolution ) return false;
+  }
+  return true;
+}
+
+//*****************************************************************************
+static double Elapsed(uint64_t Start, size_t Count) {
+  uint64_t t=HostMicros()-Start;
+  return 1000.0*t/Count;
+}
+
+//*****************************************************************************
+// Pack plus bulk is the cost starting from tN2kMsg array
+static void Report(const char *Name, double Scalar, double Strided, double Packed, double Pack) {
+  printf("%s\n",Name);
+  printf("  ParseN2k loop:     %6.2f ns/message\n",Scalar);
+  printf("  Bulk, tN2kMsg:     %6.2f ns/message (%.1fx)\n",Strided,Scalar/Strided);
+  printf("  Bulk, packed:      %6.2f ns/message (%.1fx)\n",Packed,Scalar/Packed);
+  printf("  Packing:           %6.2f ns/message\n",Pack);
+  printf("  Pack plus bulk:    %6.2f ns/message (%.1fx)\n",Pack+Packed,Scalar/(Pack+Packed));
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<tN2kMsg> Wind, Heading;
+
+#if !defined(__OPTIMIZE__)
+  fprintf(stderr,"Warning: build is not optimized, set CMAKE_BUILD_TYPE to Release or RelWithDebInfo\n");
+#endif
+
+  for ( int a=1; a<argc; a++ ) {
+    FILE *f=fopen(argv[a],"rb");
+    if ( f==0 ) { fprintf(stderr,"Can not open %s\n",argv[a]); return 1; }
+    char *Line=0;
+    size_t LineCapacity=0;
+    tN2kMsg msg;
+    uint32_t timestamp;
+    while ( getline(&Line,&LineCapacity,f)>0 ) {
+      Line[strcspn(Line,"\r\n")]=0;
+      if ( !SailmaxToN2k(Line,timestamp,msg) || msg.DataLen<8 ) continue;
+      if ( msg.PGN==130306L ) Wind.push_back(msg);
+      if ( msg.PGN==127250L ) Heading.push_back(msg);
+    }
+    free(Line);
+    fclose(f);
+  }
+
+  // Repeat log messages or builtin values up to 1M messages per PGN
+  const size_t Count=1000000;
+  if ( Wind.empty() ) {
+    tN2kMsg msg;
+    for (int i=0; i<1000; i++) {
+      SetN2kPGN130306(msg,i,( i%100==0 ? N2kDoubleNA : 5+i%700/100.0 ),i*0.00628,N2kWind_Apparent);
+      Wind.push_back(msg);
+    }
+  }
+  if ( Heading.empty() ) {
+    tN2kMsg msg;
+    for (int i=0; i<1000; i++) {
+      SetN2kPGN127250(msg,i,i*0.00628,N2kDoubleNA,0.1-i*0.0002,N2khr_magnetic);
+      Heading.push_back(msg);
+    }
+  }
+  for (size_t i=0; Wind.size()<Count; i++) Wind.push_back(Wind[i]);
+  for (size_t i=0; Heading.size()<Count; i++) Heading.push_back(Heading[i]);
+
+  std::vector<uint8_t> Payloads(Count*8);
+  bool Same=true;
+
+  {
+    tWindColumns Scalar, Strided, Packed;
+    Scalar.Resize(Count); Strided.Resize(Count); Packed.Resize(Count);
+    uint64_t Start=HostMicros();
+    ScalarWind(Wind,Scalar);
+    double ScalarTime=Elapsed(Start,Count);
+    Start=HostMicros();
+    BulkWind(Wind[0].Data,sizeof(tN2kMsg),Count,Strided);
+    double StridedTime=Elapsed(Start,Count);
+    Start=HostMicros();
+    N2kPackPayloads(&Wind[0],Count,130306L,8,&Payloads[0]);
+    double PackTime=Elapsed(Start,Count);
+    Start=HostMicros();
+    BulkWind(&Payloads[0],8,Count,Packed);
+    double PackedTime=Elapsed(Start,Count);
+    Report("Wind speed 130306",ScalarTime,StridedTime,PackedTime,PackTime);
+    Same=Same && SameColumn(Scalar.WindSpeed,Packed.WindSpeed,0.01) && SameColumn(Scalar.WindAngle,Packed.WindAngle,0.0001)
+              && Scalar.WindReference==Packed.WindReference
+              && Strided.WindSpeed==Packed.WindSpeed && Strided.WindAngle==Packed.WindAngle;
+  }
+
+  {
+    tHeadingColumns Scalar, Strided, Packed;
+    Scalar.Resize(Count); Strided.Resize(Count); Packed.Resize(Count);
+    uint64_t Start=HostMicros();
+    ScalarHeading(Heading,Scalar);
+    double ScalarTime=Elapsed(Start,Count);
+    Start=HostMicros();
+    BulkHeading(Heading[0].Data,sizeof(tN2kMsg),Count,Strided);
+    double StridedTime=Elapsed(Start,Count);
+    Start=HostMicros();
+    N2kPackPayloads(&Heading[0],Count,127250L,8,&Payloads[0]);
+    double PackTime=Elapsed(Start,Count);
+    Start=HostMicros();
+    BulkHeading(&Payloads[0],8,Count,Packed);
+    double PackedTime=Elapsed(Start,Count);
+    Report("Vessel heading 127250",ScalarTime,StridedTime,PackedTime,PackTime);
+    Same=Same && SameColumn(Scalar.Heading,Packed.Heading,0.0001) && SameColumn(Scalar.Deviation,Packed.Deviation,0.0001)
+              && SameColumn(Scalar.Variation,Packed.Variation,0.0001)
+              && Strided.Heading==Packed.Heading && Strided.Variation==Packed.Variation;
+  }
+
+  if ( !Same ) {
+    fprintf(stderr,"Bulk decode differs from ParseN2k\n");
+    return 1;
+  }
+  return 0;
+}
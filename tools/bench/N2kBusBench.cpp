@@ -0,0 +1,106 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  n2klog-busbench, simulated bus throughput with loopback nodes
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <N2kMessages.h>
+#include "HostPlatform.h"
+#include "N2kLoopback.h"
+
+class tCountHandler : public tNMEA2000::tMsgHandler {
+public:
+  uint64_t Count;
+  tCountHandler(tNMEA2000 *_pNMEA2000) : tNMEA2000::tMsgHandler(0,_pNMEA2000), Count(0) {}
+  void HandleMsg(const tN2kMsg &) { Count++; }
+};
+
+int main(int argc, char *argv[]) {
+  int Senders=( argc>1 ? atoi(argv[1]) : 8 );
+  uint32_t Seconds=( argc>2 ? strtoul(argv[2],0,10) : 60 );
+  if ( Senders<1 || Senders>200 || Seconds==0 ) {
+    fprintf(stderr,"Usage: n2klog-busbench [senders] [seconds]\n");
+    return 1;
+  }
+
+  tN2kLoopbackBus Bus;
+  std::vector<tNMEA2000_Loopback *> Nodes;
+  for ( int i=0; i<Senders; i++ ) {
+    tNMEA2000_Loopback *Node=new tNMEA2000_Loopback(Bus);
+    Node->SetDeviceInformation(100+i,130,25,2046);
+    Node->SetMode(tNMEA2000::N2km_NodeOnly,10+i);
+    Node->EnableForward(false);
+    Nodes.push_back(Node);
+  }
+  tNMEA2000_Loopback Listener(Bus);
+  Listener.SetMode(tNMEA2000::N2km_ListenOnly);
+  Listener.EnableForward(false);
+  tCountHandler Received(&Listener);
+
+  Bus.Run(1000); // Address claim
+  uint64_t StartFrames=Bus.GetStatistics().Frames;
+  uint64_t StartTime=Bus.GetMicros();
+  uint64_t StartBusy=Bus.GetStatistics().BusyTime;
+  uint64_t Sent=0;
+
+  // Every sender sends heading at 10 Hz and GNSS position at 1 Hz
+  uint64_t WallStart=HostMicros();
+  tN2kMsg N2kMsg;
+  for ( uint32_t t=0; t<Seconds*10; t++ ) {
+    for ( size_t i=0; i<Nodes.size(); i++ ) {
+      SetN2kTrueHeading(N2kMsg,t,0.001*t);
+      if ( Nodes[i]->SendMsg(N2kMsg) ) Sent++;
+      if ( t%10==i%10 ) {
+        SetN2kGNSS(N2kMsg,t,17800,t*0.1,60.1+t*1e-6,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+        if ( Nodes[i]->SendMsg(N2kMsg) ) Sent++;
+      }
+    }
+    Bus.Run(100);
+  }
+  uint64_t WallTime=HostMicros()-WallStart;
+  if ( WallTime==0 ) WallTime=1;
+
+  uint64_t Frames=Bus.GetStatistics().Frames-StartFrames;
+  double SimTime=(Bus.GetMicros()-StartTime)/1e6;
+  printf("Senders:           %d\n",Senders);
+  printf("Simulated time:    %.1f s\n",SimTime);
+  printf("Bus load:          %.1f%%\n",100.0*(Bus.GetStatistics().BusyTime-StartBusy)/(Bus.GetMicros()-StartTime));
+  printf("Frames:            %llu\n",(unsigned long long)Frames);
+  printf("Messages sent:     %llu, received: %llu\n",(unsigned long long)Sent,(unsigned long long)Received.Count);
+  printf("Lost/overflows:    %llu/%llu\n",(unsigned long long)Bus.GetStatistics().LostFrames,(unsigned long long)Bus.GetStatistics().RxOverflows);
+  printf("Wall time:         %.2f s (%.1fx real time)\n",WallTime/1e6,SimTime*1e6/WallTime);
+  printf("Frame rate:        %.0f frames/s wall time\n",Frames*1e6/WallTime);
+
+  for ( size_t i=0; i<Nodes.size(); i++ ) delete Nodes[i];
+  return 0;
+}
@@ -0,0 +1,143 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  n2klog-classifybench, PGN classification table vs. list scanning
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <NMEA2000.h>
+#include <N2kMsg.h>
+#include <SailmaxFormat.h>
+#include "HostPlatform.h"
+
+// Typical application lists on top of library defaults
+const unsigned long AppSingleFrameMessages[] PROGMEM = {
+  127258L,129027L,129291L,130316L,130313L,130576L,130577L,127252L,
+  127247L,65359L,65360L,65379L,65345L,130845L,0 };
+const unsigned long AppFastPacketMessages[] PROGMEM = {
+  126720L,127233L,129041L,129044L,129045L,129301L,129538L,129542L,
+  129545L,129547L,129549L,129551L,129556L,129792L,129793L,129795L,
+  129796L,129797L,129798L,129799L,129800L,129801L,129803L,129804L,
+  129805L,129806L,129807L,129808L,129811L,129812L,129813L,130060L,
+  130064L,130065L,130066L,130067L,130068L,130069L,130070L,130071L,
+  130072L,130073L,130320L,130321L,130322L,130323L,130324L,130567L,
+  130578L,130816L,130817L,130818L,130819L,130820L,130821L,130824L,
+  130827L,130828L,130831L,130832L,130834L,130835L,130836L,130837L,
+  130838L,130839L,130840L,130842L,130843L,130850L,130851L,130856L,
+  130880L,130881L,130944L,0 };
+
+class tNMEA2000_bench : public tNMEA2000 {
+protected:
+  bool CANSendFrame(unsigned long, unsigned char, const unsigned char *, bool) { return true; }
+  bool CANOpen() { return true; }
+  bool CANGetFrame(unsigned long &, unsigned char &, unsigned char *) { return false; }
+
+public:
+  uint16_t GetTableSize() const { return PGNClassCount; }
+
+  unsigned long RunTable(const std::vector<unsigned long> &PGNs, int Rounds) {
+    unsigned long Known=0;
+    bool SystemMessage, FastPacket;
+    for ( int r=0; r<Rounds; r++ ) {
+      for ( size_t i=0; i<PGNs.size(); i++ ) {
+        if ( CheckKnownMessage(PGNs[i],SystemMessage,FastPacket) ) Known++;
+        if ( IsFastPacketPGN(PGNs[i]) ) Known++;
+      }
+    }
+    return Known;
+  }
+
+  unsigned long RunLists(const std::vector<unsigned long> &PGNs, int Rounds) {
+    unsigned long Known=0;
+    bool SystemMessage, FastPacket;
+    for ( int r=0; r<Rounds; r++ ) {
+      for ( size_t i=0; i<PGNs.size(); i++ ) {
+        if ( CheckKnownMessageFromLists(PGNs[i],SystemMessage,FastPacket) ) Known++;
+        if ( IsFastPacketPGNFromLists(PGNs[i]) ) Known++;
+      }
+    }
+    return Known;
+  }
+};
+
+int main(int argc, char *argv[]) {
+  std::vector<unsigned long> PGNs;
+
+  for ( int a=1; a<argc; a++ ) {
+    FILE *f=fopen(argv[a],"rb");
+    if ( f==0 ) { fprintf(stderr,"Can not open %s\n",argv[a]); return 1; }
+    char *Line=0;
+    size_t LineCapacity=0;
+    tN2kMsg msg;
+    uint32_t timestamp;
+    while ( getline(&Line,&LineCapacity,f)>0 ) {
+      Line[strcspn(Line,"\r\n")]=0;
+      if ( SailmaxToN2k(Line,timestamp,msg) ) PGNs.push_back(msg.PGN);
+    }
+    free(Line);
+    fclose(f);
+  }
+
+  if ( PGNs.empty() ) {
+    // Without log use mix of listed and unknown PGNs
+    for ( int i=0; AppFastPacketMessages[i]!=0; i++ ) PGNs.push_back(AppFastPacketMessages[i]);
+    for ( int i=0; AppSingleFrameMessages[i]!=0; i++ ) PGNs.push_back(AppSingleFrameMessages[i]);
+    PGNs.push_back(127250L); PGNs.push_back(129026L); PGNs.push_back(59904L); PGNs.push_back(65300L);
+  }
+
+  tNMEA2000_bench N2k;
+  N2k.ExtendSingleFrameMessages(AppSingleFrameMessages);
+  N2k.ExtendFastPacketMessages(AppFastPacketMessages);
+  N2k.Open();
+
+  const int Rounds=2000000/PGNs.size()+1;
+  uint64_t Start=HostMicros();
+  unsigned long ListKnown=N2k.RunLists(PGNs,Rounds);
+  uint64_t ListTime=HostMicros()-Start;
+  Start=HostMicros();
+  unsigned long TableKnown=N2k.RunTable(PGNs,Rounds);
+  uint64_t TableTime=HostMicros()-Start;
+  if ( TableTime==0 ) TableTime=1;
+
+  double Frames=(double)PGNs.size()*Rounds;
+  printf("PGNs:              %lu (table %u entries)\n",(unsigned long)PGNs.size(),N2k.GetTableSize());
+  printf("List scanning:     %.1f ns/frame\n",1000.0*ListTime/Frames);
+  printf("Class table:       %.1f ns/frame\n",1000.0*TableTime/Frames);
+  printf("Speedup:           %.2f\n",(double)ListTime/TableTime);
+
+  if ( ListKnown!=TableKnown ) {
+    fprintf(stderr,"Classification differs: %lu vs %lu\n",ListKnown,TableKnown);
+    return 1;
+  }
+  return 0;
+}
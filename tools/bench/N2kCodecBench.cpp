@@ -0,0 +1,256 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  n2klog-codecbench, field descriptor codec vs. hand written PGN parsers
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <N2kMsg.h>
+#include <N2kMessages.h>
+#include <N2kMessageCodecs.h>
+#include <SailmaxFormat.h>
+#include "HostPlatform.h"
+
+// Sum of parsed values, so that parsers can not be optimized away and both
+// parsers can be compared. NA values are summed too.
+static double HandParse(const tN2kMsg &msg) {
+  unsigned char SID, Instance;
+  double a,b,c;
+  switch ( msg.PGN ) {
+    case 127245L: {
+      tN2kRudderDirectionOrder DirectionOrder;
+      if ( !ParseN2kPGN127245(msg,a,Instance,DirectionOrder,b) ) return 0;
+      return Instance+DirectionOrder+b+a;
+    }
+    case 127250L: {
+      tN2kHeadingReference ref;
+      if ( !ParseN2kPGN127250(msg,SID,a,b,c,ref) ) return 0;
+      return SID+a+b+c+ref;
+    }
+    case 127257L:
+      if ( !ParseN2kPGN127257(msg,SID,a,b,c) ) return 0;
+      return SID+a+b+c;
+    case 127488L: {
+      int8_t TiltTrim;
+      if ( !ParseN2kPGN127488(msg,Instance,a,b,TiltTrim) ) return 0;
+      return Instance+a+b+TiltTrim;
+    }
+    case 128259L: {
+      tN2kSpeedWaterReferenceType SWRT;
+      if ( !ParseN2kPGN128259(msg,SID,a,b,SWRT) ) return 0;
+      return SID+a+b+SWRT;
+    }
+    case 128267L:
+      if ( !ParseN2kPGN128267(msg,SID,a,b,c) ) return 0;
+      return SID+a+b+c;
+    case 129025L:
+      if ( !ParseN2kPGN129025(msg,a,b) ) return 0;
+      return a+b;
+    case 129026L: {
+      tN2kHeadingReference ref;
+      if ( !ParseN2kPGN129026(msg,SID,ref,a,b) ) return 0;
+      return SID+ref+a+b;
+    }
+    case 130306L: {
+      tN2kWindReference ref;
+      if ( !ParseN2kPGN130306(msg,SID,a,b,ref) ) return 0;
+      return SID+a+b+ref;
+    }
+    case 130310L:
+      if ( !ParseN2kPGN130310(msg,SID,a,b,c) ) return 0;
+      return SID+a+b+c;
+    case 130311L: {
+      tN2kTempSource TempSource;
+      tN2kHumiditySource HumiditySource;
+      if ( !ParseN2kPGN130311(msg,SID,TempSource,a,HumiditySource,b,c) ) return 0;
+      return SID+TempSource+HumiditySource+a+b+c;
+    }
+    case 130312L: {
+      tN2kTempSource TempSource;
+      if ( !ParseN2kPGN130312(msg,SID,Instance,TempSource,a,b) ) return 0;
+      return SID+Instance+TempSource+a+b;
+    }
+  }
+  return 0;
+}
+
+static double CodecParse(const tN2kMsg &msg) {
+  switch ( msg.PGN ) {
+    case 127245L: {
+      tN2kRudderData d;
+      if ( !tN2kPGN127245Codec::Parse(msg,d) ) return 0;
+      return d.Instance+d.DirectionOrder+d.AngleOrder+d.Position;
+    }
+    case 127250L: {
+      tN2kHeadingData d;
+      if ( !tN2kPGN127250Codec::Parse(msg,d) ) return 0;
+      return d.SID+d.Heading+d.Deviation+d.Variation+d.Reference;
+    }
+    case 127257L: {
+      tN2kAttitudeData d;
+      if ( !tN2kPGN127257Codec::Parse(msg,d) ) return 0;
+      return d.SID+d.Yaw+d.Pitch+d.Roll;
+    }
+    case 127488L: {
+      tN2kEngineRapidData d;
+      if ( !tN2kPGN127488Codec::Parse(msg,d) ) return 0;
+      return d.EngineInstance+d.EngineSpeed+d.EngineBoostPressure+d.EngineTiltTrim;
+    }
+    case 128259L: {
+      tN2kBoatSpeedData d;
+      if ( !tN2kPGN128259Codec::Parse(msg,d) ) return 0;
+      return d.SID+d.WaterReferenced+d.GroundReferenced+d.SWRT;
+    }
+    case 128267L: {
+      tN2kWaterDepthData d;
+      if ( !tN2kPGN128267Codec::Parse(msg,d) ) return 0;
+      return d.SID+d.DepthBelowTransducer+d.Offset+d.Range;
+    }
+    case 129025L: {
+      tN2kLatLonRapidData d;
+      if ( !tN2kPGN129025Codec::Parse(msg,d) ) return 0;
+      return d.Latitude+d.Longitude;
+    }
+    case 129026L: {
+      tN2kCOGSOGRapidData d;
+      if ( !tN2kPGN129026Codec::Parse(msg,d) ) return 0;
+      return d.SID+d.Reference+d.COG+d.SOG;
+    }
+    case 130306L: {
+      tN2kWindSpeedData d;
+      if ( !tN2kPGN130306Codec::Parse(msg,d) ) return 0;
+      return d.SID+d.WindSpeed+d.WindAngle+d.WindReference;
+    }
+    case 130310L: {
+      tN2kOutsideEnvironmentalData d;
+      if ( !tN2kPGN130310Codec::Parse(msg,d) ) return 0;
+      return d.SID+d.WaterTemperature+d.OutsideAmbientAirTemperature+d.AtmosphericPressure;
+    }
+    case 130311L: {
+      tN2kEnvironmentalData d;
+      if ( !tN2kPGN130311Codec::Parse(msg,d) ) return 0;
+      return d.SID+d.TempSource+d.HumiditySource+d.Temperature+d.Humidity+d.AtmosphericPressure;
+    }
+    case 130312L: {
+      tN2kTemperatureData d;
+      if ( !tN2kPGN130312Codec::Parse(msg,d) ) return 0;
+      return d.SID+d.TempInstance+d.TempSource+d.ActualTemperature+d.SetTemperature;
+    }
+  }
+  return 0;
+}
+
+const unsigned long CodecPGNs[]={
+  127245L,127250L,127257L,127488L,128259L,128267L,129025L,129026L,
+  130306L,130310L,130311L,130312L,0 };
+
+// Short messages are left out, since hand written parsers do not keep field
+// offsets on them and results would differ.
+static bool HasCodec(const tN2kMsg &msg) {
+  if ( msg.DataLen<8 ) return false;
+  for ( int i=0; CodecPGNs[i]!=0; i++ ) {
+    if ( CodecPGNs[i]==msg.PGN ) return true;
+  }
+  return false;
+}
+
+// Builtin mix with typical values
+static void AddBuiltinMessages(std::vector<tN2kMsg> &Msgs) {
+  tN2kMsg msg;
+  for ( int i=0; i<100; i++ ) {
+    double r=i/100.0;
+    SetN2kPGN127245(msg,0.1-r*0.2,0,N2kRDO_MoveToStarboard,N2kDoubleNA); Msgs.push_back(msg);
+    SetN2kPGN127250(msg,i,r*6.28,N2kDoubleNA,0.05,N2khr_magnetic); Msgs.push_back(msg);
+    SetN2kPGN127257(msg,i,r*6.28,-0.1+r*0.2,0.2-r*0.4); Msgs.push_back(msg);
+    SetN2kPGN127488(msg,0,800+r*2000,N2kDoubleNA,-2); Msgs.push_back(msg);
+    SetN2kPGN128259(msg,i,3.1+r,N2kDoubleNA,N2kSWRT_Paddle_wheel); Msgs.push_back(msg);
+    SetN2kPGN128267(msg,i,5.2+r*20,-0.3,N2kDoubleNA); Msgs.push_back(msg);
+    SetN2kPGN129025(msg,60.1+r*0.01,24.9+r*0.01); Msgs.push_back(msg);
+    SetN2kPGN129026(msg,i,N2khr_true,r*6.28,3.3+r); Msgs.push_back(msg);
+    SetN2kPGN130306(msg,i,8.2+r*2,r*6.28,N2kWind_Apparent); Msgs.push_back(msg);
+    SetN2kPGN130310(msg,i,CToKelvin(15+r),CToKelvin(20+r),101300); Msgs.push_back(msg);
+    SetN2kPGN130311(msg,i,N2kts_MainCabinTemperature,CToKelvin(21+r),N2khs_InsideHumidity,40+r*10,101300); Msgs.push_back(msg);
+    SetN2kPGN130312(msg,i,1,N2kts_SeaTemperature,CToKelvin(15+r),N2kDoubleNA); Msgs.push_back(msg);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<tN2kMsg> Msgs;
+
+#if !defined(__OPTIMIZE__)
+  fprintf(stderr,"Warning: build is not optimized, set CMAKE_BUILD_TYPE to Release or RelWithDebInfo\n");
+#endif
+
+  for ( int a=1; a<argc; a++ ) {
+    FILE *f=fopen(argv[a],"rb");
+    if ( f==0 ) { fprintf(stderr,"Can not open %s\n",argv[a]); return 1; }
+    char *Line=0;
+    size_t LineCapacity=0;
+    tN2kMsg msg;
+    uint32_t timestamp;
+    while ( getline(&Line,&LineCapacity,f)>0 ) {
+      Line[strcspn(Line,"\r\n")]=0;
+      if ( SailmaxToN2k(Line,timestamp,msg) && HasCodec(msg) ) Msgs.push_back(msg);
+    }
+    free(Line);
+    fclose(f);
+  }
+
+  if ( Msgs.empty() ) AddBuiltinMessages(Msgs);
+
+  const int Rounds=5000000/Msgs.size()+1;
+  double HandSum=0, CodecSum=0;
+  uint64_t Start=HostMicros();
+  for ( int r=0; r<Rounds; r++ ) {
+    for ( size_t i=0; i<Msgs.size(); i++ ) HandSum+=HandParse(Msgs[i]);
+  }
+  uint64_t HandTime=HostMicros()-Start;
+  Start=HostMicros();
+  for ( int r=0; r<Rounds; r++ ) {
+    for ( size_t i=0; i<Msgs.size(); i++ ) CodecSum+=CodecParse(Msgs[i]);
+  }
+  uint64_t CodecTime=HostMicros()-Start;
+  if ( CodecTime==0 ) CodecTime=1;
+
+  double Parsed=(double)Msgs.size()*Rounds;
+  printf("Messages:          %lu\n",(unsigned long)Msgs.size());
+  printf("Hand written:      %.1f ns/message\n",1000.0*HandTime/Parsed);
+  printf("Field codec:       %.1f ns/message\n",1000.0*CodecTime/Parsed);
+  printf("Speedup:           %.2f\n",(double)HandTime/CodecTime);
+
+  if ( HandSum!=CodecSum ) {
+    fprintf(stderr,"Parsed values differ: %f vs %f\n",HandSum,CodecSum);
+    return 1;
+  }
+  return 0;
+}
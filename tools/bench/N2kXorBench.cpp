@@ -0,0 +1,140 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  benchmark for XOR delta encoding of N2k messages
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <N2kMsg.h>
+#include <SailmaxFormat.h>
+#include "HostPlatform.h"
+#include "N2kXorCodec.h"
+
+struct tMemory {
+  std::vector<uint8_t> Data;
+  size_t Pos;
+};
+
+static void WriteMemory(const uint8_t *Data, size_t len, void *Context) {
+  tMemory *Memory=(tMemory *)Context;
+  Memory->Data.insert(Memory->Data.end(),Data,Data+len);
+}
+
+static size_t ReadMemory(uint8_t *Data, size_t size, void *Context) {
+  tMemory *Memory=(tMemory *)Context;
+  size_t len=Memory->Data.size()-Memory->Pos;
+  if ( len>size ) len=size;
+  memcpy(Data,&Memory->Data[Memory->Pos],len);
+  Memory->Pos+=len;
+  return len;
+}
+
+int main(int argc, char *argv[]) {
+  if ( argc<2 ) {
+    fprintf(stderr,"Usage: n2klog-xorbench logfile...\n");
+    return 1;
+  }
+
+  std::vector<tN2kMsg> Msgs;
+  std::vector<uint32_t> Timestamps;
+  uint64_t TextSize=0;
+  uint64_t RawSize=0; // timestamp, PGN, priority, source, destination, length and data
+
+  for ( int a=1; a<argc; a++ ) {
+    FILE *f=fopen(argv[a],"rb");
+    if ( f==0 ) { fprintf(stderr,"Can not open %s\n",argv[a]); return 1; }
+    char *Line=0;
+    size_t LineCapacity=0;
+    ssize_t len;
+    tN2kMsg msg;
+    uint32_t timestamp;
+    while ( (len=getline(&Line,&LineCapacity,f))>0 ) {
+      TextSize+=len;
+      Line[strcspn(Line,"\r\n")]=0;
+      if ( !SailmaxToN2k(Line,timestamp,msg) ) continue;
+      Msgs.push_back(msg);
+      Timestamps.push_back(timestamp);
+      RawSize+=4+3+1+1+1+1+msg.DataLen;
+    }
+    free(Line);
+    fclose(f);
+  }
+  if ( Msgs.empty() ) {
+    fprintf(stderr,"No messages\n");
+    return 1;
+  }
+
+  tMemory Encoded;
+  Encoded.Pos=0;
+  uint64_t Start=HostMicros();
+  {
+    tN2kXorEncoder Encoder(WriteMemory,&Encoded);
+    for ( size_t i=0; i<Msgs.size(); i++ ) Encoder.Add(Msgs[i],Timestamps[i]);
+    Encoder.Close();
+  }
+  uint64_t EncodeTime=HostMicros()-Start;
+
+  // Verify and measure decoding
+  const int Rounds=20;
+  tN2kMsg msg;
+  uint32_t timestamp;
+  size_t Errors=0;
+  Start=HostMicros();
+  for ( int r=0; r<Rounds; r++ ) {
+    Encoded.Pos=0;
+    tN2kXorDecoder Decoder(ReadMemory,&Encoded);
+    size_t i=0;
+    while ( Decoder.Next(msg,timestamp) ) {
+      if ( r==0 && ( i>=Msgs.size() || timestamp!=Timestamps[i] || msg.PGN!=Msgs[i].PGN || msg.Source!=Msgs[i].Source ||
+                     msg.DataLen!=Msgs[i].DataLen || memcmp(msg.Data,Msgs[i].Data,msg.DataLen)!=0 ) ) Errors++;
+      i++;
+    }
+    if ( Decoder.IsError() || i!=Msgs.size() ) Errors++;
+  }
+  uint64_t DecodeTime=HostMicros()-Start;
+  if ( DecodeTime==0 ) DecodeTime=1;
+  if ( EncodeTime==0 ) EncodeTime=1;
+
+  printf("Messages:          %lu\n",(unsigned long)Msgs.size());
+  printf("Sailmax text:      %llu bytes\n",(unsigned long long)TextSize);
+  printf("Raw binary:        %llu bytes\n",(unsigned long long)RawSize);
+  printf("XOR encoded:       %lu bytes (%.2f bits/message)\n",(unsigned long)Encoded.Data.size(),8.0*Encoded.Data.size()/Msgs.size());
+  printf("Ratio text/xor:    %.2f\n",(double)TextSize/Encoded.Data.size());
+  printf("Ratio raw/xor:     %.2f\n",(double)RawSize/Encoded.Data.size());
+  printf("Encode:            %.1f MB/s raw\n",(double)RawSize/EncodeTime);
+  printf("Decode:            %.1f MB/s raw, %.2f M messages/s\n",
+         (double)RawSize*Rounds/DecodeTime,(double)Msgs.size()*Rounds/DecodeTime);
+  printf("Errors:            %lu\n",(unsigned long)Errors);
+
+  return ( Errors==0 ? 0 : 1 );
+}
@@ -0,0 +1,67 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  platform functions needed by the NMEA2000 library on a PC
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <time.h>
+#include <unistd.h>
+#include "HostPlatform.h"
+
+//*****************************************************************************
+uint64_t HostMicros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (uint64_t)ts.tv_sec*1000000+ts.tv_nsec/1000;
+}
+
+static tHostClock HostClock=0;
+static void *HostClockContext=0;
+
+//*****************************************************************************
+void HostSetClock(tHostClock Clock, void *Context) {
+  HostClock=Clock;
+  HostClockContext=Context;
+}
+
+extern "C" {
+
+// millis() and delay() must be implemented by application, see N2kDef.h
+uint32_t millis() {
+  if ( HostClock!=0 ) return (uint32_t)(HostClock(HostClockContext)/1000);
+  return (uint32_t)(HostMicros()/1000);
+}
+
+void delay(uint32_t ms) {
+  if ( HostClock!=0 ) return;
+  usleep((useconds_t)ms*1000);
+}
+
+}
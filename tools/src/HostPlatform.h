@@ -0,0 +1,61 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  platform functions needed by the NMEA2000 library on a PC
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _HostPlatform_h_
+#define _HostPlatform_h_
+
+#include <stdio.h>
+#include <N2kStream.h>
+
+/**
+ *  N2kStream writing to a stdio file, e.g. stdout for tN2kMsg::Print.
+ */
+class tStdioStream : public N2kStream {
+protected:
+  FILE *File;
+
+public:
+  tStdioStream(FILE *_File=stdout) : File(_File) {}
+  int read() { return -1; }
+  size_t write(const uint8_t* data, size_t size) { return fwrite(data,1,size,File); }
+};
+
+// Current time in microseconds from a monotonic clock.
+uint64_t HostMicros();
+
+// Virtual clock for simulations. While set, millis() returns Clock(Context)/1000
+// and delay() returns at once, since simulated time advances only by the simulation.
+typedef uint64_t (*tHostClock)(void *Context);
+void HostSetClock(tHostClock Clock, void *Context=0);
+
+#endif
@@ -0,0 +1,136 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  bulk decode of same PGN payloads to field arrays
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <string.h>
+#include "N2kBulkDecode.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//*****************************************************************************
+static inline uint32_t RawValue(const uint8_t *Data, uint8_t Width) {
+  uint32_t v=0;
+  for (uint8_t i=0; i<Width; i++) v|=(uint32_t)Data[i]<<(8*i);
+  return v;
+}
+
+//*****************************************************************************
+static void DecodeScaledScalar(const uint8_t *Data, size_t Stride, size_t Count,
+                               uint8_t Offset, uint8_t Width, bool Signed, float Resolution,
+                               float *Out, float NA) {
+  uint32_t Mask=0xffffffffUL>>(32-8*Width);
+  uint32_t RawNA=( Signed ? Mask>>1 : Mask );
+  int Shift=32-8*Width;
+  for (size_t i=0; i<Count; i++, Data+=Stride) {
+    uint32_t Raw=RawValue(Data+Offset,Width);
+    if ( Raw==RawNA ) {
+      Out[i]=NA;
+    } else if ( Signed ) {
+      Out[i]=((int32_t)(Raw<<Shift)>>Shift)*Resolution;
+    } else {
+      Out[i]=Raw*Resolution;
+    }
+  }
+}
+
+#if defined(__SSE2__)
+//*****************************************************************************
+// Raw values of 4 payloads in 32 bit lanes, not masked or sign extended
+static inline __m128i LoadRaw4(const uint8_t *Data, size_t Stride, uint8_t Offset, uint8_t Width, __m128i ByteShift) {
+  if ( Stride==8 ) {
+    // Two payloads per 128 bit load. Shift field to bottom of 64 bit lane
+    // and take low 32 bits of both lanes.
+    __m128i a=_mm_srl_epi64(_mm_loadu_si128((const __m128i *)Data),ByteShift);
+    __m128i b=_mm_srl_epi64(_mm_loadu_si128((const __m128i *)(Data+16)),ByteShift);
+    a=_mm_shuffle_epi32(a,_MM_SHUFFLE(3,1,2,0));
+    b=_mm_shuffle_epi32(b,_MM_SHUFFLE(3,1,2,0));
+    return _mm_unpacklo_epi64(a,b);
+  }
+  uint32_t r[4];
+  for (int j=0; j<4; j++) {
+    r[j]=0;
+    memcpy(&r[j],Data+j*Stride+Offset,Width); // little endian host
+  }
+  return _mm_loadu_si128((const __m128i *)r);
+}
+#endif
+
+//*****************************************************************************
+void N2kBulkDecodeScaled(const uint8_t *Data, size_t Stride, size_t Count,
+                         uint8_t Offset, uint8_t Width, bool Signed, float Resolution,
+                         float *Out, float NA) {
+  size_t i=0;
+#if defined(__SSE2__)
+  // Unsigned 4 byte values do not fit signed int32 conversion
+  if ( Width<4 || Signed ) {
+    uint32_t Mask=0xffffffffUL>>(32-8*Width);
+    int Shift=32-8*Width;
+    __m128i vMask=_mm_set1_epi32((int)Mask);
+    __m128i vRawNA=_mm_set1_epi32((int)( Signed ? Mask>>1 : Mask ));
+    __m128i ByteShift=_mm_cvtsi32_si128(8*Offset);
+    __m128i vShift=_mm_cvtsi32_si128(Shift);
+    __m128 vResolution=_mm_set1_ps(Resolution);
+    __m128 vNA=_mm_set1_ps(NA);
+    for (; i+4<=Count; i+=4, Data+=4*Stride) {
+      __m128i Raw=_mm_and_si128(LoadRaw4(Data,Stride,Offset,Width,ByteShift),vMask);
+      __m128i IsNA=_mm_cmpeq_epi32(Raw,vRawNA);
+      if ( Signed ) Raw=_mm_sra_epi32(_mm_sll_epi32(Raw,vShift),vShift);
+      __m128 v=_mm_mul_ps(_mm_cvtepi32_ps(Raw),vResolution);
+      __m128 NAMask=_mm_castsi128_ps(IsNA);
+      _mm_storeu_ps(Out+i,_mm_or_ps(_mm_and_ps(NAMask,vNA),_mm_andnot_ps(NAMask,v)));
+    }
+  }
+#endif
+  DecodeScaledScalar(Data,Stride,Count-i,Offset,Width,Signed,Resolution,Out+i,NA);
+}
+
+//*****************************************************************************
+void N2kBulkDecodeBits(const uint8_t *Data, size_t Stride, size_t Count,
+                       uint8_t Offset, uint8_t Shift, uint8_t Mask, uint8_t *Out) {
+  Data+=Offset;
+  for (size_t i=0; i<Count; i++, Data+=Stride) Out[i]=(*Data>>Shift) & Mask;
+}
+
+//*****************************************************************************
+size_t N2kPackPayloads(const tN2kMsg *Msgs, size_t Count, unsigned long PGN, size_t Length, uint8_t *Payloads) {
+  size_t Packed=0;
+  for (size_t i=0; i<Count; i++) {
+    if ( Msgs[i].PGN!=PGN ) continue;
+    size_t Len=( (size_t)Msgs[i].DataLen<Length ? (size_t)Msgs[i].DataLen : Length );
+    memcpy(Payloads,Msgs[i].Data,Len);
+    memset(Payloads+Len,0xff,Length-Len);
+    Payloads+=Length;
+    Packed++;
+  }
+  return Packed;
+}
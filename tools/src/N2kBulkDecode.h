@@ -0,0 +1,88 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  bulk decode of same PGN payloads to field arrays
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _N2kBulkDecode_h_
+#define _N2kBulkDecode_h_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <N2kMsg.h>
+
+/*
+ *  Bulk decode for analytics of many messages of same PGN. One call decodes
+ *  one field of all payloads into its own contiguous array (structure of
+ *  arrays). Payload i starts at Data+i*Stride, so an array of tN2kMsg can be
+ *  used directly with Data=Msgs[0].Data and Stride=sizeof(tN2kMsg), if all
+ *  messages have full length. That is slower than a ParseN2k loop, since
+ *  every payload is on its own cache line. Packed payloads (Stride=8 for
+ *  single frame PGNs, see N2kPackPayloads) handle short messages and are
+ *  fastest.
+ *
+ *  Packing an array of tN2kMsg costs about as much as a ParseN2k loop, so
+ *  pack plus bulk decode gives no gain for one pass over tN2kMsg. Bulk decode
+ *  pays off, when payloads are already stored packed or are decoded many
+ *  times (see n2klog-bulkbench).
+ *
+ *  Scaled fields are converted to float as raw*Resolution like float codecs
+ *  of N2kMessageCodecs.h. NA raw values give NA. With SSE2 four payloads are
+ *  converted at a time. Field is given by codec field descriptor:
+ *
+ *    N2kBulkDecodeScaled<tN2kWindSpeedFloatData::tWindSpeed>(Data,8,Count,WindSpeed);
+ *    N2kBulkDecodeBits<tN2kWindSpeedFloatData::tWindReference>(Data,8,Count,Reference);
+ */
+
+void N2kBulkDecodeScaled(const uint8_t *Data, size_t Stride, size_t Count,
+                         uint8_t Offset, uint8_t Width, bool Signed, float Resolution,
+                         float *Out, float NA=N2kFloatNA);
+
+void N2kBulkDecodeBits(const uint8_t *Data, size_t Stride, size_t Count,
+                       uint8_t Offset, uint8_t Shift, uint8_t Mask, uint8_t *Out);
+
+template<class tField>
+void N2kBulkDecodeScaled(const uint8_t *Data, size_t Stride, size_t Count, float *Out, float NA=N2kFloatNA) {
+  N2kBulkDecodeScaled(Data,Stride,Count,tField::ByteOffset,tField::ByteWidth,tField::IsSigned,
+                      (float)tField::Resolution(),Out,NA);
+}
+
+template<class tField>
+void N2kBulkDecodeBits(const uint8_t *Data, size_t Stride, size_t Count, uint8_t *Out) {
+  N2kBulkDecodeBits(Data,Stride,Count,tField::ByteOffset,tField::BitShift,tField::Mask,Out);
+}
+
+// Copies first Length bytes of messages with PGN to Payloads one after other.
+// Missing bytes of short messages are filled with 0xff, so fully missing
+// fields are NA. Field cut in the middle is not detected. Payloads must have
+// room for Count*Length bytes. Returns number of copied payloads.
+size_t N2kPackPayloads(const tN2kMsg *Msgs, size_t Count, unsigned long PGN, size_t Length, uint8_t *Payloads);
+
+#endif
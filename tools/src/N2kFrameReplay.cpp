@@ -0,0 +1,128 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  tNMEA2000 backend replaying raw CAN frame logs
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <unistd.h>
+#include "HostPlatform.h"
+#include "N2kFrameReplay.h"
+
+//*****************************************************************************
+tNMEA2000_FrameReplay::tNMEA2000_FrameReplay(tN2kFrameLogReader &_Reader, bool _Realtime) : tNMEA2000(), Reader(_Reader) {
+  Realtime=_Realtime;
+  NextTime=0;
+  HasNext=false;
+  LogStart=0;
+  HostStart=0;
+  TimeOffset=1000000;
+  Now=1000000; // Start at 1 s, since library uses 0 time as not set
+  ReplayedFrames=0;
+  SentFrames=0;
+  SetMode(N2km_ListenOnly);
+  if ( !Realtime ) HostSetClock(ClockHandler,this);
+}
+
+//*****************************************************************************
+tNMEA2000_FrameReplay::~tNMEA2000_FrameReplay() {
+  if ( !Realtime ) HostSetClock(0);
+}
+
+//*****************************************************************************
+bool tNMEA2000_FrameReplay::FetchNext() {
+  if ( !HasNext ) HasNext=Reader.Next(NextFrame,NextTime);
+  return HasNext;
+}
+
+//*****************************************************************************
+bool tNMEA2000_FrameReplay::CANOpen() {
+  if ( FetchNext() ) LogStart=NextTime;
+  // Fast mode clock follows log timestamps. Library uses 0 time as not set,
+  // so log started near 0 will be shifted by 1 s.
+  TimeOffset=( LogStart<1000000 ? 1000000 : 0 );
+  Now=LogStart+TimeOffset;
+  HostStart=HostMicros();
+  return true;
+}
+
+//*****************************************************************************
+bool tNMEA2000_FrameReplay::CANSendFrame(unsigned long /*id*/, unsigned char /*len*/, const unsigned char * /*buf*/, bool /*wait_sent*/) {
+  SentFrames++;
+  return true;
+}
+
+//*****************************************************************************
+bool tNMEA2000_FrameReplay::CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf) {
+  if ( !FetchNext() ) return false;
+
+  if ( Realtime ) {
+    if ( HostMicros()-HostStart<NextTime-LogStart ) return false;
+  } else {
+    Now=NextTime+TimeOffset;
+  }
+
+  id=NextFrame.id;
+  len=NextFrame.len;
+  for ( int i=0; i<len; i++ ) buf[i]=NextFrame.buf[i];
+  HasNext=false;
+  ReplayedFrames++;
+  return true;
+}
+
+//*****************************************************************************
+// Library stamps frames of one batch with same millis(), so in fast mode batch
+// ends, when log time changes. Then messages get their original time.
+int tNMEA2000_FrameReplay::CANGetFrames(tN2kCANFrame *Frames, int MaxFrames) {
+  int Count=0;
+  uint64_t BatchTime=0;
+  while ( Count<MaxFrames && FetchNext() ) {
+    if ( Count==0 ) {
+      BatchTime=NextTime;
+    } else if ( !Realtime && NextTime!=BatchTime ) {
+      break;
+    }
+    if ( !CANGetFrame(Frames[Count].id,Frames[Count].len,Frames[Count].buf) ) break;
+    Count++;
+  }
+  return Count;
+}
+
+//*****************************************************************************
+void tNMEA2000_FrameReplay::Run() {
+  ParseMessages(); // Opens and sets start times
+  while ( !IsEnded() ) {
+    if ( Realtime ) {
+      uint64_t Elapsed=HostMicros()-HostStart;
+      uint64_t Offset=NextTime-LogStart;
+      if ( Offset>Elapsed ) usleep((useconds_t)(Offset-Elapsed<100000?Offset-Elapsed:100000));
+    }
+    ParseMessages();
+  }
+}
@@ -0,0 +1,87 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  tNMEA2000 backend replaying raw CAN frame logs
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _N2kFrameReplay_h_
+#define _N2kFrameReplay_h_
+
+#include <stdint.h>
+#include <NMEA2000.h>
+#include <N2kFrameLog.h>
+
+/**
+ *  tNMEA2000 node, which receives frames from frame log captured with
+ *  tNMEA2000::SetFrameCaptureHandler and tN2kFrameLogWriter. Frames go
+ *  through normal fast packet and TP reassembly, so replay gives same
+ *  messages as original device got.
+ *
+ *  In realtime mode frames will be given at their original interframe timing
+ *  by host clock. In fast mode frames will be given as fast as possible and
+ *  millis() follows frame log timestamps, so library timeouts behave like
+ *  in original capture. Frames sent by the node will be counted and discarded.
+ */
+class tNMEA2000_FrameReplay : public tNMEA2000 {
+protected:
+  tN2kFrameLogReader &Reader;
+  bool Realtime;
+  tN2kCANFrame NextFrame;
+  uint64_t NextTime;
+  bool HasNext;
+  uint64_t LogStart;
+  uint64_t HostStart;
+  uint64_t TimeOffset;
+  uint64_t Now; // Virtual clock in fast mode
+  uint32_t ReplayedFrames;
+  uint32_t SentFrames;
+
+protected:
+  static uint64_t ClockHandler(void *Context) { return ((tNMEA2000_FrameReplay *)Context)->Now; }
+  bool FetchNext();
+  bool CANSendFrame(unsigned long id, unsigned char len, const unsigned char *buf, bool wait_sent=true);
+  bool CANOpen();
+  bool CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf);
+  int CANGetFrames(tN2kCANFrame *Frames, int MaxFrames);
+
+public:
+  tNMEA2000_FrameReplay(tN2kFrameLogReader &_Reader, bool _Realtime=false);
+  virtual ~tNMEA2000_FrameReplay();
+
+  // Returns true, when all frames have been given to library.
+  bool IsEnded() { return !FetchNext(); }
+  // Calls ParseMessages until log ends. In realtime mode sleeps between frames.
+  void Run();
+
+  uint32_t GetReplayedFrames() const { return ReplayedFrames; }
+  uint32_t GetSentFrames() const { return SentFrames; }
+};
+
+#endif
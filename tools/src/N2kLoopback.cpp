@@ -0,0 +1,241 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  in-memory loopback CAN bus for running tNMEA2000 nodes on a PC
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <string.h>
+#include <algorithm>
+#include "HostPlatform.h"
+#include "N2kLoopback.h"
+
+//*****************************************************************************
+tN2kLoopbackBus::tN2kLoopbackBus(uint32_t _Bitrate) {
+  Now=1000000; // Start at 1 s, since library uses 0 time as not set
+  BusFreeAt=Now;
+  Bitrate=_Bitrate;
+  LossThreshold=0;
+  LossSeed=1;
+  DropFrames=0;
+  memset(&Statistics,0,sizeof(Statistics));
+  HostSetClock(ClockHandler,this);
+}
+
+//*****************************************************************************
+tN2kLoopbackBus::~tN2kLoopbackBus() {
+  for ( size_t i=0; i<Nodes.size(); i++ ) Nodes[i]->Bus=0;
+  HostSetClock(0);
+}
+
+//*****************************************************************************
+void tN2kLoopbackBus::Attach(tNMEA2000_Loopback *Node) {
+  Nodes.push_back(Node);
+}
+
+//*****************************************************************************
+void tN2kLoopbackBus::Detach(tNMEA2000_Loopback *Node) {
+  Nodes.erase(std::remove(Nodes.begin(),Nodes.end(),Node),Nodes.end());
+}
+
+//*****************************************************************************
+void tN2kLoopbackBus::SetFrameLoss(double Probability, uint32_t Seed) {
+  if ( Probability<=0 ) {
+    LossThreshold=0;
+  } else if ( Probability>=1 ) {
+    LossThreshold=0xffffffff;
+  } else {
+    LossThreshold=(uint32_t)(Probability*4294967296.0);
+  }
+  LossSeed=(Seed!=0?Seed:1);
+}
+
+//*****************************************************************************
+// xorshift32
+uint32_t tN2kLoopbackBus::Random() {
+  LossSeed^=LossSeed<<13;
+  LossSeed^=LossSeed>>17;
+  LossSeed^=LossSeed<<5;
+  return LossSeed;
+}
+
+//*****************************************************************************
+bool tN2kLoopbackBus::LoseFrame() {
+  if ( LossThreshold==0 ) return false;
+  if ( LossThreshold==0xffffffff ) return true;
+  return Random()<LossThreshold;
+}
+
+//*****************************************************************************
+void tN2kLoopbackBus::AdvanceTo(uint64_t Time) {
+  while ( true ) {
+    // Find when next transmission starts and which frame wins arbitration
+    tNMEA2000_Loopback *Winner=0;
+    uint64_t Start=0;
+    bool Pending=false;
+    for ( size_t i=0; i<Nodes.size(); i++ ) {
+      if ( Nodes[i]->TxQueue.empty() ) continue;
+      uint64_t Ready=std::max(BusFreeAt,Nodes[i]->TxQueue.front().QueuedAt);
+      if ( !Pending || Ready<Start ) Start=Ready;
+      Pending=true;
+    }
+    if ( !Pending || Start>Time ) break;
+    for ( size_t i=0; i<Nodes.size(); i++ ) {
+      if ( Nodes[i]->TxQueue.empty() || Nodes[i]->TxQueue.front().QueuedAt>Start ) continue;
+      if ( Winner==0 || Nodes[i]->TxQueue.front().Frame.id<Winner->TxQueue.front().Frame.id ) Winner=Nodes[i];
+    }
+    if ( Winner==0 ) break;
+
+    tN2kCANFrame Frame=Winner->TxQueue.front().Frame;
+    uint64_t End=Start+FrameTime(Frame.len);
+    if ( End>Time ) break;
+
+    Winner->TxQueue.pop_front();
+    Winner->NodeStatistics.TxFrames++;
+    Now=End;
+    BusFreeAt=End;
+    Statistics.Frames++;
+    Statistics.BusyTime+=End-Start;
+
+    bool DropAll=false;
+    if ( DropFrames>0 ) { DropFrames--; DropAll=true; }
+    for ( size_t i=0; i<Nodes.size(); i++ ) {
+      if ( Nodes[i]==Winner ) continue;
+      if ( DropAll || LoseFrame() ) {
+        Nodes[i]->NodeStatistics.LostFrames++;
+        Statistics.LostFrames++;
+        continue;
+      }
+      Nodes[i]->Receive(Frame);
+    }
+  }
+
+  if ( Time>Now ) Now=Time;
+}
+
+//*****************************************************************************
+void tN2kLoopbackBus::Run(uint32_t ms, uint32_t StepUs) {
+  if ( StepUs==0 ) StepUs=1;
+  uint64_t End=Now+(uint64_t)ms*1000;
+  while ( Now<End ) {
+    uint64_t Next=Now+StepUs;
+    AdvanceTo(Next<End?Next:End);
+    for ( size_t i=0; i<Nodes.size(); i++ ) Nodes[i]->ParseMessages();
+  }
+}
+
+//*****************************************************************************
+bool tN2kLoopbackBus::HasPendingFrames() const {
+  for ( size_t i=0; i<Nodes.size(); i++ ) {
+    if ( !Nodes[i]->TxQueue.empty() || !Nodes[i]->RxQueue.empty() ) return true;
+  }
+  return false;
+}
+
+//*****************************************************************************
+double tN2kLoopbackBus::GetLoad(uint64_t Since) const {
+  if ( Since==0 ) Since=1000000;
+  if ( Now<=Since ) return 0;
+  return (double)Statistics.BusyTime/(Now-Since);
+}
+
+//*****************************************************************************
+tNMEA2000_Loopback::tNMEA2000_Loopback(tN2kLoopbackBus &_Bus) : tNMEA2000() {
+  Bus=&_Bus;
+  MaxTxFrames=32;
+  MaxRxFrames=64;
+  memset(&NodeStatistics,0,sizeof(NodeStatistics));
+  Bus->Attach(this);
+}
+
+//*****************************************************************************
+tNMEA2000_Loopback::~tNMEA2000_Loopback() {
+  if ( Bus!=0 ) Bus->Detach(this);
+}
+
+//*****************************************************************************
+bool tNMEA2000_Loopback::CANSendFrame(unsigned long id, unsigned char len, const unsigned char *buf, bool /*wait_sent*/) {
+  if ( Bus==0 ) return false;
+  if ( TxQueue.size()>=MaxTxFrames ) {
+    NodeStatistics.TxQueueFull++;
+    return false;
+  }
+
+  tQueuedFrame Queued;
+  Queued.Frame.id=id;
+  Queued.Frame.len=(len>8?8:len);
+  memset(Queued.Frame.buf,0,sizeof(Queued.Frame.buf));
+  memcpy(Queued.Frame.buf,buf,Queued.Frame.len);
+  Queued.QueuedAt=Bus->Now;
+  TxQueue.push_back(Queued);
+
+  return true;
+}
+
+//*****************************************************************************
+bool tNMEA2000_Loopback::CANOpen() {
+  return ( Bus!=0 );
+}
+
+//*****************************************************************************
+bool tNMEA2000_Loopback::CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf) {
+  if ( RxQueue.empty() ) return false;
+
+  const tN2kCANFrame &Frame=RxQueue.front();
+  id=Frame.id;
+  len=Frame.len;
+  memcpy(buf,Frame.buf,8);
+  RxQueue.pop_front();
+
+  return true;
+}
+
+//*****************************************************************************
+int tNMEA2000_Loopback::CANGetFrames(tN2kCANFrame *Frames, int MaxFrames) {
+  int nFrames=0;
+
+  for ( ; nFrames<MaxFrames && !RxQueue.empty(); nFrames++ ) {
+    Frames[nFrames]=RxQueue.front();
+    RxQueue.pop_front();
+  }
+
+  return nFrames;
+}
+
+//*****************************************************************************
+void tNMEA2000_Loopback::Receive(const tN2kCANFrame &Frame) {
+  if ( RxQueue.size()>=MaxRxFrames ) {
+    NodeStatistics.RxOverflows++;
+    Bus->Statistics.RxOverflows++;
+    return;
+  }
+
+  NodeStatistics.RxFrames++;
+  RxQueue.push_back(Frame);
+}
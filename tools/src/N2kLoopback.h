@@ -0,0 +1,167 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  in-memory loopback CAN bus for running tNMEA2000 nodes on a PC
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _N2kLoopback_h_
+#define _N2kLoopback_h_
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include <NMEA2000.h>
+
+class tNMEA2000_Loopback;
+
+/**
+ *  Simulated CAN bus connecting tNMEA2000_Loopback nodes in one process.
+ *
+ *  Bus has own virtual clock in microseconds, which is also used for millis()
+ *  while bus exists, so address claim, fast packet and TP timing is
+ *  deterministic. Frames sent by nodes wait in node transmit queue. When bus
+ *  is free, lowest CAN id of queued frames wins arbitration and is delivered
+ *  to all other nodes after its transmit time at set bitrate. Frame time is
+ *  67+8*len bits of extended data frame plus 3 bits interframe space, so bit
+ *  stuffing is not simulated.
+ *
+ *  Frame loss can be injected per receiver with probability from
+ *  deterministic random generator or for next n frames.
+ */
+class tN2kLoopbackBus {
+public:
+  struct tStatistics {
+    uint64_t Frames;       // Frames won arbitration and sent
+    uint64_t BusyTime;     // us bus has been transmitting
+    uint64_t LostFrames;   // Receptions dropped by loss injection
+    uint64_t RxOverflows;  // Receptions dropped by full node receive queue
+  };
+
+protected:
+  friend class tNMEA2000_Loopback;
+
+  std::vector<tNMEA2000_Loopback *> Nodes;
+  uint64_t Now;
+  uint64_t BusFreeAt;
+  uint32_t Bitrate;
+  uint32_t LossThreshold; // Loss probability scaled to 2^32
+  uint32_t LossSeed;
+  uint32_t DropFrames;
+  tStatistics Statistics;
+
+protected:
+  static uint64_t ClockHandler(void *Context) { return ((tN2kLoopbackBus *)Context)->Now; }
+  void Attach(tNMEA2000_Loopback *Node);
+  void Detach(tNMEA2000_Loopback *Node);
+  uint32_t Random();
+  bool LoseFrame();
+
+public:
+  tN2kLoopbackBus(uint32_t _Bitrate=250000);
+  ~tN2kLoopbackBus();
+
+  void SetBitrate(uint32_t _Bitrate) { Bitrate=_Bitrate; }
+  uint32_t GetBitrate() const { return Bitrate; }
+  // Probability 0.0-1.0 that one node does not receive frame.
+  void SetFrameLoss(double Probability, uint32_t Seed=1);
+  // Next Count frames will not be received by any node.
+  void DropNextFrames(uint32_t Count) { DropFrames=Count; }
+
+  // Bus transmit time in us for frame with len data bytes.
+  uint32_t FrameTime(unsigned char len) const { return (uint32_t)(((67+8*(uint64_t)len+3)*1000000+Bitrate-1)/Bitrate); }
+
+  uint64_t GetMicros() const { return Now; }
+  uint32_t GetMillis() const { return (uint32_t)(Now/1000); }
+
+  // Transmits queued frames, which will be completely sent until Time us.
+  void AdvanceTo(uint64_t Time);
+  void Advance(uint32_t us) { AdvanceTo(Now+us); }
+  // Runs bus and nodes for ms milliseconds. Nodes ParseMessages will be
+  // called every StepUs.
+  void Run(uint32_t ms, uint32_t StepUs=1000);
+  // Returns true, if there are frames waiting in any transmit or receive queue.
+  bool HasPendingFrames() const;
+
+  const tStatistics &GetStatistics() const { return Statistics; }
+  // Portion of time bus has been transmitting since Since us.
+  double GetLoad(uint64_t Since=0) const;
+  size_t GetNodeCount() const { return Nodes.size(); }
+};
+
+/**
+ *  tNMEA2000 node on tN2kLoopbackBus. Node does not receive frames it sends
+ *  itself, like with real CAN controller.
+ */
+class tNMEA2000_Loopback : public tNMEA2000 {
+public:
+  struct tNodeStatistics {
+    uint32_t TxFrames;
+    uint32_t RxFrames;
+    uint32_t TxQueueFull;
+    uint32_t RxOverflows;
+    uint32_t LostFrames;
+  };
+
+protected:
+  friend class tN2kLoopbackBus;
+
+  struct tQueuedFrame {
+    tN2kCANFrame Frame;
+    uint64_t QueuedAt;
+  };
+
+  tN2kLoopbackBus *Bus;
+  std::deque<tQueuedFrame> TxQueue;
+  std::deque<tN2kCANFrame> RxQueue;
+  size_t MaxTxFrames;
+  size_t MaxRxFrames;
+  tNodeStatistics NodeStatistics;
+
+protected:
+  bool CANSendFrame(unsigned long id, unsigned char len, const unsigned char *buf, bool wait_sent=true);
+  bool CANOpen();
+  bool CANGetFrame(unsigned long &id, unsigned char &len, unsigned char *buf);
+  int CANGetFrames(tN2kCANFrame *Frames, int MaxFrames);
+  uint16_t CANGetPendingFrames() { return (uint16_t)(RxQueue.size()>0xffff?0xffff:RxQueue.size()); }
+  void Receive(const tN2kCANFrame &Frame);
+
+public:
+  tNMEA2000_Loopback(tN2kLoopbackBus &_Bus);
+  virtual ~tNMEA2000_Loopback();
+
+  // Driver queue sizes. Defaults are 32 transmit and 64 receive frames.
+  void SetTxQueueSize(size_t Frames) { MaxTxFrames=Frames; }
+  void SetRxQueueSize(size_t Frames) { MaxRxFrames=Frames; }
+  const tNodeStatistics &GetNodeStatistics() const { return NodeStatistics; }
+  size_t GetTxPending() const { return TxQueue.size(); }
+  size_t GetRxPending() const { return RxQueue.size(); }
+};
+
+#endif
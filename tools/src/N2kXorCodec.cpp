@@ -0,0 +1,383 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  binary log encoding with XOR deltas per PGN and source
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <string.h>
+#include "N2kXorCodec.h"
+
+static const uint8_t XorMagic[5]={'N','2','K','X',1};
+static const uint8_t NoWindow=0xff;
+
+//*****************************************************************************
+static inline uint64_t BitMask(int Bits) {
+  return ( Bits>=64 ? ~(uint64_t)0 : ((uint64_t)1<<Bits)-1 );
+}
+
+//*****************************************************************************
+tN2kXorCodecBase::tN2kXorCodecBase() {
+  Reset();
+}
+
+//*****************************************************************************
+void tN2kXorCodecBase::Reset() {
+  Streams.clear();
+  LastTimestamp=0;
+  LastDelta=0;
+  Messages=0;
+}
+
+//*****************************************************************************
+// Bits needed for stream index including codes for new stream and end.
+int tN2kXorCodecBase::StreamBits() const {
+  size_t Codes=Streams.size()+2;
+  int Bits=1;
+  while ( ((size_t)1<<Bits)<Codes ) Bits++;
+  return Bits;
+}
+
+//*****************************************************************************
+tN2kXorCodecBase::tStream &tN2kXorCodecBase::NewStream(unsigned long PGN, unsigned char Source) {
+  Streams.push_back(tStream());
+  tStream &Stream=Streams.back();
+  Stream.PGN=PGN;
+  Stream.Source=Source;
+  Stream.Priority=6;
+  Stream.Destination=0xff;
+  Stream.DataLen=0;
+  memset(Stream.Words,0,sizeof(Stream.Words));
+  memset(Stream.Leading,NoWindow,sizeof(Stream.Leading));
+  memset(Stream.Trailing,NoWindow,sizeof(Stream.Trailing));
+  return Stream;
+}
+
+//*****************************************************************************
+void tN2kXorCodecBase::ToWords(const unsigned char *Data, int DataLen, uint64_t *Words) {
+  memset(Words,0,MaxWords*sizeof(uint64_t));
+  for ( int i=0; i<DataLen; i++ ) Words[i>>3]|=(uint64_t)Data[i]<<(8*(i&7));
+}
+
+//*****************************************************************************
+tN2kXorEncoder::tN2kXorEncoder(tWriteHandler _WriteHandler, void *_Context) {
+  WriteHandler=_WriteHandler;
+  Context=_Context;
+  BufferPos=0;
+  BitBuffer=0;
+  BitCount=0;
+  BytesWritten=0;
+  Started=false;
+}
+
+//*****************************************************************************
+tN2kXorEncoder::~tN2kXorEncoder() {
+  if ( Started ) Close();
+}
+
+//*****************************************************************************
+void tN2kXorEncoder::FlushBuffer() {
+  if ( BufferPos>0 && WriteHandler!=0 ) WriteHandler(Buffer,BufferPos,Context);
+  BytesWritten+=BufferPos;
+  BufferPos=0;
+}
+
+//*****************************************************************************
+void tN2kXorEncoder::PutBits(uint64_t Value, int Bits) {
+  if ( Bits>32 ) {
+    PutBits(Value>>32,Bits-32);
+    Bits=32;
+  }
+  if ( Bits<=0 ) return;
+  // BitCount is always <8 here, so 32 more bits fit.
+  BitBuffer=(BitBuffer<<Bits) | (Value & BitMask(Bits));
+  BitCount+=Bits;
+  while ( BitCount>=8 ) {
+    BitCount-=8;
+    Buffer[BufferPos++]=(uint8_t)(BitBuffer>>BitCount);
+    if ( BufferPos==sizeof(Buffer) ) FlushBuffer();
+  }
+}
+
+//*****************************************************************************
+void tN2kXorEncoder::EncodeTime(uint32_t timestamp) {
+  int64_t Delta=(int32_t)(timestamp-LastTimestamp);
+  int64_t DoD=Delta-LastDelta;
+
+  if ( DoD==0 ) {
+    PutBits(0,1);
+  } else if ( DoD>=-64 && DoD<64 ) {
+    PutBits(0x2,2); PutBits(DoD,7);
+  } else if ( DoD>=-2048 && DoD<2048 ) {
+    PutBits(0x6,3); PutBits(DoD,12);
+  } else if ( DoD>=-524288 && DoD<524288 ) {
+    PutBits(0xe,4); PutBits(DoD,20);
+  } else {
+    // Delta itself, since delta of delta may need 33 bits
+    PutBits(0xf,4); PutBits((uint32_t)Delta,32);
+  }
+
+  LastTimestamp=timestamp;
+  LastDelta=Delta;
+}
+
+//*****************************************************************************
+void tN2kXorEncoder::Add(const tN2kMsg &msg, uint32_t timestamp) {
+  if ( !Started ) {
+    Reset();
+    StreamIndex.clear();
+    for ( size_t i=0; i<sizeof(XorMagic); i++ ) PutBits(XorMagic[i],8);
+    Started=true;
+  }
+
+  int DataLen=(msg.DataLen<=tN2kMsg::MaxDataLen?msg.DataLen:tN2kMsg::MaxDataLen);
+  uint32_t key=Key(msg.PGN,msg.Source);
+  std::unordered_map<uint32_t,size_t>::iterator it=StreamIndex.find(key);
+  size_t Index;
+  if ( it!=StreamIndex.end() ) {
+    Index=it->second;
+    PutBits(Index,StreamBits());
+  } else {
+    PutBits(Streams.size(),StreamBits());
+    PutBits(msg.PGN,18);
+    PutBits(msg.Source,8);
+    Index=Streams.size();
+    NewStream(msg.PGN,msg.Source);
+    StreamIndex[key]=Index;
+  }
+  tStream &Stream=Streams[Index];
+
+  EncodeTime(timestamp);
+
+  if ( Stream.Priority==msg.Priority && Stream.Destination==msg.Destination && Stream.DataLen==DataLen ) {
+    PutBits(0,1);
+  } else {
+    PutBits(1,1);
+    PutBits(msg.Priority,3);
+    PutBits(msg.Destination,8);
+    PutBits(DataLen,8);
+    Stream.Priority=msg.Priority&0x7;
+    Stream.Destination=msg.Destination;
+    Stream.DataLen=DataLen;
+  }
+
+  uint64_t Words[MaxWords];
+  ToWords(msg.Data,DataLen,Words);
+  for ( int w=0; w<(DataLen+7)/8; w++ ) {
+    uint64_t Xor=Words[w]^Stream.Words[w];
+    if ( Xor==0 ) {
+      PutBits(0,1);
+      continue;
+    }
+    int Leading=__builtin_clzll(Xor);
+    int Trailing=__builtin_ctzll(Xor);
+    // Use previous window, if it fits and is not much wider than a new window
+    // with its 12 bit header. E.g. first message of stream sets a full window.
+    if ( Stream.Leading[w]!=NoWindow && Leading>=Stream.Leading[w] && Trailing>=Stream.Trailing[w] &&
+         (Leading-Stream.Leading[w])+(Trailing-Stream.Trailing[w])<=12 ) {
+      PutBits(0x2,2);
+      PutBits(Xor>>Stream.Trailing[w],64-Stream.Leading[w]-Stream.Trailing[w]);
+    } else {
+      int Meaningful=64-Leading-Trailing;
+      PutBits(0x3,2);
+      PutBits(Leading,6);
+      PutBits(Meaningful-1,6);
+      PutBits(Xor>>Trailing,Meaningful);
+      Stream.Leading[w]=Leading;
+      Stream.Trailing[w]=Trailing;
+    }
+  }
+  memcpy(Stream.Words,Words,sizeof(Words));
+  Messages++;
+}
+
+//*****************************************************************************
+void tN2kXorEncoder::Close() {
+  if ( !Started ) {
+    for ( size_t i=0; i<sizeof(XorMagic); i++ ) PutBits(XorMagic[i],8);
+  }
+  PutBits(Streams.size()+1,StreamBits());
+  if ( BitCount>0 ) PutBits(0,8-BitCount);
+  FlushBuffer();
+  Started=false;
+  Reset();
+  StreamIndex.clear();
+}
+
+//*****************************************************************************
+tN2kXorDecoder::tN2kXorDecoder(tReadHandler _ReadHandler, void *_Context) {
+  ReadHandler=_ReadHandler;
+  Context=_Context;
+  BufferPos=0;
+  BufferLen=0;
+  BitBuffer=0;
+  BitCount=0;
+  Started=false;
+  Ended=false;
+  Error=false;
+}
+
+//*****************************************************************************
+bool tN2kXorDecoder::Fill(int Bits) {
+  while ( BitCount<Bits ) {
+    if ( BufferPos==BufferLen ) {
+      BufferPos=0;
+      BufferLen=(ReadHandler!=0?ReadHandler(Buffer,sizeof(Buffer),Context):0);
+      if ( BufferLen==0 ) return false;
+    }
+    BitBuffer=(BitBuffer<<8) | Buffer[BufferPos++];
+    BitCount+=8;
+  }
+  return true;
+}
+
+//*****************************************************************************
+bool tN2kXorDecoder::GetBits(int Bits, uint64_t &Value) {
+  if ( Bits>32 ) {
+    uint64_t High;
+    if ( !GetBits(Bits-32,High) ) return false;
+    if ( !GetBits(32,Value) ) return false;
+    Value|=High<<32;
+    return true;
+  }
+  if ( !Fill(Bits) ) return false;
+  BitCount-=Bits;
+  Value=(BitBuffer>>BitCount) & BitMask(Bits);
+  return true;
+}
+
+//*****************************************************************************
+static inline int64_t SignExtend(uint64_t Value, int Bits) {
+  return (int64_t)(Value<<(64-Bits))>>(64-Bits);
+}
+
+//*****************************************************************************
+bool tN2kXorDecoder::DecodeTime(uint32_t &timestamp) {
+  uint64_t Bit,Value;
+  int64_t Delta;
+
+  if ( !GetBits(1,Bit) ) return false;
+  if ( Bit==0 ) {
+    Delta=LastDelta;
+  } else {
+    int Prefix=1;
+    while ( Prefix<4 ) {
+      if ( !GetBits(1,Bit) ) return false;
+      if ( Bit==0 ) break;
+      Prefix++;
+    }
+    switch ( Prefix ) {
+      case 1: if ( !GetBits(7,Value) ) return false; Delta=LastDelta+SignExtend(Value,7); break;
+      case 2: if ( !GetBits(12,Value) ) return false; Delta=LastDelta+SignExtend(Value,12); break;
+      case 3: if ( !GetBits(20,Value) ) return false; Delta=LastDelta+SignExtend(Value,20); break;
+      default: if ( !GetBits(32,Value) ) return false; Delta=(int32_t)(uint32_t)Value; break;
+    }
+  }
+
+  LastTimestamp+=(uint32_t)Delta;
+  LastDelta=Delta;
+  timestamp=LastTimestamp;
+  return true;
+}
+
+//*****************************************************************************
+bool tN2kXorDecoder::Next(tN2kMsg &msg, uint32_t &timestamp) {
+  uint64_t Value;
+
+  if ( Ended || Error ) return false;
+
+  if ( !Started ) {
+    Reset();
+    for ( size_t i=0; i<sizeof(XorMagic); i++ ) {
+      if ( !GetBits(8,Value) || Value!=XorMagic[i] ) { Error=true; return false; }
+    }
+    Started=true;
+  }
+
+  if ( !GetBits(StreamBits(),Value) ) { Error=true; return false; }
+  if ( Value==Streams.size()+1 ) {
+    Ended=true;
+    return false;
+  }
+  if ( Value>Streams.size() ) { Error=true; return false; }
+  if ( Value==Streams.size() ) {
+    uint64_t PGN,Source;
+    if ( !GetBits(18,PGN) || !GetBits(8,Source) ) { Error=true; return false; }
+    NewStream(PGN,Source);
+  }
+  tStream &Stream=Streams[Value];
+
+  if ( !DecodeTime(timestamp) || !GetBits(1,Value) ) { Error=true; return false; }
+  if ( Value!=0 ) {
+    uint64_t Priority,Destination,DataLen;
+    if ( !GetBits(3,Priority) || !GetBits(8,Destination) || !GetBits(8,DataLen) || DataLen>tN2kMsg::MaxDataLen ) {
+      Error=true;
+      return false;
+    }
+    Stream.Priority=Priority;
+    Stream.Destination=Destination;
+    Stream.DataLen=DataLen;
+  }
+
+  for ( int w=0; w<(Stream.DataLen+7)/8; w++ ) {
+    if ( !GetBits(1,Value) ) { Error=true; return false; }
+    if ( Value==0 ) continue;
+    if ( !GetBits(1,Value) ) { Error=true; return false; }
+    uint64_t Xor;
+    if ( Value==0 ) {
+      if ( Stream.Leading[w]==NoWindow ) { Error=true; return false; }
+      if ( !GetBits(64-Stream.Leading[w]-Stream.Trailing[w],Xor) ) { Error=true; return false; }
+      Xor<<=Stream.Trailing[w];
+    } else {
+      uint64_t Leading,Meaningful;
+      if ( !GetBits(6,Leading) || !GetBits(6,Meaningful) ) { Error=true; return false; }
+      Meaningful++;
+      if ( Leading+Meaningful>64 ) { Error=true; return false; }
+      if ( !GetBits(Meaningful,Xor) ) { Error=true; return false; }
+      Stream.Leading[w]=Leading;
+      Stream.Trailing[w]=64-Leading-Meaningful;
+      Xor<<=Stream.Trailing[w];
+    }
+    Stream.Words[w]^=Xor;
+  }
+  // Words after new length must be zero for next delta.
+  for ( int w=(Stream.DataLen+7)/8; w<MaxWords; w++ ) Stream.Words[w]=0;
+  if ( (Stream.DataLen&7)!=0 ) Stream.Words[Stream.DataLen>>3]&=BitMask(8*(Stream.DataLen&7));
+
+  msg.Clear();
+  msg.SetPGN(Stream.PGN);
+  msg.Source=Stream.Source;
+  msg.Priority=Stream.Priority;
+  msg.Destination=Stream.Destination;
+  msg.DataLen=Stream.DataLen;
+  for ( int i=0; i<Stream.DataLen; i++ ) msg.Data[i]=(unsigned char)(Stream.Words[i>>3]>>(8*(i&7)));
+  msg.MsgTime=timestamp;
+  Messages++;
+  return true;
+}
@@ -0,0 +1,164 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  binary log encoding with XOR deltas per PGN and source
+      * Author:   © Ronnie Zeiller, 2018
+      * Every message is XORed with the previous message of same PGN and
+      * source. The result is bit packed in 64 bit words by leading and
+      * trailing zeros like in Facebook's Gorilla time series database.
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _N2kXorCodec_h_
+#define _N2kXorCodec_h_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <unordered_map>
+#include <N2kMsg.h>
+
+/*
+ *  Stream format. After the 5 byte header "N2KX\x01" follows one bit packed
+ *  record per message, most significant bit first:
+ *
+ *  stream   ceil(log2(streams+2)) bits. Index of known (PGN,source) stream,
+ *           streams = new stream with 18 bit PGN and 8 bit source following,
+ *           streams+1 = end of data.
+ *  time     delta of delta to previous message
+ *           0 | 10+7 bits | 110+12 bits | 1110+20 bits | 1111+32 bits
+ *  header   0 = priority, destination and length same as previous message of
+ *           stream, 1 + 3 bit priority + 8 bit destination + 8 bit length
+ *  data     for every 64 bit little endian word of data:
+ *           0 = same as previous, 10 + meaningful bits within previous window,
+ *           11 + 6 bit leading zeros + 6 bit length-1 + meaningful bits
+ */
+
+class tN2kXorCodecBase {
+public:
+  static const int MaxWords=(tN2kMsg::MaxDataLen+7)/8;
+
+protected:
+  struct tStream {
+    unsigned long PGN;
+    unsigned char Source;
+    unsigned char Priority;
+    unsigned char Destination;
+    unsigned char DataLen;
+    uint64_t Words[MaxWords];
+    uint8_t Leading[MaxWords];
+    uint8_t Trailing[MaxWords];
+  };
+
+  std::vector<tStream> Streams;
+  uint32_t LastTimestamp;
+  int64_t LastDelta;
+  uint32_t Messages;
+
+protected:
+  static uint32_t Key(unsigned long PGN, unsigned char Source) { return (uint32_t)(PGN<<8) | Source; }
+  int StreamBits() const;
+  tStream &NewStream(unsigned long PGN, unsigned char Source);
+  static void ToWords(const unsigned char *Data, int DataLen, uint64_t *Words);
+
+public:
+  tN2kXorCodecBase();
+  void Reset();
+  uint32_t GetMessages() const { return Messages; }
+  size_t GetStreamCount() const { return Streams.size(); }
+};
+
+/**
+ *  Streaming encoder. Encoded bytes are given to WriteHandler in chunks.
+ */
+class tN2kXorEncoder : public tN2kXorCodecBase {
+public:
+  typedef void (*tWriteHandler)(const uint8_t *Data, size_t len, void *Context);
+
+protected:
+  tWriteHandler WriteHandler;
+  void *Context;
+  std::unordered_map<uint32_t,size_t> StreamIndex;
+  uint8_t Buffer[4096];
+  size_t BufferPos;
+  uint64_t BitBuffer;
+  int BitCount;
+  uint64_t BytesWritten;
+  bool Started;
+
+protected:
+  void PutBits(uint64_t Value, int Bits);
+  void FlushBuffer();
+  void EncodeTime(uint32_t timestamp);
+
+public:
+  tN2kXorEncoder(tWriteHandler _WriteHandler, void *_Context=0);
+  ~tN2kXorEncoder();
+
+  void Add(const tN2kMsg &msg, uint32_t timestamp);
+  void Add(const tN2kMsg &msg) { Add(msg,msg.MsgTime); }
+  // Writes end mark and rest of data. Encoder can be used again after Close.
+  void Close();
+  uint64_t GetBytesWritten() const { return BytesWritten; }
+};
+
+/**
+ *  Streaming decoder. Encoded data is requested with ReadHandler, which
+ *  returns number of bytes read or 0 on end of data.
+ */
+class tN2kXorDecoder : public tN2kXorCodecBase {
+public:
+  typedef size_t (*tReadHandler)(uint8_t *Data, size_t size, void *Context);
+
+protected:
+  tReadHandler ReadHandler;
+  void *Context;
+  uint8_t Buffer[4096];
+  size_t BufferPos;
+  size_t BufferLen;
+  uint64_t BitBuffer;
+  int BitCount;
+  bool Started;
+  bool Ended;
+  bool Error;
+
+protected:
+  bool Fill(int Bits);
+  bool GetBits(int Bits, uint64_t &Value);
+  bool DecodeTime(uint32_t &timestamp);
+
+public:
+  tN2kXorDecoder(tReadHandler _ReadHandler, void *_Context=0);
+
+  // Returns false at end of data or on error.
+  bool Next(tN2kMsg &msg, uint32_t &timestamp);
+  bool IsError() const { return Error; }
+  bool IsEnded() const { return Ended; }
+};
+
+#endif
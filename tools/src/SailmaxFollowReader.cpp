@@ -0,0 +1,276 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  follow a Sailmax log file, which is still written by the logger
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+#include <SailmaxFormat.h>
+#include "HostPlatform.h"
+#include "SailmaxFollowReader.h"
+
+//*****************************************************************************
+tSailmaxFollowReader::tSailmaxFollowReader(size_t _BufferSize) {
+  FileName=0;
+  fd=-1;
+  NotifyFd=-1;
+  WatchFd=-1;
+  PollInterval=DefaultPollInterval;
+  BufferSize=(_BufferSize>=256?_BufferSize:256);
+  Buffer=new char[BufferSize+1];
+  Start=End=ScanPos=0;
+  Discarding=false;
+  FileOffset=0;
+  LinesRead=BadLines=LongLines=Restarts=0;
+  BytesRead=0;
+}
+
+//*****************************************************************************
+tSailmaxFollowReader::~tSailmaxFollowReader() {
+  Close();
+  delete[] Buffer;
+}
+
+//*****************************************************************************
+bool tSailmaxFollowReader::OpenFile(bool FromStart) {
+  fd=open(FileName,O_RDONLY);
+  if ( fd<0 ) return false;
+
+  Start=End=ScanPos=0;
+  Discarding=false;
+  FileOffset=0;
+  Expander.Clear();
+  if ( !FromStart ) {
+    off_t size=lseek(fd,0,SEEK_END);
+    if ( size<0 ) size=0;
+    FileOffset=size;
+    // Skip the partial line written at the moment.
+    Discarding=true;
+    if ( size>0 ) {
+      char c;
+      if ( pread(fd,&c,1,size-1)==1 && c=='\n' ) Discarding=false;
+    } else {
+      Discarding=false;
+    }
+  }
+
+  return true;
+}
+
+//*****************************************************************************
+void tSailmaxFollowReader::CloseFile() {
+  if ( fd>=0 ) close(fd);
+  fd=-1;
+}
+
+//*****************************************************************************
+bool tSailmaxFollowReader::Open(const char *_FileName, bool FromStart) {
+  Close();
+
+  FileName=strdup(_FileName);
+  if ( !OpenFile(FromStart) ) {
+    Close();
+    return false;
+  }
+
+#if defined(__linux__)
+  NotifyFd=inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if ( NotifyFd>=0 ) {
+    WatchFd=inotify_add_watch(NotifyFd,FileName,IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB);
+    if ( WatchFd<0 ) {
+      close(NotifyFd);
+      NotifyFd=-1;
+    }
+  }
+#endif
+
+  return true;
+}
+
+//*****************************************************************************
+void tSailmaxFollowReader::Close() {
+  CloseFile();
+  if ( NotifyFd>=0 ) close(NotifyFd);
+  NotifyFd=-1;
+  WatchFd=-1;
+  if ( FileName!=0 ) free(FileName);
+  FileName=0;
+}
+
+//*****************************************************************************
+// Reads new data appended to the file. Returns true, if some bytes were read.
+bool tSailmaxFollowReader::ReadMore() {
+  if ( fd<0 ) return false;
+
+  // Move partial line to the beginning of the buffer.
+  if ( Start>0 ) {
+    memmove(Buffer,Buffer+Start,End-Start);
+    End-=Start;
+    ScanPos-=Start;
+    Start=0;
+  }
+
+  if ( End==BufferSize ) {
+    // Line does not fit to buffer. Drop it and skip until next line end.
+    if ( !Discarding ) LongLines++;
+    Discarding=true;
+    Start=End=ScanPos=0;
+  }
+
+  ssize_t n;
+  do {
+    n=read(fd,Buffer+End,BufferSize-End);
+  } while ( n<0 && errno==EINTR );
+  if ( n<=0 ) return false;
+
+  End+=n;
+  FileOffset+=n;
+  BytesRead+=n;
+  return true;
+}
+
+//*****************************************************************************
+// Returns true, if file has been truncated or replaced and reading restarted.
+bool tSailmaxFollowReader::CheckTruncated() {
+  struct stat st;
+
+  if ( FileName==0 ) return false;
+  if ( stat(FileName,&st)!=0 ) return false;
+
+  struct stat fst;
+  bool Replaced=( fd<0 || fstat(fd,&fst)!=0 || fst.st_ino!=st.st_ino || fst.st_dev!=st.st_dev );
+  if ( !Replaced && (uint64_t)st.st_size>=FileOffset ) return false;
+
+  CloseFile();
+  Restarts++;
+  if ( !OpenFile(true) ) return false;
+#if defined(__linux__)
+  if ( Replaced && NotifyFd>=0 ) {
+    inotify_rm_watch(NotifyFd,WatchFd);
+    WatchFd=inotify_add_watch(NotifyFd,FileName,IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB);
+  }
+#endif
+  return true;
+}
+
+//*****************************************************************************
+const char *tSailmaxFollowReader::NextLine() {
+  if ( fd<0 ) return 0;
+
+  while ( true ) {
+    char *nl=(char *)memchr(Buffer+ScanPos,'\n',End-ScanPos);
+    if ( nl==0 ) {
+      ScanPos=End;
+      if ( !ReadMore() ) return 0;
+      continue;
+    }
+
+    char *Line=Buffer+Start;
+    size_t LineEnd=nl-Buffer;
+    Start=ScanPos=LineEnd+1;
+    if ( Discarding ) {
+      Discarding=false;
+      continue;
+    }
+    if ( LineEnd>0 && Buffer+LineEnd>Line && Buffer[LineEnd-1]=='\r' ) LineEnd--;
+    Buffer[LineEnd]=0;
+    LinesRead++;
+    return Line;
+  }
+}
+
+//*****************************************************************************
+bool tSailmaxFollowReader::WaitForData(int TimeoutMs) {
+  if ( fd<0 ) return false;
+
+#if defined(__linux__)
+  if ( NotifyFd>=0 ) {
+    struct pollfd pfd;
+    pfd.fd=NotifyFd;
+    pfd.events=POLLIN;
+    pfd.revents=0;
+    // Wake up at least every poll interval to check for replaced file,
+    // which does not generate events on our watch.
+    int Timeout=(TimeoutMs<0 || TimeoutMs>PollInterval*10?PollInterval*10:TimeoutMs);
+    int res=poll(&pfd,1,Timeout);
+    if ( res>0 ) {
+      char events[4096];
+      while ( read(NotifyFd,events,sizeof(events))>0 );
+      CheckTruncated();
+      return true;
+    }
+    return CheckTruncated();
+  }
+#endif
+
+  uint64_t StartTime=HostMicros();
+  while ( true ) {
+    struct stat st;
+    if ( CheckTruncated() ) return true;
+    if ( fstat(fd,&st)==0 && (uint64_t)st.st_size>FileOffset ) return true;
+    int Sleep=PollInterval;
+    if ( TimeoutMs>=0 ) {
+      int64_t Left=(int64_t)TimeoutMs-(int64_t)((HostMicros()-StartTime)/1000);
+      if ( Left<=0 ) return false;
+      if ( Sleep>Left ) Sleep=(int)Left;
+    }
+    usleep(Sleep*1000);
+  }
+}
+
+//*****************************************************************************
+bool tSailmaxFollowReader::NextMsg(tN2kMsg &msg, uint32_t &timestamp, int TimeoutMs) {
+  uint64_t StartTime=HostMicros();
+
+  while ( true ) {
+    if ( Expander.Next(msg,timestamp) ) return true;
+    const char *Line=NextLine();
+    if ( Line!=0 ) {
+      if ( !Expander.AddLine(Line) ) BadLines++;
+      continue;
+    }
+    int Left=TimeoutMs;
+    if ( TimeoutMs>0 ) {
+      Left=TimeoutMs-(int)((HostMicros()-StartTime)/1000);
+      if ( Left<=0 ) return false;
+    }
+    if ( TimeoutMs==0 ) return false;
+    WaitForData(Left);
+  }
+}
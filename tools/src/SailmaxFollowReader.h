@@ -0,0 +1,131 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  follow a Sailmax log file, which is still written by the logger
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _SailmaxFollowReader_h_
+#define _SailmaxFollowReader_h_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <N2kMsg.h>
+#include "SailmaxRunLength.h"
+
+/**
+ *  Reads a Sailmax log file like "tail -f".
+ *
+ *  The file is read sequentially from the last read position and data already
+ *  read is never scanned again. Only complete lines are returned. A partial
+ *  line at the end of the file is held back until the logger has written its
+ *  line end.
+ *
+ *  On Linux file growth is detected with inotify, so new lines are returned
+ *  immediately after they have been written. Otherwise, or if inotify can not
+ *  be used, the file size is polled every PollInterval ms.
+ *
+ *  If the file gets shorter than the read position (new log started with
+ *  same name), reading restarts from the beginning.
+ */
+class tSailmaxFollowReader {
+public:
+  static const int DefaultPollInterval=100; // ms
+
+protected:
+  char *FileName;
+  int fd;
+  int NotifyFd;
+  int WatchFd;
+  int PollInterval;
+  char *Buffer;
+  size_t BufferSize;
+  size_t Start;    // first byte of unconsumed data
+  size_t End;      // end of valid data
+  size_t ScanPos;  // bytes before ScanPos have been checked for line end
+  bool Discarding; // skipping rest of too long line
+  uint64_t FileOffset; // file position of Buffer[End]
+  tSailmaxRunExpander Expander;
+
+  uint32_t LinesRead;
+  uint32_t BadLines;
+  uint32_t LongLines;
+  uint32_t Restarts;
+  uint64_t BytesRead;
+
+protected:
+  bool OpenFile(bool FromStart);
+  void CloseFile();
+  bool ReadMore();
+  bool CheckTruncated();
+
+public:
+  tSailmaxFollowReader(size_t _BufferSize=65536);
+  ~tSailmaxFollowReader();
+
+  /**
+   *  Opens file for following. With FromStart=false only lines written
+   *  after opening will be returned.
+   *  Returns false if file can not be opened.
+   */
+  bool Open(const char *_FileName, bool FromStart=true);
+  void Close();
+  bool IsOpen() const { return fd>=0; }
+  bool IsUsingInotify() const { return WatchFd>=0; }
+  void SetPollInterval(int _PollInterval) { PollInterval=(_PollInterval>0?_PollInterval:1); }
+
+  /**
+   *  Returns next complete line without line end or 0, if there is no complete
+   *  line available at the moment. The line is valid until next call.
+   *  Does not wait.
+   */
+  const char *NextLine();
+
+  /**
+   *  Waits max TimeoutMs for the file to grow. TimeoutMs<0 waits forever.
+   *  Returns true, if there may be new data.
+   */
+  bool WaitForData(int TimeoutMs);
+
+  /**
+   *  Returns next message converted from log. Run records are expanded to
+   *  original message sequence. Lines, which are not valid Sailmax sentences,
+   *  are skipped. Waits max TimeoutMs for a new message.
+   *  Returns false on timeout.
+   */
+  bool NextMsg(tN2kMsg &msg, uint32_t &timestamp, int TimeoutMs=0);
+
+  uint32_t GetLinesRead() const { return LinesRead; }
+  uint32_t GetBadLines() const { return BadLines; }
+  uint32_t GetLongLines() const { return LongLines; }
+  uint32_t GetRestarts() const { return Restarts; }
+  uint64_t GetBytesRead() const { return BytesRead; }
+};
+
+#endif
@@ -0,0 +1,439 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  block index with PGN and source summaries for Sailmax log files
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <queue>
+#include <vector>
+#include <SailmaxFormat.h>
+#include "SailmaxRunLength.h"
+#include "SailmaxLogIndex.h"
+
+static const char IndexMagic[8]={'S','M','X','I','D','X','0','1'};
+
+//*****************************************************************************
+bool SailmaxParseHeader(const char *Line, size_t len, uint32_t &timestamp, unsigned long &PGN, unsigned char &Source) {
+  size_t i=1;
+
+  if ( len<4 || ( Line[0]!='@' && Line[0]!='&' ) ) return false;
+
+  timestamp=0;
+  for ( ; i<len && Line[i]>='0' && Line[i]<='9'; i++ ) timestamp=timestamp*10+(Line[i]-'0');
+  if ( i>=len || Line[i]!=',' ) return false;
+
+  PGN=0;
+  for ( i++; i<len && Line[i]>='0' && Line[i]<='9'; i++ ) PGN=PGN*10+(Line[i]-'0');
+  if ( i>=len || Line[i]!=',' ) return false;
+
+  if ( i+3>=len ) return false;
+  unsigned int s=0;
+  for ( int j=1; j<=2; j++ ) {
+    char c=Line[i+j];
+    s<<=4;
+    if ( c>='0' && c<='9' ) { s|=c-'0'; }
+    else if ( c>='A' && c<='F' ) { s|=c-'A'+10; }
+    else if ( c>='a' && c<='f' ) { s|=c-'a'+10; }
+    else return false;
+  }
+  Source=s;
+
+  return true;
+}
+
+//*****************************************************************************
+// Two independent hashes for double hashing of Bloom filter bits.
+static inline void PGNHashes(unsigned long PGN, uint32_t &h1, uint32_t &h2) {
+  uint32_t x=(uint32_t)PGN;
+  x^=x>>16; x*=0x7feb352d;
+  x^=x>>15; x*=0x846ca68b;
+  x^=x>>16;
+  h1=x;
+  h2=(x>>16 | x<<16) | 1;
+}
+
+//*****************************************************************************
+void tSailmaxLogIndex::tBlock::Clear() {
+  memset(this,0,sizeof(*this));
+}
+
+//*****************************************************************************
+void tSailmaxLogIndex::tBlock::Add(unsigned long PGN, unsigned char Source) {
+  uint32_t h1,h2;
+  Sources[Source>>3]|=1<<(Source&7);
+  PGNHashes(PGN,h1,h2);
+  for ( int i=0; i<BloomHashes; i++ ) {
+    uint32_t bit=(h1+i*h2)%BloomBits;
+    PGNBloom[bit>>3]|=1<<(bit&7);
+  }
+}
+
+//*****************************************************************************
+bool tSailmaxLogIndex::tBlock::MayHavePGN(unsigned long PGN) const {
+  uint32_t h1,h2;
+  PGNHashes(PGN,h1,h2);
+  for ( int i=0; i<BloomHashes; i++ ) {
+    uint32_t bit=(h1+i*h2)%BloomBits;
+    if ( (PGNBloom[bit>>3] & (1<<(bit&7)))==0 ) return false;
+  }
+  return true;
+}
+
+//*****************************************************************************
+tSailmaxLogIndex::tSailmaxLogIndex() {
+  Blocks=0;
+  BlockCount=0;
+  BlockCapacity=0;
+  BlockSize=DefaultBlockSize;
+  FileSize=0;
+  FileTime=0;
+}
+
+//*****************************************************************************
+tSailmaxLogIndex::~tSailmaxLogIndex() {
+  if ( Blocks!=0 ) free(Blocks);
+}
+
+//*****************************************************************************
+void tSailmaxLogIndex::Clear() {
+  BlockCount=0;
+  FileSize=0;
+  FileTime=0;
+}
+
+//*****************************************************************************
+tSailmaxLogIndex::tBlock *tSailmaxLogIndex::AddBlock() {
+  if ( BlockCount==BlockCapacity ) {
+    size_t NewCapacity=(BlockCapacity==0?64:BlockCapacity*2);
+    tBlock *NewBlocks=(tBlock *)realloc(Blocks,NewCapacity*sizeof(tBlock));
+    if ( NewBlocks==0 ) return 0;
+    Blocks=NewBlocks;
+    BlockCapacity=NewCapacity;
+  }
+  tBlock *Block=&Blocks[BlockCount++];
+  Block->Clear();
+  return Block;
+}
+
+//*****************************************************************************
+static bool GetFileInfo(const char *FileName, uint64_t &Size, int64_t &Time) {
+  struct stat st;
+  if ( stat(FileName,&st)!=0 ) return false;
+  Size=st.st_size;
+  Time=st.st_mtime;
+  return true;
+}
+
+//*****************************************************************************
+bool tSailmaxLogIndex::Build(const char *LogFileName, uint32_t _BlockSize) {
+  Clear();
+  BlockSize=(_BlockSize>0?_BlockSize:DefaultBlockSize);
+
+  FILE *f=fopen(LogFileName,"rb");
+  if ( f==0 ) return false;
+  if ( !GetFileInfo(LogFileName,FileSize,FileTime) ) { fclose(f); return false; }
+
+  char *Line=0;
+  size_t LineCapacity=0;
+  ssize_t len;
+  uint64_t Offset=0;
+  tBlock *Block=0;
+  uint32_t timestamp;
+  unsigned long PGN;
+  unsigned char Source;
+  bool result=true;
+
+  while ( (len=getline(&Line,&LineCapacity,f))>0 ) {
+    // Last line without line end may be still written. Take it only if complete.
+    if ( Line[len-1]!='\n' && ( len<3 || Line[len-3]!='*' ) ) break;
+    if ( Block==0 ) {
+      Block=AddBlock();
+      if ( Block==0 ) { result=false; break; }
+      Block->Offset=Offset;
+    }
+    if ( SailmaxParseHeader(Line,len,timestamp,PGN,Source) ) {
+      if ( Block->Messages==0 ) Block->FirstTimestamp=timestamp;
+      Block->LastTimestamp=timestamp;
+      Block->Messages++;
+      if ( Line[0]=='&' ) {
+        // Run record: one repeat more than there are separators
+        Block->Messages++;
+        for ( ssize_t i=0; i<len; i++ ) if ( Line[i]==';' ) Block->Messages++;
+      }
+      Block->Add(PGN,Source);
+    }
+    Block->Length+=len;
+    Offset+=len;
+    if ( Block->Length>=BlockSize ) Block=0;
+  }
+
+  free(Line);
+  fclose(f);
+  // Only complete lines are indexed. Rest will be indexed after log has grown.
+  FileSize=Offset;
+  return result;
+}
+
+//*****************************************************************************
+bool tSailmaxLogIndex::Save(const char *IndexFileName) const {
+  FILE *f=fopen(IndexFileName,"wb");
+  if ( f==0 ) return false;
+
+  uint64_t Count=BlockCount;
+  bool result=( fwrite(IndexMagic,sizeof(IndexMagic),1,f)==1 &&
+                fwrite(&BlockSize,sizeof(BlockSize),1,f)==1 &&
+                fwrite(&FileSize,sizeof(FileSize),1,f)==1 &&
+                fwrite(&FileTime,sizeof(FileTime),1,f)==1 &&
+                fwrite(&Count,sizeof(Count),1,f)==1 &&
+                ( BlockCount==0 || fwrite(Blocks,sizeof(tBlock),BlockCount,f)==BlockCount ) );
+  if ( fclose(f)!=0 ) result=false;
+  return result;
+}
+
+//*****************************************************************************
+bool tSailmaxLogIndex::Load(const char *IndexFileName) {
+  Clear();
+
+  FILE *f=fopen(IndexFileName,"rb");
+  if ( f==0 ) return false;
+
+  char Magic[sizeof(IndexMagic)];
+  uint64_t Count=0;
+  bool result=( fread(Magic,sizeof(Magic),1,f)==1 && memcmp(Magic,IndexMagic,sizeof(Magic))==0 &&
+                fread(&BlockSize,sizeof(BlockSize),1,f)==1 &&
+                fread(&FileSize,sizeof(FileSize),1,f)==1 &&
+                fread(&FileTime,sizeof(FileTime),1,f)==1 &&
+                fread(&Count,sizeof(Count),1,f)==1 );
+  for ( uint64_t i=0; result && i<Count; i++ ) {
+    tBlock *Block=AddBlock();
+    result=( Block!=0 && fread(Block,sizeof(tBlock),1,f)==1 );
+  }
+  fclose(f);
+  if ( !result ) Clear();
+  return result;
+}
+
+//*****************************************************************************
+bool tSailmaxLogIndex::IsValidFor(const char *LogFileName) const {
+  uint64_t Size;
+  int64_t Time;
+  if ( !GetFileInfo(LogFileName,Size,Time) ) return false;
+  // Size may differ by a partial line, which was not indexed.
+  return Time==FileTime && Size>=FileSize && Size-FileSize<BlockSize;
+}
+
+//*****************************************************************************
+bool tSailmaxLogIndex::Open(const char *LogFileName, uint32_t _BlockSize, bool ForceBuild) {
+  size_t len=strlen(LogFileName);
+  char *IndexFileName=new char[len+5];
+  strcpy(IndexFileName,LogFileName);
+  strcpy(IndexFileName+len,".idx");
+
+  bool result=( !ForceBuild && Load(IndexFileName) && IsValidFor(LogFileName) &&
+                ( _BlockSize==0 || _BlockSize==BlockSize ) );
+  if ( !result ) {
+    result=Build(LogFileName,(_BlockSize>0?_BlockSize:DefaultBlockSize));
+    if ( result ) Save(IndexFileName);
+  }
+
+  delete[] IndexFileName;
+  return result;
+}
+
+//*****************************************************************************
+tSailmaxLogQuery::tSailmaxLogQuery() {
+  PGNCount=0;
+  SourceCount=0;
+  BlocksScanned=0;
+  BlocksSkipped=0;
+  BytesTouched=0;
+  Matches=0;
+}
+
+//*****************************************************************************
+bool tSailmaxLogQuery::AddPGN(unsigned long PGN) {
+  if ( PGNCount>=MaxFilters ) return false;
+  PGNs[PGNCount++]=PGN;
+  return true;
+}
+
+//*****************************************************************************
+bool tSailmaxLogQuery::AddSource(unsigned char Source) {
+  if ( SourceCount>=MaxFilters ) return false;
+  Sources[SourceCount++]=Source;
+  return true;
+}
+
+//*****************************************************************************
+bool tSailmaxLogQuery::BlockMayMatch(const tSailmaxLogIndex::tBlock &Block) const {
+  if ( Block.Messages==0 ) return false;
+
+  bool PGNMatch=(PGNCount==0);
+  for ( int i=0; i<PGNCount && !PGNMatch; i++ ) PGNMatch=Block.MayHavePGN(PGNs[i]);
+  if ( !PGNMatch ) return false;
+
+  bool SourceMatch=(SourceCount==0);
+  for ( int i=0; i<SourceCount && !SourceMatch; i++ ) SourceMatch=Block.HasSource(Sources[i]);
+  return SourceMatch;
+}
+
+//*****************************************************************************
+bool tSailmaxLogQuery::MessageMatches(unsigned long PGN, unsigned char Source) const {
+  bool PGNMatch=(PGNCount==0);
+  for ( int i=0; i<PGNCount && !PGNMatch; i++ ) PGNMatch=(PGNs[i]==PGN);
+  if ( !PGNMatch ) return false;
+
+  bool SourceMatch=(SourceCount==0);
+  for ( int i=0; i<SourceCount && !SourceMatch; i++ ) SourceMatch=(Sources[i]==Source);
+  return SourceMatch;
+}
+
+//*****************************************************************************
+namespace {
+  // Repeat of a run record waiting for its time.
+  struct tQueryRepeat {
+    uint32_t timestamp;
+    uint64_t Order;
+    std::shared_ptr<tN2kMsg> Msg;
+    bool operator<(const tQueryRepeat &other) const {
+      return ( timestamp!=other.timestamp ? (int32_t)(timestamp-other.timestamp)>0 : Order>other.Order );
+    }
+  };
+}
+
+//*****************************************************************************
+// Gives message as Sailmax line to handler.
+static void HandleMatch(tSailmaxLogQuery::tMatchHandler Handler, void *Context, const tN2kMsg &msg, uint32_t timestamp) {
+  char Line[MaxSailmaxLine];
+  if ( Handler!=0 && N2kToSailmax(msg,timestamp,Line,sizeof(Line))>0 ) Handler(Line,timestamp,msg,Context);
+}
+
+//*****************************************************************************
+bool tSailmaxLogQuery::Run(const char *LogFileName, const tSailmaxLogIndex &Index, tMatchHandler Handler, void *Context) {
+  BlocksScanned=BlocksSkipped=0;
+  BytesTouched=0;
+  Matches=0;
+
+  FILE *f=fopen(LogFileName,"rb");
+  if ( f==0 ) return false;
+
+  char *Buffer=0;
+  size_t BufferSize=0;
+  tN2kMsg msg;
+  uint32_t timestamp;
+  unsigned long PGN;
+  unsigned char Source;
+  bool result=true;
+  // Repeats of matching run records are merged by time with other matches, since
+  // exact sequence would require expanding all records from start of the file.
+  std::priority_queue<tQueryRepeat> Repeats;
+  std::vector<std::pair<int32_t,uint32_t> > Deltas;
+  uint64_t Order=0;
+
+  for ( size_t b=0; b<Index.GetBlockCount() && result; b++ ) {
+    const tSailmaxLogIndex::tBlock &Block=Index.GetBlock(b);
+    if ( !BlockMayMatch(Block) ) {
+      BlocksSkipped++;
+      continue;
+    }
+
+    if ( Block.Length+1>BufferSize ) {
+      free(Buffer);
+      BufferSize=Block.Length+1;
+      Buffer=(char *)malloc(BufferSize);
+      if ( Buffer==0 ) { result=false; break; }
+    }
+    if ( fseeko(f,(off_t)Block.Offset,SEEK_SET)!=0 || fread(Buffer,1,Block.Length,f)!=Block.Length ) {
+      result=false;
+      break;
+    }
+    Buffer[Block.Length]=0;
+    BlocksScanned++;
+    BytesTouched+=Block.Length;
+
+    char *Line=Buffer;
+    char *BlockEnd=Buffer+Block.Length;
+    while ( Line<BlockEnd ) {
+      char *nl=(char *)memchr(Line,'\n',BlockEnd-Line);
+      char *LineEnd=(nl!=0?nl:BlockEnd);
+      if ( SailmaxParseHeader(Line,LineEnd-Line,timestamp,PGN,Source) && MessageMatches(PGN,Source) ) {
+        *LineEnd=0;
+        if ( LineEnd>Line && LineEnd[-1]=='\r' ) LineEnd[-1]=0;
+        bool Valid;
+        if ( Line[0]=='@' ) {
+          Valid=SailmaxToN2k(Line,timestamp,msg);
+          Deltas.clear();
+        } else {
+          Valid=SailmaxRunToN2k(Line,timestamp,msg,Deltas);
+        }
+        if ( Valid ) {
+          while ( !Repeats.empty() && (int32_t)(Repeats.top().timestamp-timestamp)<=0 ) {
+            Matches++;
+            HandleMatch(Handler,Context,*Repeats.top().Msg,Repeats.top().timestamp);
+            Repeats.pop();
+          }
+          Matches++;
+          if ( Handler!=0 ) {
+            if ( Line[0]=='@' ) {
+              Handler(Line,timestamp,msg,Context);
+            } else {
+              HandleMatch(Handler,Context,msg,timestamp);
+            }
+          }
+          if ( !Deltas.empty() ) {
+            tQueryRepeat Repeat;
+            Repeat.timestamp=timestamp;
+            Repeat.Msg=std::make_shared<tN2kMsg>(msg);
+            for ( size_t i=0; i<Deltas.size(); i++ ) {
+              Repeat.timestamp+=Deltas[i].first;
+              Repeat.Order=Order++;
+              Repeats.push(Repeat);
+            }
+          }
+        }
+      }
+      Line=LineEnd+1;
+    }
+  }
+
+  while ( result && !Repeats.empty() ) {
+    Matches++;
+    HandleMatch(Handler,Context,*Repeats.top().Msg,Repeats.top().timestamp);
+    Repeats.pop();
+  }
+
+  free(Buffer);
+  fclose(f);
+  return result;
+}
@@ -0,0 +1,162 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  block index with PGN and source summaries for Sailmax log files
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _SailmaxLogIndex_h_
+#define _SailmaxLogIndex_h_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <N2kMsg.h>
+
+/**
+ *  Reads timestamp, PGN and source from Sailmax sentence or run record without
+ *  decoding the data. Returns false, if line does not start like one.
+ */
+bool SailmaxParseHeader(const char *Line, size_t len, uint32_t &timestamp, unsigned long &PGN, unsigned char &Source);
+
+/**
+ *  Index of a Sailmax log file.
+ *
+ *  The file is split to blocks of about BlockSize bytes. A block always
+ *  ends at line end. For every block the index keeps a bitset of sources and
+ *  a Bloom filter of PGNs it contains. A query can then skip all blocks,
+ *  which surely do not contain any requested message.
+ *
+ *  Index is saved as sidecar file (logfile.idx) and it is rebuilt, if log
+ *  file size or modification time has changed.
+ */
+class tSailmaxLogIndex {
+public:
+  static const uint32_t DefaultBlockSize=256*1024;
+  static const int BloomBits=1024;
+  static const int BloomHashes=3;
+
+  struct tBlock {
+    uint64_t Offset;
+    uint32_t Length;
+    uint32_t Messages;
+    uint32_t FirstTimestamp;
+    uint32_t LastTimestamp;
+    uint8_t Sources[256/8];
+    uint8_t PGNBloom[BloomBits/8];
+
+    void Clear();
+    void Add(unsigned long PGN, unsigned char Source);
+    bool HasSource(unsigned char Source) const { return (Sources[Source>>3] & (1<<(Source&7)))!=0; }
+    bool MayHavePGN(unsigned long PGN) const;
+  };
+
+protected:
+  tBlock *Blocks;
+  size_t BlockCount;
+  size_t BlockCapacity;
+  uint32_t BlockSize;
+  uint64_t FileSize;
+  int64_t FileTime;
+
+protected:
+  tBlock *AddBlock();
+
+public:
+  tSailmaxLogIndex();
+  ~tSailmaxLogIndex();
+  void Clear();
+
+  /**
+   *  Builds index by reading whole log file.
+   */
+  bool Build(const char *LogFileName, uint32_t _BlockSize=DefaultBlockSize);
+
+  bool Save(const char *IndexFileName) const;
+  bool Load(const char *IndexFileName);
+
+  /**
+   *  Returns true, if index was built for current version of the log file.
+   */
+  bool IsValidFor(const char *LogFileName) const;
+
+  /**
+   *  Loads index from LogFileName.idx or builds and saves it, if it
+   *  does not exist or is outdated.
+   */
+  bool Open(const char *LogFileName, uint32_t _BlockSize=DefaultBlockSize, bool ForceBuild=false);
+
+  size_t GetBlockCount() const { return BlockCount; }
+  const tBlock &GetBlock(size_t i) const { return Blocks[i]; }
+  uint32_t GetBlockSize() const { return BlockSize; }
+  uint64_t GetFileSize() const { return FileSize; }
+};
+
+/**
+ *  Query for messages by PGN and source using tSailmaxLogIndex.
+ *  Empty PGN or source list matches all.
+ */
+class tSailmaxLogQuery {
+public:
+  static const int MaxFilters=32;
+  typedef void (*tMatchHandler)(const char *Line, uint32_t timestamp, const tN2kMsg &msg, void *Context);
+
+protected:
+  unsigned long PGNs[MaxFilters];
+  int PGNCount;
+  unsigned char Sources[MaxFilters];
+  int SourceCount;
+
+  size_t BlocksScanned;
+  size_t BlocksSkipped;
+  uint64_t BytesTouched;
+  uint32_t Matches;
+
+protected:
+  bool BlockMayMatch(const tSailmaxLogIndex::tBlock &Block) const;
+  bool MessageMatches(unsigned long PGN, unsigned char Source) const;
+
+public:
+  tSailmaxLogQuery();
+  bool AddPGN(unsigned long PGN);
+  bool AddSource(unsigned char Source);
+
+  /**
+   *  Runs query over log file and calls Handler for every matching message
+   *  in file order. Run records are expanded and Handler gets each message
+   *  as normal Sailmax line. Returns false, if file can not be read.
+   */
+  bool Run(const char *LogFileName, const tSailmaxLogIndex &Index, tMatchHandler Handler, void *Context=0);
+
+  size_t GetBlocksScanned() const { return BlocksScanned; }
+  size_t GetBlocksSkipped() const { return BlocksSkipped; }
+  uint64_t GetBytesTouched() const { return BytesTouched; }
+  uint32_t GetMatches() const { return Matches; }
+};
+
+#endif
@@ -0,0 +1,284 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  run length records for repeated identical messages in Sailmax logs
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <string.h>
+#include <stdlib.h>
+#include <SailmaxFormat.h>
+#include "SailmaxRunLength.h"
+
+static const char *hex="0123456789ABCDEF";
+
+//*****************************************************************************
+static int HexValue(char c) {
+  if ( c>='0' && c<='9' ) return c-'0';
+  if ( c>='A' && c<='F' ) return c-'A'+10;
+  if ( c>='a' && c<='f' ) return c-'a'+10;
+  return -1;
+}
+
+//*****************************************************************************
+// Checksum as in Sailmax sentences: xor of all chars after first up to '*'
+static uint8_t Checksum(const char *Line, size_t len) {
+  uint8_t cs=0;
+  for ( size_t i=1; i<len; i++ ) cs^=Line[i];
+  return cs;
+}
+
+//*****************************************************************************
+bool SailmaxRunToN2k(const char *Line, uint32_t &timestamp, tN2kMsg &msg, std::vector<std::pair<int32_t,uint32_t> > &Deltas) {
+  const char *s=Line;
+
+  Deltas.clear();
+  msg.Clear();
+  msg.Destination=0xFF;
+  if ( *s!='&' ) return false;
+
+  const char *Star=strchr(s,'*');
+  if ( Star==0 || HexValue(Star[1])<0 || HexValue(Star[2])<0 ) return false;
+  if ( Checksum(Line,Star-Line)!=(HexValue(Star[1])<<4 | HexValue(Star[2])) ) return false;
+
+  char *end;
+  s++;
+  timestamp=strtoul(s,&end,10);
+  if ( end==s || *end!=',' ) return false;
+  msg.MsgTime=timestamp;
+  s=end+1;
+  msg.PGN=strtoul(s,&end,10);
+  if ( end==s || *end!=',' ) return false;
+  s=end+1;
+  if ( HexValue(s[0])<0 || HexValue(s[1])<0 || s[2]!=',' ) return false;
+  msg.Source=HexValue(s[0])<<4 | HexValue(s[1]);
+  s+=3;
+
+  while ( *s!=',' ) {
+    int h=HexValue(s[0]);
+    int l=(h>=0?HexValue(s[1]):-1);
+    if ( l<0 || msg.DataLen>=msg.MaxDataLen ) return false;
+    msg.Data[msg.DataLen++]=h<<4 | l;
+    s+=2;
+  }
+
+  s++;
+  while ( s<Star ) {
+    long dt=strtol(s,&end,10);
+    if ( end==s ) return false;
+    unsigned long gap=1;
+    s=end;
+    if ( *s=='/' ) {
+      s++;
+      gap=strtoul(s,&end,10);
+      if ( end==s || gap==0 ) return false;
+      s=end;
+    }
+    Deltas.push_back(std::make_pair((int32_t)dt,(uint32_t)gap));
+    if ( *s==';' ) {
+      s++;
+    } else if ( s!=Star ) {
+      return false;
+    }
+  }
+
+  return !Deltas.empty();
+}
+
+//*****************************************************************************
+tSailmaxRunWriter::tSailmaxRunWriter(tLineHandler _LineHandler, void *_Context, uint32_t _MaxRepeats, size_t _MaxPending) {
+  LineHandler=_LineHandler;
+  Context=_Context;
+  MaxRepeats=(_MaxRepeats>0?_MaxRepeats:1);
+  MaxPending=(_MaxPending>0?_MaxPending:1);
+  NextSeq=0;
+  Messages=0;
+  Records=0;
+  RunRecords=0;
+}
+
+//*****************************************************************************
+tSailmaxRunWriter::~tSailmaxRunWriter() {
+  Flush();
+}
+
+//*****************************************************************************
+void tSailmaxRunWriter::CloseRun(tRecord *Record) {
+  if ( Record->Closed ) return;
+  Record->Closed=true;
+  OpenRuns.erase(Key(Record->PGN,Record->Source));
+}
+
+//*****************************************************************************
+void tSailmaxRunWriter::WriteRecord(const tRecord *Record) {
+  char Line[MaxSailmaxLine];
+
+  if ( Record->Repeats==0 ) {
+    tN2kMsg msg(Record->Source);
+    msg.SetPGN(Record->PGN);
+    msg.DataLen=Record->DataLen;
+    memcpy(msg.Data,Record->Data,Record->DataLen);
+    if ( N2kToSailmax(msg,Record->FirstTimestamp,Line,sizeof(Line))>0 ) LineHandler(Line,Context);
+  } else {
+    std::string Run;
+    int len=snprintf(Line,sizeof(Line),"&%lu,%06lu,%c%c,",(unsigned long)Record->FirstTimestamp,Record->PGN,
+                     hex[Record->Source>>4],hex[Record->Source&0xf]);
+    Run.reserve(len+2*Record->DataLen+Record->Deltas.size()+8);
+    Run.append(Line,len);
+    for ( int i=0; i<Record->DataLen; i++ ) {
+      Run+=hex[Record->Data[i]>>4];
+      Run+=hex[Record->Data[i]&0xf];
+    }
+    Run+=',';
+    Run+=Record->Deltas;
+    uint8_t cs=Checksum(Run.c_str(),Run.size());
+    Run+='*';
+    Run+=hex[cs>>4];
+    Run+=hex[cs&0xf];
+    LineHandler(Run.c_str(),Context);
+    RunRecords++;
+  }
+  Records++;
+}
+
+//*****************************************************************************
+void tSailmaxRunWriter::WriteClosed() {
+  while ( !Pending.empty() && Pending.front()->Closed ) {
+    WriteRecord(Pending.front());
+    delete Pending.front();
+    Pending.pop_front();
+  }
+}
+
+//*****************************************************************************
+void tSailmaxRunWriter::Add(const tN2kMsg &msg, uint32_t timestamp) {
+  uint64_t Seq=NextSeq++;
+  uint32_t key=Key(msg.PGN,msg.Source);
+  Messages++;
+
+  std::unordered_map<uint32_t,tRecord *>::iterator it=OpenRuns.find(key);
+  if ( it!=OpenRuns.end() ) {
+    tRecord *Record=it->second;
+    if ( Record->DataLen==msg.DataLen && memcmp(Record->Data,msg.Data,msg.DataLen)==0 ) {
+      char Delta[32];
+      int32_t dt=(int32_t)(timestamp-Record->LastTimestamp);
+      uint64_t gap=Seq-Record->LastSeq;
+      if ( gap==1 ) {
+        snprintf(Delta,sizeof(Delta),"%s%ld",(Record->Repeats>0?";":""),(long)dt);
+      } else {
+        snprintf(Delta,sizeof(Delta),"%s%ld/%llu",(Record->Repeats>0?";":""),(long)dt,(unsigned long long)gap);
+      }
+      Record->Deltas+=Delta;
+      Record->LastTimestamp=timestamp;
+      Record->LastSeq=Seq;
+      Record->Repeats++;
+      if ( Record->Repeats>=MaxRepeats ) {
+        CloseRun(Record);
+        WriteClosed();
+      }
+      return;
+    }
+    CloseRun(Record);
+  }
+
+  tRecord *Record=new tRecord;
+  Record->PGN=msg.PGN;
+  Record->Source=msg.Source;
+  Record->DataLen=msg.DataLen;
+  memcpy(Record->Data,msg.Data,msg.DataLen);
+  Record->FirstTimestamp=Record->LastTimestamp=timestamp;
+  Record->LastSeq=Seq;
+  Record->Repeats=0;
+  Record->Closed=false;
+  OpenRuns[key]=Record;
+  Pending.push_back(Record);
+
+  while ( Pending.size()>MaxPending ) {
+    CloseRun(Pending.front());
+    WriteClosed();
+  }
+  WriteClosed();
+}
+
+//*****************************************************************************
+void tSailmaxRunWriter::Flush() {
+  for ( size_t i=0; i<Pending.size(); i++ ) Pending[i]->Closed=true;
+  OpenRuns.clear();
+  WriteClosed();
+}
+
+//*****************************************************************************
+tSailmaxRunExpander::tSailmaxRunExpander() {
+  Clear();
+}
+
+//*****************************************************************************
+void tSailmaxRunExpander::Clear() {
+  Queue=std::priority_queue<tPending>();
+  NextSeq=0;
+  Finished=false;
+}
+
+//*****************************************************************************
+bool tSailmaxRunExpander::AddLine(const char *Line) {
+  tPending Entry;
+  Entry.Msg=std::make_shared<tN2kMsg>();
+
+  if ( Line[0]=='@' ) {
+    if ( !SailmaxToN2k(Line,Entry.timestamp,*Entry.Msg) ) return false;
+    Deltas.clear();
+  } else if ( !SailmaxRunToN2k(Line,Entry.timestamp,*Entry.Msg,Deltas) ) {
+    return false;
+  }
+
+  // First message of a record always takes the first free sequence number.
+  Entry.Seq=NextSeq;
+  Queue.push(Entry);
+  for ( size_t i=0; i<Deltas.size(); i++ ) {
+    Entry.Seq+=Deltas[i].second;
+    Entry.timestamp+=Deltas[i].first;
+    Queue.push(Entry);
+  }
+
+  return true;
+}
+
+//*****************************************************************************
+bool tSailmaxRunExpander::Next(tN2kMsg &msg, uint32_t &timestamp) {
+  if ( Queue.empty() ) return false;
+  if ( !Finished && Queue.top().Seq!=NextSeq ) return false;
+
+  const tPending &Top=Queue.top();
+  msg=*Top.Msg;
+  msg.MsgTime=Top.timestamp;
+  timestamp=Top.timestamp;
+  NextSeq=Top.Seq+1;
+  Queue.pop();
+  return true;
+}
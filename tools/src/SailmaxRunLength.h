@@ -0,0 +1,158 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  run length records for repeated identical messages in Sailmax logs
+      * Author:   © Ronnie Zeiller, 2018
+      * A run of identical messages (same PGN, source and data) is stored as
+      * one record with the payload and the list of time and sequence deltas:
+      * &timestamp,PGN,Source,Data,dt[/gap];dt[/gap];...*checksum
+      * &205734,060928,00,E601A11C008532C0,1000;1000/3;998*21
+      * dt is the time from previous message of the run, gap the number of
+      * messages from the previous message of the run in original sequence
+      * (default 1). Messages without repeats are stored as normal @ lines.
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#ifndef _SailmaxRunLength_h_
+#define _SailmaxRunLength_h_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <deque>
+#include <queue>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <N2kMsg.h>
+
+// Buffer size for one Sailmax sentence including line end
+static const size_t MaxSailmaxLine=480;
+
+/**
+ *  Parses Sailmax run record. On success msg contains the payload, timestamp
+ *  the time of first message and Deltas the (dt,gap) pairs of the repeats.
+ */
+bool SailmaxRunToN2k(const char *Line, uint32_t &timestamp, tN2kMsg &msg, std::vector<std::pair<int32_t,uint32_t> > &Deltas);
+
+/**
+ *  Collapses runs of identical messages to run records.
+ *
+ *  Records are written in the original order of their first message. So a
+ *  run is kept open until it ends or has MaxRepeats repeats, or there are
+ *  MaxPending records waiting behind it.
+ */
+class tSailmaxRunWriter {
+public:
+  typedef void (*tLineHandler)(const char *Line, void *Context);
+
+protected:
+  struct tRecord {
+    unsigned long PGN;
+    unsigned char Source;
+    unsigned char DataLen;
+    unsigned char Data[tN2kMsg::MaxDataLen];
+    uint32_t FirstTimestamp;
+    uint32_t LastTimestamp;
+    uint64_t LastSeq;
+    uint32_t Repeats;
+    bool Closed;
+    std::string Deltas;
+  };
+
+  tLineHandler LineHandler;
+  void *Context;
+  uint32_t MaxRepeats;
+  size_t MaxPending;
+  uint64_t NextSeq;
+  std::deque<tRecord *> Pending;
+  std::unordered_map<uint32_t,tRecord *> OpenRuns; // key PGN<<8 | Source
+
+  uint32_t Messages;
+  uint32_t Records;
+  uint32_t RunRecords;
+
+protected:
+  static uint32_t Key(unsigned long PGN, unsigned char Source) { return (uint32_t)(PGN<<8) | Source; }
+  void CloseRun(tRecord *Record);
+  void WriteClosed();
+  void WriteRecord(const tRecord *Record);
+
+public:
+  tSailmaxRunWriter(tLineHandler _LineHandler, void *_Context=0, uint32_t _MaxRepeats=64, size_t _MaxPending=1024);
+  ~tSailmaxRunWriter();
+
+  void Add(const tN2kMsg &msg, uint32_t timestamp);
+  // Closes all runs and writes all records.
+  void Flush();
+
+  uint32_t GetMessages() const { return Messages; }
+  uint32_t GetRecords() const { return Records; }
+  uint32_t GetRunRecords() const { return RunRecords; }
+};
+
+/**
+ *  Expands Sailmax lines with run records back to original message sequence.
+ *
+ *  Feed lines with AddLine(), while NeedLine() returns true, and take messages
+ *  with Next(). Normal @ lines are passed as they are.
+ */
+class tSailmaxRunExpander {
+protected:
+  struct tPending {
+    uint64_t Seq;
+    uint32_t timestamp;
+    std::shared_ptr<tN2kMsg> Msg;
+    bool operator<(const tPending &other) const { return Seq>other.Seq; } // min heap
+  };
+
+  std::priority_queue<tPending> Queue;
+  uint64_t NextSeq;
+  bool Finished;
+  std::vector<std::pair<int32_t,uint32_t> > Deltas;
+
+public:
+  tSailmaxRunExpander();
+  void Clear();
+
+  // Returns true, if next message in sequence requires a new line.
+  bool NeedLine() const { return !Finished && ( Queue.empty() || Queue.top().Seq!=NextSeq ); }
+
+  // Returns false, if line is not a valid Sailmax sentence or run record.
+  bool AddLine(const char *Line);
+
+  // Returns next message in original sequence, if available.
+  bool Next(tN2kMsg &msg, uint32_t &timestamp);
+
+  // End of input. Returns rest of messages even if sequence has gaps
+  // due to damaged records.
+  void Finish() { Finished=true; }
+  bool IsEmpty() const { return Queue.empty(); }
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  tests for bulk decode to field arrays
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <math.h>
+#include <vector>
+#include "catch.hpp"
+#include <N2kMessages.h>
+#include <N2kMessageCodecs.h>
+#include "N2kBulkDecode.h"
+
+TEST_CASE("Bulk decode matches codec and ParseN2k", "[bulkdecode]") {
+  // Odd count leaves scalar tail after SIMD blocks
+  const size_t Count=1003;
+  std::vector<tN2kMsg> Msgs(Count);
+  uint32_t Seed=7;
+  for (size_t i=0; i<Count; i++) {
+    Seed=Seed*1103515245UL+12345;
+    double Speed=( i%17==0 ? N2kDoubleNA : (Seed>>16)%6000/100.0 );
+    double Angle=( i%23==0 ? N2kDoubleNA : (Seed>>8)%62831/10000.0 );
+    SetN2kPGN130306(Msgs[i],i,Speed,Angle,(tN2kWindReference)(i%5));
+  }
+  Msgs[5].DataLen=3; // Short message, angle missing
+  std::vector<uint8_t> Payloads(Count*8);
+  REQUIRE( N2kPackPayloads(&Msgs[0],Count,130306L,8,&Payloads[0])==Count );
+
+  std::vector<float> Speed(Count), Angle(Count);
+  std::vector<uint8_t> Reference(Count);
+  N2kBulkDecodeScaled<tN2kWindSpeedFloatData::tWindSpeed>(&Payloads[0],8,Count,&Speed[0]);
+  N2kBulkDecodeScaled<tN2kWindSpeedFloatData::tWindAngle>(&Payloads[0],8,Count,&Angle[0]);
+  N2kBulkDecodeBits<tN2kWindSpeedFloatData::tWindReference>(&Payloads[0],8,Count,&Reference[0]);
+
+  for (size_t i=0; i<Count; i++) {
+    tN2kWindSpeedFloatData F;
+    REQUIRE( tN2kPGN130306FloatCodec::Parse(Msgs[i],F) );
+    REQUIRE( Speed[i]==F.WindSpeed );
+    REQUIRE( Angle[i]==F.WindAngle );
+    REQUIRE( Reference[i]==F.WindReference );
+
+    unsigned char SID;
+    double s,a;
+    tN2kWindReference ref;
+    REQUIRE( ParseN2kPGN130306(Msgs[i],SID,s,a,ref) );
+    if ( N2kIsNA(s) ) { REQUIRE( N2kIsNA(Speed[i]) ); } else { REQUIRE( fabs(Speed[i]-s)<=0.01 ); }
+    if ( i!=5 ) {
+      if ( N2kIsNA(a) ) { REQUIRE( N2kIsNA(Angle[i]) ); } else { REQUIRE( fabs(Angle[i]-a)<=0.0001 ); }
+    }
+  }
+  REQUIRE( N2kIsNA(Angle[5]) );
+}
+
+TEST_CASE("Bulk decode signed fields with message stride", "[bulkdecode]") {
+  const size_t Count=10;
+  std::vector<tN2kMsg> Msgs(Count);
+  for (size_t i=0; i<Count; i++) {
+    SetN2kPGN127250(Msgs[i],i,0.5+i*0.1,( i==3 ? N2kDoubleNA : -0.02*i ),0.1-0.05*i,N2khr_magnetic);
+  }
+  std::vector<float> Deviation(Count), Variation(Count);
+  N2kBulkDecodeScaled<tN2kHeadingFloatData::tDeviation>(Msgs[0].Data,sizeof(tN2kMsg),Count,&Deviation[0],NAN);
+  N2kBulkDecodeScaled<tN2kHeadingFloatData::tVariation>(Msgs[0].Data,sizeof(tN2kMsg),Count,&Variation[0]);
+
+  for (size_t i=0; i<Count; i++) {
+    tN2kHeadingFloatData F;
+    REQUIRE( tN2kPGN127250FloatCodec::Parse(Msgs[i],F) );
+    if ( i==3 ) { REQUIRE( std::isnan(Deviation[i]) ); } else { REQUIRE( Deviation[i]==F.Deviation ); }
+    REQUIRE( Variation[i]==F.Variation );
+  }
+  REQUIRE( Variation[9]<0 );
+}
+
+TEST_CASE("Bulk decode 4 byte fields", "[bulkdecode]") {
+  const size_t Count=9;
+  std::vector<tN2kMsg> Msgs(Count);
+  for (size_t i=0; i<Count; i++) {
+    SetN2kPGN129025(Msgs[i],-60.0+i*0.001,( i==4 ? N2kDoubleNA : 24.9+i*0.001 ));
+  }
+  std::vector<uint8_t> Payloads(Count*8);
+  N2kPackPayloads(&Msgs[0],Count,129025L,8,&Payloads[0]);
+  std::vector<float> Latitude(Count), Longitude(Count);
+  N2kBulkDecodeScaled<tN2kLatLonRapidFloatData::tLatitude>(&Payloads[0],8,Count,&Latitude[0]);
+  N2kBulkDecodeScaled<tN2kLatLonRapidFloatData::tLongitude>(&Payloads[0],8,Count,&Longitude[0]);
+  for (size_t i=0; i<Count; i++) {
+    tN2kLatLonRapidFloatData F;
+    REQUIRE( tN2kPGN129025FloatCodec::Parse(Msgs[i],F) );
+    REQUIRE( Latitude[i]==F.Latitude );
+    REQUIRE( Longitude[i]==F.Longitude );
+  }
+  REQUIRE( N2kIsNA(Longitude[4]) );
+}
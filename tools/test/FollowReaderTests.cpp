@@ -0,0 +1,179 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  tests for tSailmaxFollowReader
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "catch.hpp"
+#include "SailmaxFollowReader.h"
+
+// Unique file in /tmp, so tests do not leave files to working directory
+static const char *TempTestFile() {
+  static char Path[]="/tmp/FollowReaderTestXXXXXX";
+  int fd=mkstemp(Path);
+  if ( fd>=0 ) close(fd);
+  return Path;
+}
+
+static const char *TestFile=TempTestFile();
+
+static void Append(const char *text) {
+  FILE *f=fopen(TestFile,"ab");
+  REQUIRE(f!=0);
+  fputs(text,f);
+  fclose(f);
+}
+
+TEST_CASE("Follow reader returns only complete lines") {
+  unlink(TestFile);
+  Append("@100,127245,02,00FFFF7F0AFEFFFF*2F\r\n@101,1272");
+
+  tSailmaxFollowReader Reader(1024);
+  REQUIRE(Reader.Open(TestFile));
+
+  const char *Line=Reader.NextLine();
+  REQUIRE(Line!=0);
+  REQUIRE(strcmp(Line,"@100,127245,02,00FFFF7F0AFEFFFF*2F")==0);
+  // Partial line is held back
+  REQUIRE(Reader.NextLine()==0);
+
+  Append("45,02,00FFFF7F0AFEFFFF*2F\r\n");
+  REQUIRE(Reader.WaitForData(1000));
+  Line=Reader.NextLine();
+  REQUIRE(Line!=0);
+  REQUIRE(strcmp(Line,"@101,127245,02,00FFFF7F0AFEFFFF*2F")==0);
+  REQUIRE(Reader.NextLine()==0);
+  REQUIRE(Reader.GetLinesRead()==2);
+  REQUIRE(Reader.GetBytesRead()==strlen("@100,127245,02,00FFFF7F0AFEFFFF*2F\r\n")*2);
+
+  unlink(TestFile);
+}
+
+TEST_CASE("Follow reader decodes new messages") {
+  unlink(TestFile);
+  Append("Header line\r\n");
+
+  tSailmaxFollowReader Reader(1024);
+  Reader.SetPollInterval(10);
+  REQUIRE(Reader.Open(TestFile));
+
+  tN2kMsg msg;
+  uint32_t timestamp;
+  REQUIRE(!Reader.NextMsg(msg,timestamp,0));
+  REQUIRE(Reader.GetBadLines()==1);
+
+  Append("@205734,060928,00,E601A11C008532C0*21\r\n");
+  REQUIRE(Reader.NextMsg(msg,timestamp,1000));
+  REQUIRE(timestamp==205734);
+  REQUIRE(msg.PGN==60928);
+  REQUIRE(msg.Source==0);
+  REQUIRE(msg.DataLen==8);
+
+  unlink(TestFile);
+}
+
+TEST_CASE("Follow reader from end skips old and partial lines") {
+  unlink(TestFile);
+  Append("@100,127245,02,00FFFF7F0AFEFFFF*2F\r\n@101,1272");
+
+  tSailmaxFollowReader Reader(1024);
+  REQUIRE(Reader.Open(TestFile,false));
+  REQUIRE(Reader.NextLine()==0);
+
+  Append("45,02,00FFFF7F0AFEFFFF*2F\r\n@102,127245,02,00FFFF7F0AFEFFFF*2F\r\n");
+  const char *Line=Reader.NextLine();
+  REQUIRE(Line!=0);
+  REQUIRE(strncmp(Line,"@102,",5)==0);
+
+  unlink(TestFile);
+}
+
+TEST_CASE("Follow reader restarts on truncated file") {
+  unlink(TestFile);
+  Append("@100,127245,02,00FFFF7F0AFEFFFF*2F\r\n@101,127245,02,00FFFF7F0AFEFFFF*2F\r\n");
+
+  tSailmaxFollowReader Reader(1024);
+  Reader.SetPollInterval(10);
+  REQUIRE(Reader.Open(TestFile));
+  REQUIRE(Reader.NextLine()!=0);
+  REQUIRE(Reader.NextLine()!=0);
+
+  FILE *f=fopen(TestFile,"wb");
+  fputs("@5,127245,02,00FFFF7F0AFEFFFF*2F\r\n",f);
+  fclose(f);
+  REQUIRE(Reader.WaitForData(1000));
+  const char *Line=Reader.NextLine();
+  REQUIRE(Line!=0);
+  REQUIRE(strncmp(Line,"@5,",3)==0);
+  REQUIRE(Reader.GetRestarts()==1);
+
+  unlink(TestFile);
+}
+
+TEST_CASE("Follow reader skips too long lines") {
+  unlink(TestFile);
+  char Long[600];
+  memset(Long,'A',sizeof(Long)-3);
+  strcpy(Long+sizeof(Long)-3,"\r\n");
+  Append(Long);
+  Append("@100,127245,02,00FFFF7F0AFEFFFF*2F\r\n");
+
+  tSailmaxFollowReader Reader(256);
+  REQUIRE(Reader.Open(TestFile));
+  const char *Line=Reader.NextLine();
+  REQUIRE(Line!=0);
+  REQUIRE(strncmp(Line,"@100,",5)==0);
+  REQUIRE(Reader.GetLongLines()==1);
+
+  unlink(TestFile);
+}
+
+TEST_CASE("Follow reader expands run records") {
+  unlink(TestFile);
+  Append("&205929,060928,21,B2CF6B340082FAC0,98;872/2*61\r\n@206000,127245,02,00FFFF7F0AFEFFFF*2E\r\n");
+
+  tSailmaxFollowReader Reader(1024);
+  REQUIRE(Reader.Open(TestFile));
+
+  tN2kMsg msg;
+  uint32_t timestamp;
+  uint32_t Expected[4]={205929,206027,206000,206899};
+  for ( int i=0; i<4; i++ ) {
+    REQUIRE(Reader.NextMsg(msg,timestamp,0));
+    REQUIRE(timestamp==Expected[i]);
+  }
+  REQUIRE(!Reader.NextMsg(msg,timestamp,0));
+
+  unlink(TestFile);
+}
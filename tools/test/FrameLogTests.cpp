@@ -0,0 +1,193 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  tests for raw CAN frame log and replay
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <string.h>
+#include <vector>
+#include "catch.hpp"
+#include <N2kMessages.h>
+#include "N2kFrameLog.h"
+#include "N2kFrameReplay.h"
+#include "N2kLoopback.h"
+
+struct tMemoryLog {
+  std::vector<uint8_t> Data;
+  size_t ReadPos;
+  size_t ChunkSize;
+  tMemoryLog() : ReadPos(0), ChunkSize(256) {}
+};
+
+static void WriteData(const uint8_t *Data, size_t len, void *Context) {
+  tMemoryLog *Log=(tMemoryLog *)Context;
+  Log->Data.insert(Log->Data.end(),Data,Data+len);
+}
+
+static size_t ReadData(uint8_t *Data, size_t size, void *Context) {
+  tMemoryLog *Log=(tMemoryLog *)Context;
+  size_t len=Log->Data.size()-Log->ReadPos;
+  if ( len>size ) len=size;
+  if ( len>Log->ChunkSize ) len=Log->ChunkSize;
+  memcpy(Data,Log->Data.data()+Log->ReadPos,len);
+  Log->ReadPos+=len;
+  return len;
+}
+
+class tCollectHandler : public tNMEA2000::tMsgHandler {
+public:
+  std::vector<tN2kMsg> Msgs;
+  tCollectHandler(unsigned long _PGN, tNMEA2000 *_pNMEA2000) : tNMEA2000::tMsgHandler(_PGN,_pNMEA2000) {}
+  void HandleMsg(const tN2kMsg &N2kMsg) { Msgs.push_back(N2kMsg); }
+};
+
+struct tCapture {
+  tN2kLoopbackBus *Bus;
+  tN2kFrameLogWriter *Writer;
+};
+
+static void CaptureFrame(const tN2kCANFrame &Frame, void *Context) {
+  tCapture *Capture=(tCapture *)Context;
+  Capture->Writer->Add(Frame,Capture->Bus->GetMicros());
+}
+
+TEST_CASE("Frame log round trip", "[framelog]") {
+  tMemoryLog Log;
+  std::vector<tN2kCANFrame> Frames;
+  std::vector<uint64_t> Times;
+  uint64_t Time=5000000000ULL;
+
+  {
+    tN2kFrameLogWriter Writer(WriteData,&Log);
+    for ( int i=0; i<100; i++ ) {
+      tN2kCANFrame Frame;
+      Frame.id=(0x09f80100UL+i*0x10001UL) & 0x1fffffffUL;
+      Frame.len=i%9;
+      for ( int j=0; j<8; j++ ) Frame.buf[j]=( j<Frame.len ? (unsigned char)(i*7+j) : 0 );
+      Time+=( i%10==0 ? 3000000000ULL : (uint64_t)i*37 ); // Also long gaps
+      Frames.push_back(Frame);
+      Times.push_back(Time);
+      Writer.Add(Frame,Time);
+    }
+    REQUIRE( Writer.GetFrames()==100 );
+  }
+  REQUIRE( memcmp(Log.Data.data(),"N2KF\x01",5)==0 );
+
+  Log.ChunkSize=7; // Records will be split between reads
+  tN2kFrameLogReader Reader(ReadData,&Log);
+  tN2kCANFrame Frame;
+  uint64_t FrameTime;
+  for ( size_t i=0; i<Frames.size(); i++ ) {
+    REQUIRE( Reader.Next(Frame,FrameTime) );
+    REQUIRE( FrameTime==Times[i] );
+    REQUIRE( Frame.id==Frames[i].id );
+    REQUIRE( Frame.len==Frames[i].len );
+    REQUIRE( memcmp(Frame.buf,Frames[i].buf,8)==0 );
+  }
+  REQUIRE( Reader.GetStartTime()==Times[0] );
+  REQUIRE( !Reader.Next(Frame,FrameTime) );
+  REQUIRE( Reader.IsEnded() );
+  REQUIRE( !Reader.IsError() );
+
+  SECTION("truncated log is error") {
+    Log.Data.pop_back();
+    Log.ReadPos=0;
+    tN2kFrameLogReader Truncated(ReadData,&Log);
+    for ( size_t i=0; i<Frames.size()-1; i++ ) REQUIRE( Truncated.Next(Frame,FrameTime) );
+    REQUIRE( !Truncated.Next(Frame,FrameTime) );
+    REQUIRE( Truncated.IsError() );
+  }
+
+  SECTION("wrong header is error") {
+    Log.Data[3]='X';
+    Log.ReadPos=0;
+    tN2kFrameLogReader Wrong(ReadData,&Log);
+    REQUIRE( !Wrong.Next(Frame,FrameTime) );
+    REQUIRE( Wrong.IsError() );
+  }
+}
+
+TEST_CASE("Captured frames replay to same messages", "[framelog]") {
+  tMemoryLog Log;
+  std::vector<tN2kMsg> Captured;
+
+  {
+    tN2kLoopbackBus Bus;
+    tNMEA2000_Loopback Sender1(Bus);
+    tNMEA2000_Loopback Sender2(Bus);
+    tNMEA2000_Loopback Receiver(Bus);
+    Sender1.SetDeviceInformation(1,130,25,2046);
+    Sender1.SetMode(tNMEA2000::N2km_NodeOnly,22);
+    Sender2.SetDeviceInformation(2,130,25,2046);
+    Sender2.SetMode(tNMEA2000::N2km_NodeOnly,23);
+    Receiver.SetMode(tNMEA2000::N2km_ListenOnly);
+    Receiver.EnableForward(false);
+
+    tN2kFrameLogWriter Writer(WriteData,&Log);
+    tCapture Capture={&Bus,&Writer};
+    Receiver.SetFrameCaptureHandler(CaptureFrame,&Capture);
+    tCollectHandler All(0,&Receiver);
+    Bus.Run(300);
+
+    tN2kMsg N2kMsg;
+    for ( int i=0; i<20; i++ ) {
+      // Interleaved fast packets from two sources
+      SetN2kGNSS(N2kMsg,i,17800,43200.0+i,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+      REQUIRE( Sender1.SendMsg(N2kMsg) );
+      SetN2kGNSS(N2kMsg,100+i,17800,43200.0+i,60.2,25.0,11.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,9,0.8);
+      REQUIRE( Sender2.SendMsg(N2kMsg) );
+      SetN2kTrueHeading(N2kMsg,i,0.1*i);
+      REQUIRE( Sender1.SendMsg(N2kMsg) );
+      Bus.Run(50);
+    }
+    Writer.Flush();
+    Captured=All.Msgs;
+    REQUIRE( Writer.GetFrames()==Receiver.GetNodeStatistics().RxFrames );
+  }
+  REQUIRE( Captured.size()>=60 );
+
+  tN2kFrameLogReader Reader(ReadData,&Log);
+  tNMEA2000_FrameReplay Replay(Reader);
+  Replay.EnableForward(false);
+  tCollectHandler Replayed(0,&Replay);
+  Replay.Run();
+
+  REQUIRE( !Reader.IsError() );
+  REQUIRE( Replay.GetSentFrames()==0 );
+  REQUIRE( Replayed.Msgs.size()==Captured.size() );
+  for ( size_t i=0; i<Captured.size(); i++ ) {
+    REQUIRE( Replayed.Msgs[i].PGN==Captured[i].PGN );
+    REQUIRE( Replayed.Msgs[i].Source==Captured[i].Source );
+    REQUIRE( Replayed.Msgs[i].DataLen==Captured[i].DataLen );
+    REQUIRE( memcmp(Replayed.Msgs[i].Data,Captured[i].Data,Captured[i].DataLen)==0 );
+    // Replay clock follows capture timestamps, so times match.
+    REQUIRE( Replayed.Msgs[i].MsgTime==Captured[i].MsgTime );
+  }
+}
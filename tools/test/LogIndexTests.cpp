@@ -0,0 +1,137 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  tests for tSailmaxLogIndex and tSailmaxLogQuery
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "catch.hpp"
+#include <SailmaxFormat.h>
+#include "SailmaxLogIndex.h"
+
+#define MAX_N2K_MSG_LINE 500
+
+static const char *TestFile="LogIndexTest.log";
+static const char *TestIndexFile="LogIndexTest.log.idx";
+
+static void WriteLine(FILE *f, uint32_t timestamp, unsigned long PGN, unsigned char Source, int DataLen) {
+  tN2kMsg msg(Source);
+  msg.SetPGN(PGN);
+  for ( int i=0; i<DataLen; i++ ) msg.AddByte((unsigned char)(timestamp+i));
+  char Line[MAX_N2K_MSG_LINE];
+  REQUIRE(N2kToSailmax(msg,timestamp,Line,sizeof(Line))>0);
+  fprintf(f,"%s\r\n",Line);
+}
+
+static void WriteTestLog() {
+  FILE *f=fopen(TestFile,"wb");
+  REQUIRE(f!=0);
+  // About 40 blocks of heading and rudder, one AIS message in block 17
+  for ( int i=0; i<2000; i++ ) {
+    WriteLine(f,1000+i,127250,0x23,8);
+    WriteLine(f,1000+i,127245,0x02,8);
+    if ( i==17*50 ) WriteLine(f,1000+i,129038,0x08,28);
+  }
+  fclose(f);
+}
+
+static void CountMatch(const char *, uint32_t, const tN2kMsg &msg, void *Context) {
+  (*(int *)Context)++;
+}
+
+TEST_CASE("Sailmax header parser") {
+  uint32_t timestamp;
+  unsigned long PGN;
+  unsigned char Source;
+  const char *Line="@22643312,128267,23,DB28010000A0F6FF*28";
+  REQUIRE(SailmaxParseHeader(Line,strlen(Line),timestamp,PGN,Source));
+  REQUIRE(timestamp==22643312);
+  REQUIRE(PGN==128267);
+  REQUIRE(Source==0x23);
+  REQUIRE(!SailmaxParseHeader("Source: 0",9,timestamp,PGN,Source));
+  REQUIRE(!SailmaxParseHeader("@1,2",4,timestamp,PGN,Source));
+}
+
+TEST_CASE("Index blocks are line aligned and summarize content") {
+  WriteTestLog();
+  tSailmaxLogIndex Index;
+  REQUIRE(Index.Build(TestFile,4096));
+  REQUIRE(Index.GetBlockCount()>10);
+
+  uint64_t Offset=0;
+  size_t AisBlocks=0;
+  for ( size_t i=0; i<Index.GetBlockCount(); i++ ) {
+    const tSailmaxLogIndex::tBlock &Block=Index.GetBlock(i);
+    REQUIRE(Block.Offset==Offset);
+    Offset+=Block.Length;
+    REQUIRE(Block.HasSource(0x23));
+    REQUIRE(Block.HasSource(0x02));
+    REQUIRE(Block.MayHavePGN(127250));
+    if ( Block.HasSource(0x08) ) AisBlocks++;
+  }
+  REQUIRE(Offset==Index.GetFileSize());
+  REQUIRE(AisBlocks==1);
+
+  REQUIRE(Index.Save(TestIndexFile));
+  tSailmaxLogIndex Loaded;
+  REQUIRE(Loaded.Load(TestIndexFile));
+  REQUIRE(Loaded.IsValidFor(TestFile));
+  REQUIRE(Loaded.GetBlockCount()==Index.GetBlockCount());
+  REQUIRE(memcmp(&Loaded.GetBlock(3),&Index.GetBlock(3),sizeof(tSailmaxLogIndex::tBlock))==0);
+
+  unlink(TestIndexFile);
+  unlink(TestFile);
+}
+
+TEST_CASE("Query skips blocks without requested PGN or source") {
+  WriteTestLog();
+  tSailmaxLogIndex Index;
+  REQUIRE(Index.Build(TestFile,4096));
+
+  tSailmaxLogQuery AisQuery;
+  AisQuery.AddPGN(129038);
+  AisQuery.AddPGN(129039);
+  int Count=0;
+  REQUIRE(AisQuery.Run(TestFile,Index,CountMatch,&Count));
+  REQUIRE(Count==1);
+  REQUIRE(AisQuery.GetBlocksScanned()<=3); // Bloom false positives are possible
+  REQUIRE(AisQuery.GetBytesTouched()*10<Index.GetFileSize());
+
+  tSailmaxLogQuery SourceQuery;
+  SourceQuery.AddSource(0x02);
+  Count=0;
+  REQUIRE(SourceQuery.Run(TestFile,Index,CountMatch,&Count));
+  REQUIRE(Count==2000);
+  REQUIRE(SourceQuery.GetBlocksSkipped()==0);
+
+  unlink(TestFile);
+}
@@ -0,0 +1,325 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  tests for loopback CAN bus
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <string.h>
+#include <vector>
+#include "catch.hpp"
+#include <N2kMessages.h>
+#include "N2kLoopback.h"
+
+class tCollectHandler : public tNMEA2000::tMsgHandler {
+public:
+  std::vector<tN2kMsg> Msgs;
+  tCollectHandler(unsigned long _PGN, tNMEA2000 *_pNMEA2000) : tNMEA2000::tMsgHandler(_PGN,_pNMEA2000) {}
+  void HandleMsg(const tN2kMsg &N2kMsg) { Msgs.push_back(N2kMsg); }
+};
+
+static void SetupNode(tNMEA2000_Loopback &Node, unsigned long UniqueNumber, unsigned char Source, tNMEA2000::tN2kMode Mode=tNMEA2000::N2km_NodeOnly) {
+  Node.SetDeviceInformation(UniqueNumber,130,25,2046);
+  Node.SetMode(Mode,Source);
+  Node.EnableForward(false);
+}
+
+static void GNSSMsg(tN2kMsg &N2kMsg, unsigned char SID) {
+  SetN2kGNSS(N2kMsg,SID,17800,43200.0+SID,60.1,24.9,12.0,N2kGNSSt_GPS,N2kGNSSm_GNSSfix,8,0.9);
+}
+
+TEST_CASE("Loopback bus timing and arbitration", "[loopback]") {
+  tN2kLoopbackBus Bus(250000);
+  tNMEA2000_Loopback Sender(Bus);
+  tNMEA2000_Loopback Receiver(Bus);
+  SetupNode(Sender,1,22);
+  SetupNode(Receiver,2,0,tNMEA2000::N2km_ListenOnly);
+
+  REQUIRE( Bus.FrameTime(8)==536 ); // 134 bits at 250 kbit/s
+  REQUIRE( Bus.GetMillis()==1000 );
+
+  Bus.Run(300); // Open and address claim
+  uint64_t Frames=Bus.GetStatistics().Frames;
+  REQUIRE( Frames>=1 );
+  REQUIRE( Sender.GetN2kSource()==22 );
+
+  tCollectHandler Heading(127250L,&Receiver);
+  tN2kMsg N2kMsg;
+  for ( int i=0; i<10; i++ ) {
+    SetN2kTrueHeading(N2kMsg,i,0.1*i);
+    REQUIRE( Sender.SendMsg(N2kMsg) );
+  }
+  uint64_t Start=Bus.GetMicros();
+  Bus.Advance(10*536-1);
+  REQUIRE( Bus.GetStatistics().Frames==Frames+9 );
+  Bus.Advance(1);
+  REQUIRE( Bus.GetStatistics().Frames==Frames+10 );
+  REQUIRE( Bus.GetMicros()==Start+10*536 );
+  Bus.Run(1);
+  REQUIRE( Heading.Msgs.size()==10 );
+  REQUIRE( Heading.Msgs[3].Source==22 );
+
+  SECTION("lower id wins") {
+    tNMEA2000_Loopback Other(Bus);
+    SetupNode(Other,3,30);
+    Bus.Run(300);
+    tCollectHandler All(0,&Receiver);
+    SetN2kTrueHeading(N2kMsg,1,0.5);
+    N2kMsg.Priority=6;
+    REQUIRE( Sender.SendMsg(N2kMsg) );
+    N2kMsg.Priority=2;
+    REQUIRE( Other.SendMsg(N2kMsg) );
+    Bus.Run(2);
+    REQUIRE( All.Msgs.size()==2 );
+    REQUIRE( All.Msgs[0].Source==30 );
+    REQUIRE( All.Msgs[1].Source==22 );
+  }
+}
+
+TEST_CASE("Loopback bus fast packet, loss and TP", "[loopback]") {
+  tN2kLoopbackBus Bus;
+  tNMEA2000_Loopback Sender(Bus);
+  tNMEA2000_Loopback Receiver(Bus);
+  SetupNode(Sender,1,22);
+  SetupNode(Receiver,2,0,tNMEA2000::N2km_ListenOnly);
+  tCollectHandler GNSS(129029L,&Receiver);
+  Bus.Run(300);
+
+  SECTION("fast packet reassembly") {
+    tN2kMsg N2kMsg;
+    for ( int i=0; i<20; i++ ) {
+      GNSSMsg(N2kMsg,i);
+      REQUIRE( Sender.SendMsg(N2kMsg) );
+      Bus.Run(10);
+    }
+    REQUIRE( GNSS.Msgs.size()==20 );
+    GNSSMsg(N2kMsg,7);
+    REQUIRE( GNSS.Msgs[7].DataLen==N2kMsg.DataLen );
+    REQUIRE( memcmp(GNSS.Msgs[7].Data,N2kMsg.Data,N2kMsg.DataLen)==0 );
+  }
+
+  SECTION("lost frames drop whole fast packet") {
+    tN2kMsg N2kMsg;
+    GNSSMsg(N2kMsg,1);
+    Bus.DropNextFrames(1);
+    REQUIRE( Sender.SendMsg(N2kMsg) );
+    Bus.Run(10);
+    GNSSMsg(N2kMsg,2);
+    REQUIRE( Sender.SendMsg(N2kMsg) );
+    Bus.Run(10);
+    REQUIRE( GNSS.Msgs.size()==1 );
+    REQUIRE( GNSS.Msgs[0].Data[0]==2 );
+    REQUIRE( Receiver.GetNodeStatistics().LostFrames==1 );
+
+    Bus.SetFrameLoss(1.0);
+    REQUIRE( Sender.SendMsg(N2kMsg) );
+    Bus.Run(10);
+    REQUIRE( GNSS.Msgs.size()==1 );
+
+    Bus.SetFrameLoss(0.2,7);
+    for ( int i=0; i<50; i++ ) {
+      GNSSMsg(N2kMsg,i);
+      REQUIRE( Sender.SendMsg(N2kMsg) );
+      Bus.Run(10);
+    }
+    REQUIRE( GNSS.Msgs.size()>1 );
+    REQUIRE( GNSS.Msgs.size()<40 );
+    for ( size_t i=1; i<GNSS.Msgs.size(); i++ ) {
+      GNSSMsg(N2kMsg,GNSS.Msgs[i].Data[0]);
+      REQUIRE( memcmp(GNSS.Msgs[i].Data,N2kMsg.Data,N2kMsg.DataLen)==0 );
+    }
+  }
+
+  SECTION("broadcast TP message") {
+    tCollectHandler Proprietary(65280L,&Receiver);
+    tN2kMsg N2kMsg;
+    N2kMsg.SetPGN(65280L);
+    N2kMsg.Priority=7;
+    for ( int i=0; i<40; i++ ) N2kMsg.AddByte(i);
+    N2kMsg.SetIsTPMessage();
+    REQUIRE( Sender.SendMsg(N2kMsg) );
+    Bus.Run(1000);
+    REQUIRE( Proprietary.Msgs.size()==1 );
+    REQUIRE( Proprietary.Msgs[0].DataLen==40 );
+    REQUIRE( Proprietary.Msgs[0].Data[39]==39 );
+  }
+}
+
+TEST_CASE("Loopback bus concurrent TP sessions", "[loopback]") {
+  tN2kLoopbackBus Bus;
+  tNMEA2000_Loopback Sender(Bus);
+  tNMEA2000_Loopback Receiver1(Bus);
+  tNMEA2000_Loopback Receiver2(Bus);
+  tNMEA2000_Loopback Receiver3(Bus);
+  tNMEA2000_Loopback *Receivers[]={ &Receiver1, &Receiver2, &Receiver3 };
+  SetupNode(Sender,1,22);
+  Sender.SetTPSessionPoolSize(8);
+  for ( int i=0; i<3; i++ ) SetupNode(*Receivers[i],2+i,30+i,tNMEA2000::N2km_ListenAndNode);
+  Bus.Run(300);
+
+  tCollectHandler Proprietary1(65280L,&Receiver1);
+  tCollectHandler Proprietary2(65280L,&Receiver2);
+  tCollectHandler Proprietary3(65280L,&Receiver3);
+  tCollectHandler *Collected[]={ &Proprietary1, &Proprietary2, &Proprietary3 };
+
+  // Broadcast and two messages to each receiver. Second ones wait in pool.
+  tN2kMsg N2kMsg;
+  N2kMsg.SetPGN(65280L);
+  N2kMsg.Priority=7;
+  for ( int i=0; i<200; i++ ) N2kMsg.AddByte(i); // 29 packets
+  N2kMsg.SetIsTPMessage();
+  REQUIRE( Sender.SendMsg(N2kMsg) );
+  for ( int m=0; m<2; m++ ) {
+    for ( int i=0; i<3; i++ ) {
+      N2kMsg.Destination=30+i;
+      N2kMsg.Data[0]=m;
+      REQUIRE( Sender.SendMsg(N2kMsg) );
+    }
+  }
+  REQUIRE( Sender.GetTPStatistics().MaxSessions==7 );
+  REQUIRE( Sender.GetTPStatistics().Started==4 );
+
+  uint64_t Start=Bus.GetMicros();
+  uint64_t AddressedDone=0;
+  while ( Bus.GetMicros()-Start<2000000 && Sender.GetTPStatistics().Completed<7 ) {
+    Bus.Run(1);
+    if ( AddressedDone==0 && Sender.GetTPStatistics().Completed==6 ) AddressedDone=Bus.GetMicros()-Start;
+  }
+  uint64_t Elapsed=Bus.GetMicros()-Start;
+
+  const tNMEA2000::tTPStatistics &Statistics=Sender.GetTPStatistics();
+  REQUIRE( Statistics.Started==7 );
+  REQUIRE( Statistics.Completed==7 );
+  REQUIRE( Statistics.Aborted==0 );
+  REQUIRE( Statistics.TimedOut==0 );
+  for ( int i=0; i<3; i++ ) { // Listening receivers see also messages to others
+    std::vector<tN2kMsg> Own;
+    for ( size_t j=0; j<Collected[i]->Msgs.size(); j++ ) {
+      if ( Collected[i]->Msgs[j].Destination==30+i ) Own.push_back(Collected[i]->Msgs[j]);
+    }
+    REQUIRE( Own.size()==2 );
+    REQUIRE( Own[0].Data[0]==0 );
+    REQUIRE( Own[1].Data[0]==1 );
+    REQUIRE( Own[1].DataLen==200 );
+    REQUIRE( Own[1].Data[199]==199 );
+  }
+
+  // Six addressed messages of 32 frames each share the bus while broadcast is
+  // still running. Addressed throughput is limited by bus, not by session turns.
+  REQUIRE( AddressedDone>0 );
+  REQUIRE( AddressedDone<150000 ); // 192 frames take 103 ms bus time
+  REQUIRE( 6*200*1000000ULL/AddressedDone>6000 ); // bytes/s
+  // Broadcast goes with 50 ms packet interval on free bus
+  REQUIRE( Elapsed>=28*50000 );
+  REQUIRE( Elapsed<28*60000 );
+}
+
+TEST_CASE("Loopback bus address claim", "[loopback]") {
+  tN2kLoopbackBus Bus;
+  tNMEA2000_Loopback Node1(Bus);
+  tNMEA2000_Loopback Node2(Bus);
+  SetupNode(Node1,1,22);
+  SetupNode(Node2,2,22);
+
+  Bus.Run(2000);
+  REQUIRE( Node1.GetN2kSource()!=Node2.GetN2kSource() );
+  REQUIRE( Bus.GetLoad()<0.1 );
+}
+
+TEST_CASE("Loopback bus virtual devices", "[loopback]") {
+  const int Count=120;
+  tN2kLoopbackBus Bus;
+  tNMEA2000_Loopback Replay(Bus);
+  tNMEA2000_Loopback Real(Bus);
+  tNMEA2000_Loopback Receiver(Bus);
+  Replay.SetDeviceCount(Count);
+  SetupNode(Replay,1,10); // Sources 10-129
+  Replay.SetTxQueueSize(256);
+  SetupNode(Real,0,50); // Lower NAME, so it keeps 50
+  SetupNode(Receiver,0,0,tNMEA2000::N2km_ListenOnly);
+  tCollectHandler Heading(127250L,&Receiver);
+
+  Bus.Run(2000);
+  REQUIRE( Real.GetN2kSource()==50 );
+  bool Used[256]={ false };
+  Used[50]=true;
+  for ( int i=0; i<Count; i++ ) {
+    unsigned char Source=Replay.GetN2kSource(i);
+    REQUIRE( Source<=N2kMaxCanBusAddress );
+    REQUIRE( !Used[Source] );
+    Used[Source]=true;
+    if ( i!=40 ) REQUIRE( Source==10+i );
+  }
+
+  // Every device sends with own claimed source
+  tN2kMsg N2kMsg;
+  for ( int i=0; i<Count; i++ ) {
+    SetN2kTrueHeading(N2kMsg,i,0.01*i);
+    REQUIRE( Replay.SendMsg(N2kMsg,i) );
+  }
+  Bus.Run(100);
+  REQUIRE( Heading.Msgs.size()==Count );
+  for ( int i=0; i<Count; i++ ) {
+    REQUIRE( Heading.Msgs[i].Source==Replay.GetN2kSource(Heading.Msgs[i].Data[0]) );
+  }
+}
+
+TEST_CASE("Loopback bus devices on all addresses", "[loopback]") {
+  const int Count=N2kMaxCanBusAddress+1;
+  tN2kLoopbackBus Bus;
+  tNMEA2000_Loopback Replay(Bus);
+  tNMEA2000_Loopback Receiver(Bus);
+  Replay.SetDeviceCount(Count);
+  SetupNode(Replay,1,15); // Default source, addresses wrap after 251
+  Replay.SetTxQueueSize(512);
+  SetupNode(Receiver,0,0,tNMEA2000::N2km_ListenOnly);
+  tCollectHandler Heading(127250L,&Receiver);
+
+  bool Used[256]={ false };
+  for ( int i=0; i<Count; i++ ) {
+    unsigned char Source=Replay.GetN2kSource(i);
+    REQUIRE( Source==(15+i)%Count );
+    REQUIRE( !Used[Source] );
+    Used[Source]=true;
+  }
+
+  Bus.Run(3000);
+  for ( int i=0; i<Count; i++ ) REQUIRE( Replay.GetN2kSource(i)==(15+i)%Count );
+
+  tN2kMsg N2kMsg;
+  for ( int i=0; i<Count; i++ ) {
+    SetN2kTrueHeading(N2kMsg,i,0.01*i);
+    REQUIRE( Replay.SendMsg(N2kMsg,i) );
+  }
+  Bus.Run(200);
+  REQUIRE( Heading.Msgs.size()==Count );
+  for ( size_t i=0; i<Heading.Msgs.size(); i++ ) {
+    REQUIRE( Heading.Msgs[i].Source==Replay.GetN2kSource(Heading.Msgs[i].Data[0]) );
+  }
+}
@@ -0,0 +1,160 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  tests for Sailmax run length records
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "catch.hpp"
+#include <SailmaxFormat.h>
+#include "SailmaxRunLength.h"
+#include "SailmaxLogIndex.h"
+
+static void CollectLine(const char *Line, void *Context) {
+  ((std::vector<std::string> *)Context)->push_back(Line);
+}
+
+static std::vector<std::string> Expand(const std::vector<std::string> &Lines) {
+  std::vector<std::string> Result;
+  tSailmaxRunExpander Expander;
+  tN2kMsg msg;
+  uint32_t timestamp;
+  char Line[MaxSailmaxLine];
+
+  for ( size_t i=0; i<Lines.size(); i++ ) {
+    REQUIRE(Expander.NeedLine());
+    REQUIRE(Expander.AddLine(Lines[i].c_str()));
+    while ( Expander.Next(msg,timestamp) ) {
+      REQUIRE(N2kToSailmax(msg,timestamp,Line,sizeof(Line))>0);
+      Result.push_back(Line);
+    }
+  }
+  Expander.Finish();
+  REQUIRE(!Expander.Next(msg,timestamp));
+  return Result;
+}
+
+static void AddMsg(tSailmaxRunWriter &Writer, std::vector<std::string> &Original, uint32_t timestamp,
+                   unsigned long PGN, unsigned char Source, unsigned char Value) {
+  tN2kMsg msg(Source);
+  char Line[MaxSailmaxLine];
+  msg.SetPGN(PGN);
+  msg.AddByte(Value);
+  msg.AddByte(0xff);
+  REQUIRE(N2kToSailmax(msg,timestamp,Line,sizeof(Line))>0);
+  Original.push_back(Line);
+  Writer.Add(msg,timestamp);
+}
+
+TEST_CASE("Run records restore exact message sequence") {
+  std::vector<std::string> Records;
+  std::vector<std::string> Original;
+  tSailmaxRunWriter Writer(CollectLine,&Records,4,8);
+
+  for ( uint32_t i=0; i<100; i++ ) {
+    AddMsg(Writer,Original,1000+10*i,127250,0x23,(unsigned char)(i/7)); // changes every 7th
+    AddMsg(Writer,Original,1000+10*i,126993,0x23,0);                   // steady heartbeat
+    if ( i%3==0 ) AddMsg(Writer,Original,1001+10*i,127245,0x02,(unsigned char)(i%2));
+  }
+  Writer.Flush();
+
+  REQUIRE(Writer.GetMessages()==Original.size());
+  REQUIRE(Records.size()<Original.size()/2);
+  REQUIRE(Writer.GetRunRecords()>0);
+  REQUIRE(Expand(Records)==Original);
+}
+
+TEST_CASE("Run record parser") {
+  tN2kMsg msg;
+  uint32_t timestamp;
+  std::vector<std::pair<int32_t,uint32_t> > Deltas;
+
+  REQUIRE(SailmaxRunToN2k("&205929,060928,21,B2CF6B340082FAC0,98;872/6;-1*42",timestamp,msg,Deltas));
+  REQUIRE(timestamp==205929);
+  REQUIRE(msg.PGN==60928);
+  REQUIRE(msg.Source==0x21);
+  REQUIRE(msg.DataLen==8);
+  REQUIRE(Deltas.size()==3);
+  REQUIRE(Deltas[0]==std::make_pair((int32_t)98,(uint32_t)1));
+  REQUIRE(Deltas[1]==std::make_pair((int32_t)872,(uint32_t)6));
+  REQUIRE(Deltas[2]==std::make_pair((int32_t)-1,(uint32_t)1));
+  // Bad checksum and missing deltas
+  REQUIRE(!SailmaxRunToN2k("&205929,060928,21,B2CF6B340082FAC0,98;872/6;-1*43",timestamp,msg,Deltas));
+  REQUIRE(!SailmaxRunToN2k("&205929,060928,21,B2CF6B340082FAC0,*7B",timestamp,msg,Deltas));
+}
+
+TEST_CASE("Packed sample log expands to original") {
+  FILE *f=fopen(N2K_TEST_LOGFILE,"rb");
+  REQUIRE(f!=0);
+  std::vector<std::string> Records;
+  std::vector<std::string> Original;
+  tSailmaxRunWriter Writer(CollectLine,&Records);
+  char Line[1024];
+  tN2kMsg msg;
+  uint32_t timestamp;
+  size_t OriginalSize=0;
+
+  while ( fgets(Line,sizeof(Line),f)!=0 ) {
+    Line[strcspn(Line,"\r\n")]=0;
+    if ( !SailmaxToN2k(Line,timestamp,msg) ) continue;
+    Original.push_back(Line);
+    OriginalSize+=strlen(Line);
+    Writer.Add(msg,timestamp);
+  }
+  fclose(f);
+  Writer.Flush();
+
+  size_t PackedSize=0;
+  for ( size_t i=0; i<Records.size(); i++ ) PackedSize+=Records[i].size();
+  REQUIRE(PackedSize<OriginalSize);
+  REQUIRE(Expand(Records)==Original);
+}
+
+TEST_CASE("Query expands matching run records") {
+  const char *TestFile="RunLengthTest.log";
+  FILE *f=fopen(TestFile,"wb");
+  REQUIRE(f!=0);
+  fputs("@1000,127250,23,0001*00\r\n",f); // bad checksum, ignored
+  fputs("&205929,060928,21,B2CF6B340082FAC0,98;872/6;-1*42\r\n",f);
+  fclose(f);
+
+  tSailmaxLogIndex Index;
+  REQUIRE(Index.Build(TestFile,4096));
+  REQUIRE(Index.GetBlock(0).Messages==5);
+  tSailmaxLogQuery Query;
+  Query.AddSource(0x21);
+  REQUIRE(Query.Run(TestFile,Index,0));
+  REQUIRE(Query.GetMatches()==4);
+
+  remove(TestFile);
+}
@@ -0,0 +1,159 @@
+/*
+
+       SSS       A     I L      M    M      A       X   X
+      S         A A    I L      MM  MM     A A       X X
+        S      A   A   I L      M MM M    A   A       X
+          S   AAAAAAA  I L      M    M   AAAAAAA     X X
+      SSS    A       A I LLLLL  M    M  A       A   X   X
+
+      * Project:  Sailmax-CU, N2k Log Tools
+      * Purpose:  tests for N2k XOR delta encoding
+      * Author:   © Ronnie Zeiller, 2018
+
+The MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "catch.hpp"
+#include <SailmaxFormat.h>
+#include "N2kXorCodec.h"
+
+struct tMemory {
+  std::vector<uint8_t> Data;
+  size_t Pos;
+  tMemory() : Pos(0) {}
+};
+
+static void WriteMemory(const uint8_t *Data, size_t len, void *Context) {
+  tMemory *Memory=(tMemory *)Context;
+  Memory->Data.insert(Memory->Data.end(),Data,Data+len);
+}
+
+static size_t ReadMemory(uint8_t *Data, size_t size, void *Context) {
+  tMemory *Memory=(tMemory *)Context;
+  size_t len=Memory->Data.size()-Memory->Pos;
+  if ( len>size ) len=size;
+  if ( len>0 ) memcpy(Data,&Memory->Data[Memory->Pos],len);
+  Memory->Pos+=len;
+  return len;
+}
+
+static void RequireRoundTrip(const std::vector<tN2kMsg> &Msgs, const std::vector<uint32_t> &Timestamps, tMemory &Encoded) {
+  tN2kXorEncoder Encoder(WriteMemory,&Encoded);
+  for ( size_t i=0; i<Msgs.size(); i++ ) Encoder.Add(Msgs[i],Timestamps[i]);
+  Encoder.Close();
+
+  tN2kXorDecoder Decoder(ReadMemory,&Encoded);
+  tN2kMsg msg;
+  uint32_t timestamp;
+  for ( size_t i=0; i<Msgs.size(); i++ ) {
+    REQUIRE(Decoder.Next(msg,timestamp));
+    REQUIRE(timestamp==Timestamps[i]);
+    REQUIRE(msg.PGN==Msgs[i].PGN);
+    REQUIRE(msg.Source==Msgs[i].Source);
+    REQUIRE(msg.Priority==Msgs[i].Priority);
+    REQUIRE(msg.Destination==Msgs[i].Destination);
+    REQUIRE(msg.DataLen==Msgs[i].DataLen);
+    REQUIRE(memcmp(msg.Data,Msgs[i].Data,msg.DataLen)==0);
+  }
+  REQUIRE(!Decoder.Next(msg,timestamp));
+  REQUIRE(Decoder.IsEnded());
+  REQUIRE(!Decoder.IsError());
+}
+
+TEST_CASE("XOR codec restores messages") {
+  std::vector<tN2kMsg> Msgs;
+  std::vector<uint32_t> Timestamps;
+  uint32_t timestamp=0xfffff000; // wraps
+
+  for ( int i=0; i<2000; i++ ) {
+    tN2kMsg msg((unsigned char)(i%300));   // more than 256 streams
+    msg.SetPGN(i%7==0?126208:127245+(i%3));
+    msg.Priority=(i%11==0?3:2);
+    msg.Destination=(i%13==0?0x23:0xff);
+    int DataLen=(i%17==0?(i*7)%224:8);
+    for ( int j=0; j<DataLen; j++ ) msg.AddByte((unsigned char)(i%5==0?j*i:j));
+    Msgs.push_back(msg);
+    timestamp+=(i%19==0?100000:(i%23==0?0:100));
+    Timestamps.push_back(timestamp);
+  }
+
+  tMemory Encoded;
+  RequireRoundTrip(Msgs,Timestamps,Encoded);
+}
+
+TEST_CASE("XOR codec packs steady streams to few bits") {
+  std::vector<tN2kMsg> Msgs;
+  std::vector<uint32_t> Timestamps;
+
+  for ( int i=0; i<1000; i++ ) {
+    tN2kMsg msg(0x02);
+    msg.SetPGN(127245);
+    msg.AddByte(0xff);
+    msg.AddByte(0xff);
+    msg.Add2ByteInt(1000+(i%4));  // rudder angle moving a little
+    msg.Add2ByteInt(0x7fff);
+    msg.AddByte(0xff);
+    msg.AddByte(0xff);
+    Msgs.push_back(msg);
+    Timestamps.push_back(1000+100*i);
+  }
+
+  tMemory Encoded;
+  RequireRoundTrip(Msgs,Timestamps,Encoded);
+  // 8 data bytes and timestamp per message in raw form
+  REQUIRE(Encoded.Data.size()*8<Msgs.size()*12);
+}
+
+TEST_CASE("XOR codec restores sample log") {
+  FILE *f=fopen(N2K_TEST_LOGFILE,"rb");
+  REQUIRE(f!=0);
+  std::vector<tN2kMsg> Msgs;
+  std::vector<uint32_t> Timestamps;
+  char Line[1024];
+  tN2kMsg msg;
+  uint32_t timestamp;
+
+  while ( fgets(Line,sizeof(Line),f)!=0 ) {
+    Line[strcspn(Line,"\r\n")]=0;
+    if ( !SailmaxToN2k(Line,timestamp,msg) ) continue;
+    Msgs.push_back(msg);
+    Timestamps.push_back(timestamp);
+  }
+  fclose(f);
+
+  tMemory Encoded;
+  RequireRoundTrip(Msgs,Timestamps,Encoded);
+}
+
+TEST_CASE("XOR decoder detects damaged data") {
+  tMemory Encoded;
+  Encoded.Data.push_back('N');
+  Encoded.Data.push_back('2');
+  Encoded.Data.push_back('X');
+  tN2kXorDecoder Decoder(ReadMemory,&Encoded);
+  tN2kMsg msg;
+  uint32_t timestamp;
+  REQUIRE(!Decoder.Next(msg,timestamp));
+  REQUIRE(Decoder.IsError());
+}